@@ -3,17 +3,19 @@
 #include <biron/util/numeric.inl>
 #include <biron/util/traits/is_base_of.inl>
 #include <biron/util/pool.h>
+#include <biron/util/allocator.h> // Atomic
 
 namespace Biron {
 
 struct AstID {
 	template<typename T>
 	static Uint32 id() noexcept {
+		// Parsers run concurrently with -j so the counter must be atomic.
 		static const Uint32 id = s_id++;
 		return id;
 	}
 private:
-	static inline Uint32 s_id;
+	static inline Atomic<Uint32> s_id;
 };
 
 struct AstNode {
@@ -21,21 +23,49 @@ struct AstNode {
 		TYPE, EXPR, STMT, FN, ASM, ATTR, MODULE, IMPORT, EFFECT
 	};
 	constexpr AstNode(Kind kind, Range range) noexcept
-		: m_kind{kind}
-		, m_range{range}
+		: m_offset{Uint32(range.offset)}
+		, m_length{Uint32(range.length)}
+		, m_kind{kind}
 	{
 	}
-	virtual ~AstNode() noexcept = default;
 	template<DerivedFrom<AstNode> T>
 	[[nodiscard]] constexpr Bool is_node() const noexcept {
-		return m_kind = T::KIND;
+		return m_kind == T::KIND;
 	}
-	[[nodiscard]] constexpr const Range& range() const noexcept {
-		return m_range;
+	[[nodiscard]] constexpr Range range() const noexcept {
+		return { m_offset, m_length };
 	}
 private:
-	Kind m_kind;
-	Range m_range;
+	// The kind is last so that the kind of a derived node can be packed into the
+	// tail padding.
+	Uint32 m_offset;
+	Uint32 m_length;
+	Kind   m_kind;
+};
+
+// The children of a node. The elements are moved out of an Array into a single
+// allocation of exactly the right size which the node does not own, so nodes
+// are trivially destructible and never need to be destroyed.
+template<typename T>
+struct AstList {
+	constexpr AstList() noexcept = default;
+	constexpr AstList(T* data, Uint32 length) noexcept
+		: m_data{data}
+		, m_length{length}
+	{
+	}
+	[[nodiscard]] constexpr const T* begin() const noexcept { return m_data; }
+	[[nodiscard]] constexpr const T* end() const noexcept { return m_data + m_length; }
+	[[nodiscard]] constexpr const T& operator[](Ulen index) const noexcept { return m_data[index]; }
+	[[nodiscard]] constexpr const T* at(Ulen index) const noexcept {
+		return index < m_length ? m_data + index : nullptr;
+	}
+	[[nodiscard]] constexpr const T& last() const noexcept { return m_data[m_length - 1]; }
+	[[nodiscard]] constexpr Ulen length() const noexcept { return m_length; }
+	[[nodiscard]] constexpr Bool empty() const noexcept { return m_length == 0; }
+private:
+	T*     m_data   = nullptr;
+	Uint32 m_length = 0;
 };
 
 struct Cg;
@@ -58,13 +88,41 @@ struct Ast {
 	Ast& operator=(const Ast&) = delete;
 	Ast& operator=(Ast&&) = delete;
 
-	~Ast() noexcept;
+	~Ast() noexcept = default;
 	void dump(StringBuilder& builder) const noexcept;
 
+	// Code generation happens in passes so that many units can be generated
+	// into the same Cg, see -whole-program. Each pass must be run on every unit
+	// before the next pass is run on any of them.
+	enum class Pass : Uint8 {
+		DECLS,     // Names of types and effects, so a unit can use those of another
+		GLOBALS,   // Global let statements
+		TYPEDEFS,  // Types
+		EFFECTS,   // Effects
+		PROTOTYPE, // Function values, so functions need no prototypes
+		FUNCTIONS, // Function bodies
+	};
+
+	static inline constexpr const Pass PASSES[] = {
+		Pass::DECLS,
+		Pass::GLOBALS,
+		Pass::TYPEDEFS,
+		Pass::EFFECTS,
+		Pass::PROTOTYPE,
+		Pass::FUNCTIONS,
+	};
+
+	// Registers the compiler provided functions and intrinsics. Must be called
+	// once on a Cg before any pass.
+	[[nodiscard]] static Bool prelude(Cg& cg) noexcept;
+
+	[[nodiscard]] Bool codegen(Cg& cg, Pass pass) const noexcept;
 	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
 
+	// Any Array argument is moved into an AstList for the node.
 	template<typename T, typename... Ts>
 	[[nodiscard]] T* new_node(Ts&&... args) noexcept {
+		static_assert(__has_trivial_destructor(T), "AST nodes are never destroyed");
 		static const Uint32 id = AstID::id<T>();
 		if (id >= m_caches.length() && !m_caches.resize(id + 1)) {
 			return nullptr;
@@ -77,7 +135,13 @@ struct Ast {
 		if (!addr) {
 			return nullptr;
 		}
-		return new (addr, Nat{}) T{forward<Ts>(args)...};
+		Bool ok = true;
+		auto node = new (addr, Nat{}) T{list(forward<Ts>(args), ok)...};
+		if (!ok) {
+			(void)cache->deallocate(addr);
+			return nullptr;
+		}
+		return node;
 	}
 
 	template<typename T>
@@ -88,6 +152,30 @@ struct Ast {
 	}
 
 private:
+	template<typename T>
+	static T&& list(T&& arg, Bool&) noexcept {
+		return forward<T>(arg);
+	}
+	template<typename T>
+	AstList<T> list(Array<T>&& array, Bool& ok) noexcept {
+		const auto length = array.length();
+		if (length == 0) {
+			array.reset();
+			return {};
+		}
+		auto data = static_cast<T*>(m_allocator.allocate(sizeof(T) * length));
+		if (!data) {
+			ok = false;
+			return {};
+		}
+		for (Ulen i = 0; i < length; i++) {
+			new (data + i, Nat{}) T{move(array[i])};
+		}
+		// Leave |array| empty as though it was moved from.
+		array.reset();
+		return { data, Uint32(length) };
+	}
+
 	Allocator&          m_allocator;
 	Array<Maybe<Cache>> m_caches;
 };
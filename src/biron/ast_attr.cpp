@@ -4,7 +4,7 @@
 namespace Biron {
 
 void AstAttr::dump(StringBuilder& builder) const noexcept {
-	builder.append(m_name);
+	builder.append(m_name.string());
 	builder.append('(');
 	m_expr->dump(builder);
 	builder.append(')');
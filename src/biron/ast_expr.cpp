@@ -3,6 +3,10 @@
 
 namespace Biron {
 
+void AstExpr::dump(StringBuilder& builder) const noexcept {
+	visit([&](auto expr) { expr->dump(builder); });
+}
+
 void AstTupleExpr::dump(StringBuilder& builder) const noexcept {
 	builder.append('(');
 	Bool f = true;
@@ -24,7 +28,7 @@ void AstTypeExpr::dump(StringBuilder& builder) const noexcept {
 }
 
 void AstVarExpr::dump(StringBuilder& builder) const noexcept {
-	builder.append(m_name);
+	builder.append(m_name.string());
 }
 
 void AstSelectorExpr::dump(StringBuilder& builder) const noexcept {
@@ -1,13 +1,16 @@
 #ifndef BIRON_AST_EXPR_H
 #define BIRON_AST_EXPR_H
 #include <biron/ast.h>
+#include <biron/symbol.h>
 #include <biron/util/string.h>
 #include <biron/util/array.inl>
+#include <biron/util/unreachable.inl>
 #include <biron/util/int128.inl>
 
 namespace Biron {
 
 struct Cg;
+struct Sema;
 struct CgType;
 struct CgValue;
 struct CgAddr;
@@ -46,8 +49,8 @@ struct AstExpr : AstNode {
 		, m_kind{kind}
 	{
 	}
-	virtual ~AstExpr() noexcept = default;
-	virtual void dump(StringBuilder& builder) const noexcept = 0;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 	template<DerivedFrom<AstExpr> T>
 	[[nodiscard]] constexpr Bool is_expr() const noexcept {
 		return m_kind == T::KIND;
@@ -60,33 +63,38 @@ struct AstExpr : AstNode {
 	[[nodiscard]] constexpr T* to_expr() noexcept {
 		return is_expr<T>() ? static_cast<T*>(this) : nullptr;
 	}
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
+	// Calls |f| with this expression cast to its derived type. Nodes have no vtable
+	// so this is how every call on an AstExpr is dispatched.
+	template<typename F>
+	decltype(auto) visit(F&& f) const noexcept;
 private:
 	Kind m_kind;
 };
 
 struct AstTupleExpr : AstExpr {
 	static inline constexpr const auto KIND = Kind::TUPLE;
-	constexpr AstTupleExpr(Array<AstExpr*>&& exprs, Range range) noexcept
+	constexpr AstTupleExpr(AstList<AstExpr*> exprs, Range range) noexcept
 		: AstExpr{KIND, range}
-		, m_exprs{move(exprs)}
+		, m_exprs{exprs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 	[[nodiscard]] Ulen length() const noexcept { return m_exprs.length(); }
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 	[[nodiscard]] AstExpr* at(Ulen i) const noexcept {
 		BIRON_ASSERT(i < m_exprs.length() && "Out of bounds");
 		return m_exprs[i];
 	}
 private:
-	Array<AstExpr*> m_exprs;
+	AstList<AstExpr*> m_exprs;
 };
 
 struct AstCallExpr : AstExpr {
@@ -98,12 +106,20 @@ struct AstCallExpr : AstExpr {
 		, m_c{c}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 	[[nodiscard]] AstExpr* callee() const noexcept { return m_callee; }
+	[[nodiscard]] Maybe<KnownSymbol> builtin(Cg& cg) const noexcept;
 private:
+	[[nodiscard]] Maybe<CgValue> gen_builtin_value(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_builtin_type(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_intrinsic_value(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_intrinsic_type(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_atomic_value(Cg& cg, KnownSymbol builtin) const noexcept;
+	[[nodiscard]] CgType* gen_atomic_type(Cg& cg, KnownSymbol builtin) const noexcept;
 	AstExpr*      m_callee;
 	AstTupleExpr* m_args;
 	Bool          m_c; // C ABI
@@ -116,7 +132,7 @@ struct AstTypeExpr : AstExpr {
 		, m_type{type}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
 	[[nodiscard]] AstType* type() const noexcept { return m_type; }
 private:
 	AstType* m_type;
@@ -124,20 +140,21 @@ private:
 
 struct AstVarExpr : AstExpr {
 	static inline constexpr const auto KIND = Kind::VAR;
-	constexpr AstVarExpr(StringView name, Range range) noexcept
+	constexpr AstVarExpr(Symbol name, Range range) noexcept
 		: AstExpr{KIND, range}
 		, m_name{name}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 	// Only for top-level constants
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] StringView name() const noexcept { return m_name; }
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Symbol name() const noexcept { return m_name; }
 private:
-	StringView m_name;
+	Symbol     m_name;
 };
 
 struct AstSelectorExpr : AstExpr {
@@ -147,10 +164,10 @@ struct AstSelectorExpr : AstExpr {
 		, m_name{name}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	StringView m_name;
 };
@@ -185,10 +202,10 @@ struct AstIntExpr : AstExpr {
 		: AstExpr{KIND, range}, m_kind{Kind::S64}, m_as_sint{value} {}
 	constexpr AstIntExpr(Untyped value, Range range) noexcept
 		: AstExpr{KIND, range}, m_kind{Kind::UNTYPED}, m_as_uint{value.value} {}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	Kind m_kind;
 	union {
@@ -214,10 +231,10 @@ struct AstFltExpr : AstExpr {
 		: AstExpr{KIND, range}, m_kind{Kind::F64}, m_as_f64{value} {}
 	constexpr AstFltExpr(Untyped value, Range range) noexcept
 		: AstExpr{KIND, range}, m_kind{Kind::UNTYPED}, m_as_f64{value.value} {}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	Kind m_kind;
 	union {
@@ -233,10 +250,10 @@ struct AstStrExpr : AstExpr {
 		, m_literal{literal}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	StringView m_literal;
 };
@@ -248,31 +265,32 @@ struct AstBoolExpr : AstExpr {
 		, m_value{value}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
 	[[nodiscard]] constexpr Bool value() const noexcept { return m_value; }
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	Bool m_value;
 };
 
 struct AstAggExpr : AstExpr {
 	static inline constexpr const auto KIND = Kind::AGG;
-	constexpr AstAggExpr(AstType* type, Array<AstExpr*>&& exprs, Range range) noexcept
+	constexpr AstAggExpr(AstType* type, AstList<AstExpr*> exprs, Range range) noexcept
 		: AstExpr{KIND, range}
 		, m_type{type}
-		, m_exprs{move(exprs)}
+		, m_exprs{exprs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
-	AstType*        m_type;
-	Array<AstExpr*> m_exprs;
+	AstType*          m_type;
+	AstList<AstExpr*> m_exprs;
 };
 
 struct AstBinExpr : AstExpr {
@@ -291,11 +309,12 @@ struct AstBinExpr : AstExpr {
 		, m_rhs{rhs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	Op       m_op;
 	AstExpr* m_lhs;
@@ -314,11 +333,12 @@ struct AstLBinExpr : AstExpr {
 		, m_rhs{rhs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	Op       m_op;
 	AstExpr* m_lhs;
@@ -339,10 +359,11 @@ struct AstUnaryExpr : AstExpr {
 		, m_operand{operand}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	Op       m_op;
 	AstExpr* m_operand;
@@ -356,11 +377,12 @@ struct AstIndexExpr : AstExpr {
 		, m_index{index}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	AstExpr* m_operand;
 	AstExpr* m_index;
@@ -373,8 +395,9 @@ struct AstExplodeExpr : AstExpr {
 		, m_operand{operand}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
 private:
 	AstExpr* m_operand;
 };
@@ -386,10 +409,11 @@ struct AstEffExpr : AstExpr {
 		, m_operand{operand}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	[[nodiscard]] const AstVarExpr* expression() const noexcept {
 		return m_operand->to_expr<const AstVarExpr>();
@@ -403,7 +427,7 @@ struct AstInferSizeExpr : AstExpr {
 		: AstExpr{KIND, range}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
 };
 
 struct AstAccessExpr : AstExpr {
@@ -414,10 +438,13 @@ struct AstAccessExpr : AstExpr {
 		, m_rhs{rhs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] AstExpr* lhs() const noexcept { return m_lhs; }
+	[[nodiscard]] AstExpr* rhs() const noexcept { return m_rhs; }
 private:
 	AstExpr* m_lhs;
 	AstExpr* m_rhs;
@@ -432,11 +459,12 @@ struct AstCastExpr : AstExpr {
 		, m_type{type}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgAddr> gen_addr(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	AstExpr* m_operand;
 	AstExpr* m_type;
@@ -451,9 +479,10 @@ struct AstTestExpr : AstExpr {
 		, m_type{type}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	AstExpr* m_operand;
 	AstExpr* m_type;
@@ -469,15 +498,44 @@ struct AstPropExpr : AstExpr {
 		, m_expr{expr}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	[[nodiscard]] virtual Maybe<AstConst> eval_value(Cg& cg) const noexcept override;
-	[[nodiscard]] virtual Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept override;
-	[[nodiscard]] virtual CgType* gen_type(Cg& cg, CgType* want) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	[[nodiscard]] Maybe<AstConst> eval_value(Cg& cg) const noexcept;
+	[[nodiscard]] Maybe<CgValue> gen_value(Cg& cg, CgType* want) const noexcept;
+	[[nodiscard]] CgType* gen_type(Cg& cg, CgType* want) const noexcept;
 private:
 	AstExpr* m_prop;
 	AstExpr* m_expr;
 };
 
+template<typename F>
+decltype(auto) AstExpr::visit(F&& f) const noexcept {
+	switch (m_kind) {
+	case Kind::TUPLE:     return f(static_cast<const AstTupleExpr*>(this));
+	case Kind::CALL:      return f(static_cast<const AstCallExpr*>(this));
+	case Kind::TYPE:      return f(static_cast<const AstTypeExpr*>(this));
+	case Kind::VAR:       return f(static_cast<const AstVarExpr*>(this));
+	case Kind::INT:       return f(static_cast<const AstIntExpr*>(this));
+	case Kind::FLT:       return f(static_cast<const AstFltExpr*>(this));
+	case Kind::BOOL:      return f(static_cast<const AstBoolExpr*>(this));
+	case Kind::STR:       return f(static_cast<const AstStrExpr*>(this));
+	case Kind::AGG:       return f(static_cast<const AstAggExpr*>(this));
+	case Kind::BIN:       return f(static_cast<const AstBinExpr*>(this));
+	case Kind::LBIN:      return f(static_cast<const AstLBinExpr*>(this));
+	case Kind::UNARY:     return f(static_cast<const AstUnaryExpr*>(this));
+	case Kind::INDEX:     return f(static_cast<const AstIndexExpr*>(this));
+	case Kind::EXPLODE:   return f(static_cast<const AstExplodeExpr*>(this));
+	case Kind::EFF:       return f(static_cast<const AstEffExpr*>(this));
+	case Kind::SELECTOR:  return f(static_cast<const AstSelectorExpr*>(this));
+	case Kind::INFERSIZE: return f(static_cast<const AstInferSizeExpr*>(this));
+	case Kind::ACCESS:    return f(static_cast<const AstAccessExpr*>(this));
+	case Kind::CAST:      return f(static_cast<const AstCastExpr*>(this));
+	case Kind::TEST:      return f(static_cast<const AstTestExpr*>(this));
+	case Kind::PROP:      return f(static_cast<const AstPropExpr*>(this));
+	}
+	BIRON_UNREACHABLE();
+}
+
 } // namespace Biron
 
 #endif // BIRON_AST_EXPR_H
\ No newline at end of file
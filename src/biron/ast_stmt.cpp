@@ -25,8 +25,16 @@ const char* AstStmt::name() const noexcept {
 	BIRON_UNREACHABLE();
 }
 
+void AstStmt::dump(StringBuilder& builder, int depth) const noexcept {
+	visit([&](auto stmt) { stmt->dump(builder, depth); });
+}
+
 Bool AstStmt::codegen(Cg& cg) const noexcept {
-	return cg.error(range(), "Unsupported codegen for %s", name());
+	// The statement is current while it is lowered, see Cg::memory_order.
+	auto last = exchange(cg.stmt, this);
+	auto result = visit([&](auto stmt) { return stmt->codegen(cg); });
+	cg.stmt = last;
+	return result;
 }
 
 void AstBlockStmt::dump(StringBuilder& builder, int depth) const noexcept {
@@ -98,7 +106,7 @@ void AstLLetStmt::dump(StringBuilder& builder, int depth) const noexcept {
 	builder.repeat('\t', depth);
 	builder.append("let");
 	builder.append(' ');
-	builder.append(m_name);
+	builder.append(m_name.string());
 	builder.append(" = ");
 	m_init->dump(builder);
 	builder.append(';');
@@ -109,7 +117,7 @@ void AstGLetStmt::dump(StringBuilder& builder, int depth) const noexcept {
 	builder.repeat('\t', depth);
 	builder.append("let");
 	builder.append(' ');
-	builder.append(m_name);
+	builder.append(m_name.string());
 	builder.append(" = ");
 	m_init->dump(builder);
 	builder.append(';');
@@ -120,7 +128,7 @@ void AstUsingStmt::dump(StringBuilder& builder, int depth) const noexcept {
 	builder.repeat('\t', depth);
 	builder.append("using");
 	builder.append(' ');
-	builder.append(m_name);
+	builder.append(m_name.string());
 	builder.append(" = ");
 	m_init->dump(builder);
 	builder.append(';');
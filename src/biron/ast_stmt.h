@@ -1,8 +1,10 @@
 #ifndef BIRON_AST_STMT_H
 #define BIRON_AST_STMT_H
 #include <biron/ast.h>
+#include <biron/symbol.h>
 #include <biron/util/string.h>
 #include <biron/util/array.inl>
+#include <biron/util/unreachable.inl>
 
 namespace Biron {
 
@@ -10,6 +12,9 @@ struct AstExpr;
 struct AstAttr;
 
 struct Cg;
+struct CgAddr;
+struct CgValue;
+struct Sema;
 
 struct AstStmt : AstNode {
 	static inline constexpr auto KIND = Kind::STMT;
@@ -33,8 +38,7 @@ struct AstStmt : AstNode {
 		, m_kind{kind}
 	{
 	}
-	virtual ~AstStmt() noexcept = default;
-	virtual void dump(StringBuilder& builder, int depth) const noexcept = 0;
+	void dump(StringBuilder& builder, int depth) const noexcept;
 	template<DerivedFrom<AstStmt> T>
 	[[nodiscard]] constexpr Bool is_stmt() const noexcept {
 		return m_kind == T::KIND;
@@ -47,22 +51,28 @@ struct AstStmt : AstNode {
 	[[nodiscard]] constexpr T* to_stmt() noexcept {
 		return is_stmt<T>() ? static_cast<T*>(this) : nullptr;
 	}
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
+	// Calls |f| with this statement cast to its derived type. Nodes have no vtable
+	// so this is how every call on an AstStmt is dispatched.
+	template<typename F>
+	decltype(auto) visit(F&& f) const noexcept;
 private:
 	Kind m_kind;
 };
 
 struct AstBlockStmt : AstStmt {
 	static inline constexpr auto KIND = Kind::BLOCK;
-	constexpr AstBlockStmt(Array<AstStmt*>&& stmts, Range range) noexcept
+	constexpr AstBlockStmt(AstList<AstStmt*> stmts, Range range) noexcept
 		: AstStmt{KIND, range}
-		, m_stmts{move(stmts)}
+		, m_stmts{stmts}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
-	Array<AstStmt*> m_stmts;
+	AstList<AstStmt*> m_stmts;
 };
 
 struct AstReturnStmt : AstStmt {
@@ -72,8 +82,9 @@ struct AstReturnStmt : AstStmt {
 		, m_expr{expr}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
 	AstExpr* m_expr; // Optional
 };
@@ -85,8 +96,9 @@ struct AstDeferStmt : AstStmt {
 		, m_stmt{stmt}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
 	AstStmt* m_stmt;
 };
@@ -97,8 +109,9 @@ struct AstBreakStmt : AstStmt {
 		: AstStmt{KIND, range}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 };
 
 struct AstContinueStmt : AstStmt {
@@ -107,8 +120,9 @@ struct AstContinueStmt : AstStmt {
 		: AstStmt{KIND, range}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 };
 
 struct AstLLetStmt;
@@ -123,8 +137,9 @@ struct AstIfStmt : AstStmt {
 		, m_elif{elif}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
 	AstLLetStmt*  m_init;
 	AstExpr*      m_expr;
@@ -134,53 +149,55 @@ private:
 
 struct AstLLetStmt : AstStmt {
 	static inline constexpr auto KIND = Kind::LLET;
-	constexpr AstLLetStmt(StringView name, AstExpr* init, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstLLetStmt(Symbol name, AstExpr* init, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstStmt{KIND, range}
 		, m_name{name}
 		, m_init{init}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] constexpr StringView name() const noexcept { return m_name; }
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] constexpr Symbol name() const noexcept { return m_name; }
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
-	StringView      m_name;
-	AstExpr*        m_init;
-	Array<AstAttr*> m_attrs;
+	Symbol            m_name;
+	AstExpr*          m_init;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstGLetStmt : AstStmt {
 	static inline constexpr auto KIND = Kind::GLET;
-	constexpr AstGLetStmt(StringView name, AstExpr* init, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstGLetStmt(Symbol name, AstExpr* init, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstStmt{KIND, range}
 		, m_name{name}
 		, m_init{init}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] constexpr StringView name() const noexcept { return m_name; }
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] constexpr Symbol name() const noexcept { return m_name; }
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
 private:
-	StringView      m_name;
-	AstExpr*        m_init;
-	Array<AstAttr*> m_attrs;
+	Symbol            m_name;
+	AstExpr*          m_init;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstUsingStmt : AstStmt {
 	static inline constexpr auto KIND = Kind::USING;
-	constexpr AstUsingStmt(StringView name, AstExpr* init, Range range)
+	constexpr AstUsingStmt(Symbol name, AstExpr* init, Range range)
 		: AstStmt{KIND, range}
 		, m_name{name}
 		, m_init{init}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] constexpr StringView name() const noexcept { return m_name; }
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] constexpr Symbol name() const noexcept { return m_name; }
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
-	StringView m_name;
+	Symbol     m_name;
 	AstExpr*   m_init;
 };
 
@@ -195,8 +212,9 @@ struct AstForStmt : AstStmt {
 		, m_else{elze}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
 	AstLLetStmt*  m_init;
 	AstExpr*      m_expr;
@@ -212,8 +230,9 @@ struct AstExprStmt : AstStmt {
 		, m_expr{expr}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
 	AstExpr* m_expr;
 };
@@ -228,14 +247,35 @@ struct AstAssignStmt : AstStmt {
 		, m_op{op}
 	{
 	}
-	virtual void dump(StringBuilder& builder, int depth) const noexcept override;
-	[[nodiscard]] virtual Bool codegen(Cg& cg) const noexcept override;
+	void dump(StringBuilder& builder, int depth) const noexcept;
+	[[nodiscard]] Bool codegen(Cg& cg) const noexcept;
+	[[nodiscard]] Bool analyze(Sema& sema) const noexcept;
 private:
+	[[nodiscard]] Bool assign_atomic(Cg& cg, const CgAddr& dst, const CgValue& src) const noexcept;
 	AstExpr* m_dst;
 	AstExpr* m_src;
 	StoreOp  m_op;
 };
 
+template<typename F>
+decltype(auto) AstStmt::visit(F&& f) const noexcept {
+	switch (m_kind) {
+	case Kind::BLOCK:    return f(static_cast<const AstBlockStmt*>(this));
+	case Kind::RETURN:   return f(static_cast<const AstReturnStmt*>(this));
+	case Kind::DEFER:    return f(static_cast<const AstDeferStmt*>(this));
+	case Kind::BREAK:    return f(static_cast<const AstBreakStmt*>(this));
+	case Kind::CONTINUE: return f(static_cast<const AstContinueStmt*>(this));
+	case Kind::IF:       return f(static_cast<const AstIfStmt*>(this));
+	case Kind::LLET:     return f(static_cast<const AstLLetStmt*>(this));
+	case Kind::GLET:     return f(static_cast<const AstGLetStmt*>(this));
+	case Kind::USING:    return f(static_cast<const AstUsingStmt*>(this));
+	case Kind::FOR:      return f(static_cast<const AstForStmt*>(this));
+	case Kind::EXPR:     return f(static_cast<const AstExprStmt*>(this));
+	case Kind::ASSIGN:   return f(static_cast<const AstAssignStmt*>(this));
+	}
+	BIRON_UNREACHABLE();
+}
+
 } // namespace Biron
 
 #endif // BIRON_AST_STMT_H
\ No newline at end of file
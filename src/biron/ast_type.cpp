@@ -3,6 +3,10 @@
 
 namespace Biron {
 
+void AstType::dump(StringBuilder& builder) const noexcept {
+	visit([&](auto type) { type->dump(builder); });
+}
+
 void AstTupleType::dump(StringBuilder& builder) const noexcept {
 	builder.append('{');
 	Bool f = true;
@@ -51,7 +55,7 @@ void AstUnionType::dump(StringBuilder& builder) const noexcept {
 }
 
 void AstIdentType::dump(StringBuilder& builder) const noexcept {
-	builder.append(m_ident);
+	builder.append(m_ident.string());
 }
 
 void AstVarArgsType::dump(StringBuilder& builder) const noexcept {
@@ -70,6 +74,13 @@ void AstArrayType::dump(StringBuilder& builder) const noexcept {
 	m_base->dump(builder);
 }
 
+void AstVectorType::dump(StringBuilder& builder) const noexcept {
+	builder.append("#[");
+	m_extent->dump(builder);
+	builder.append(']');
+	m_base->dump(builder);
+}
+
 void AstSliceType::dump(StringBuilder& builder) const noexcept {
 	builder.append("[]");
 	m_type->dump(builder);
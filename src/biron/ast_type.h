@@ -1,9 +1,11 @@
 #ifndef BIRON_AST_TYPE_H
 #define BIRON_AST_TYPE_H
 #include <biron/ast.h>
+#include <biron/symbol.h>
 #include <biron/util/string.h>
 
 #include <biron/util/array.inl>
+#include <biron/util/unreachable.inl>
 
 namespace Biron {
 
@@ -26,6 +28,7 @@ struct AstType : AstNode {
 		PTR,     // '*' <Type>
 		ATOM,    // '@' <Type>
 		ARRAY,   // '[' <Expr> ']' <Type>
+		VECTOR,  // '#' '[' <Expr> ']' <Type>
 		SLICE,   // '[]' <Type>
 		IDENT,   // <Ident>
 		VARARGS, // '...'
@@ -36,8 +39,7 @@ struct AstType : AstNode {
 		, m_kind{kind}
 	{
 	}
-	virtual ~AstType() noexcept = default;
-	virtual void dump(StringBuilder& builder) const noexcept = 0;
+	void dump(StringBuilder& builder) const noexcept;
 	template<DerivedFrom<AstType> T>
 	[[nodiscard]] constexpr Bool is_type() const noexcept {
 		return m_kind == T::KIND;
@@ -50,25 +52,29 @@ struct AstType : AstNode {
 	[[nodiscard]] constexpr const T* to_type() const noexcept {
 		return is_type<T>() ? static_cast<const T*>(this) : nullptr;
 	}
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept = 0;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
+	// Calls |f| with this type cast to its derived type. Nodes have no vtable
+	// so this is how every call on an AstType is dispatched.
+	template<typename F>
+	decltype(auto) visit(F&& f) const noexcept;
 private:
 	Kind m_kind;
 };
 
 struct AstIdentType : AstType {
 	static inline constexpr auto const KIND = Kind::IDENT;
-	constexpr AstIdentType(StringView ident, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstIdentType(Symbol ident, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
 		, m_ident{ident}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
-	[[nodiscard]] constexpr StringView name() const noexcept { return m_ident; }
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
+	[[nodiscard]] constexpr Symbol name() const noexcept { return m_ident; }
 private:
-	StringView      m_ident;
-	Array<AstAttr*> m_attrs;
+	Symbol            m_ident;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstTupleType : AstType {
@@ -91,20 +97,20 @@ struct AstTupleType : AstType {
 	};
 
 	static inline constexpr auto const KIND = Kind::TUPLE;
-	constexpr AstTupleType(Array<Elem>&& elems, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstTupleType(AstList<Elem> elems, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
-		, m_elems{move(elems)}
-		, m_attrs{move(attrs)}
+		, m_elems{elems}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override; 
-	[[nodiscard]] constexpr const Array<Elem>& elems() const noexcept {
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept; 
+	[[nodiscard]] constexpr const AstList<Elem>& elems() const noexcept {
 		return m_elems;
 	}
 private:
-	Array<Elem>     m_elems;
-	Array<AstAttr*> m_attrs;
+	AstList<Elem>     m_elems;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstArgsType : AstType {
@@ -127,18 +133,18 @@ struct AstArgsType : AstType {
 	};
 
 	static inline constexpr auto const KIND = Kind::ARGS;
-	constexpr AstArgsType(Array<Elem>&& elems, Range range) noexcept
+	constexpr AstArgsType(AstList<Elem> elems, Range range) noexcept
 		: AstType{KIND, range}
-		, m_elems{move(elems)}
+		, m_elems{elems}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override; 
-	[[nodiscard]] constexpr const Array<Elem>& elems() const noexcept {
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept; 
+	[[nodiscard]] constexpr const AstList<Elem>& elems() const noexcept {
 		return m_elems;
 	}
 private:
-	Array<Elem> m_elems;
+	AstList<Elem> m_elems;
 };
 
 struct AstGroupType : AstType {
@@ -148,8 +154,8 @@ struct AstGroupType : AstType {
 		, m_type{type}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 	[[nodiscard]] constexpr const AstType* type() const noexcept {
 		return m_type;
 	}
@@ -159,122 +165,139 @@ private:
 
 struct AstUnionType : AstType {
 	static inline constexpr auto const KIND = Kind::UNION;
-	constexpr AstUnionType(Array<AstType*>&& types, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstUnionType(AstList<AstType*> types, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
-		, m_types{move(types)}
-		, m_attrs{move(attrs)}
+		, m_types{types}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
-	[[nodiscard]] constexpr const Array<AstType*>& types() const noexcept {
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
+	[[nodiscard]] constexpr const AstList<AstType*>& types() const noexcept {
 		return m_types;
 	}
 private:
-	Array<AstType*> m_types;
-	Array<AstAttr*> m_attrs;
+	AstList<AstType*> m_types;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstVarArgsType : AstType {
 	static inline constexpr auto const KIND = Kind::VARARGS;
-	constexpr AstVarArgsType(Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstVarArgsType(AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 private:
-	Array<AstAttr*> m_attrs;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstPtrType : AstType {
 	static inline constexpr auto const KIND = Kind::PTR;
-	constexpr AstPtrType(AstType* type, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstPtrType(AstType* type, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
 		, m_type{type}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 private:
-	AstType*        m_type;
-	Array<AstAttr*> m_attrs;
+	AstType*          m_type;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstArrayType : AstType {
 	static inline constexpr auto const KIND = Kind::ARRAY;
-	constexpr AstArrayType(AstType* base, AstExpr* extent, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstArrayType(AstType* base, AstExpr* extent, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
 		, m_base{base}
 		, m_extent{extent}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 	[[nodiscard]] AstType* base() const noexcept { return m_base; }
 	[[nodiscard]] AstExpr* extent() const noexcept { return m_extent; }
 private:
-	AstType*        m_base;
-	AstExpr*        m_extent;
-	Array<AstAttr*> m_attrs;
+	AstType*          m_base;
+	AstExpr*          m_extent;
+	AstList<AstAttr*> m_attrs;
+};
+
+struct AstVectorType : AstType {
+	static inline constexpr auto const KIND = Kind::VECTOR;
+	constexpr AstVectorType(AstType* base, AstExpr* extent, AstList<AstAttr*> attrs, Range range) noexcept
+		: AstType{KIND, range}
+		, m_base{base}
+		, m_extent{extent}
+		, m_attrs{attrs}
+	{
+	}
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
+private:
+	AstType*          m_base;
+	AstExpr*          m_extent;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstSliceType : AstType {
 	static inline constexpr auto const KIND = Kind::SLICE;
-	constexpr AstSliceType(AstType* type, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstSliceType(AstType* type, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
 		, m_type{type}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 private:
-	AstType*        m_type;
-	Array<AstAttr*> m_attrs;
+	AstType*          m_type;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstFnType : AstType {
 	static inline constexpr auto const KIND = Kind::FN;
-	constexpr AstFnType(AstArgsType* objs, AstArgsType* args, Array<AstIdentType*>&& effects, AstType* ret, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstFnType(AstArgsType* objs, AstArgsType* args, AstList<AstIdentType*> effects, AstType* ret, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
 		, m_objs{objs}
 		, m_args{args}
-		, m_effects{move(effects)}
+		, m_effects{effects}
 		, m_ret{ret}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 private:
-	AstArgsType*         m_objs;
-	AstArgsType*         m_args;
-	Array<AstIdentType*> m_effects;
-	AstType*             m_ret;
-	Array<AstAttr*>      m_attrs;
+	AstArgsType*           m_objs;
+	AstArgsType*           m_args;
+	AstList<AstIdentType*> m_effects;
+	AstType*               m_ret;
+	AstList<AstAttr*>      m_attrs;
 };
 
 struct AstAtomType : AstType {
 	static inline constexpr const auto KIND = Kind::ATOM;
-	constexpr AstAtomType(AstType* base, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstAtomType(AstType* base, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
 		, m_base{base}
-		, m_attrs{move(attrs)}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 private:
-	AstType*        m_base;
-	Array<AstAttr*> m_attrs;
+	AstType*          m_base;
+	AstList<AstAttr*> m_attrs;
 };
 
 struct AstEnumType : AstType {
-	static inline constexpr const auto KIND = Kind::ATOM;
+	static inline constexpr const auto KIND = Kind::ENUM;
 	struct Enumerator {
 		constexpr Enumerator(StringView name, AstExpr* init) noexcept
 			: name{name}
@@ -286,19 +309,39 @@ struct AstEnumType : AstType {
 		AstExpr*   init;
 	};
 
-	constexpr AstEnumType(Array<Enumerator>&& enums, Array<AstAttr*>&& attrs, Range range) noexcept
+	constexpr AstEnumType(AstList<Enumerator> enums, AstList<AstAttr*> attrs, Range range) noexcept
 		: AstType{KIND, range}
-		, m_enums{move(enums)}
-		, m_attrs{move(attrs)}
+		, m_enums{enums}
+		, m_attrs{attrs}
 	{
 	}
-	virtual void dump(StringBuilder& builder) const noexcept override;
-	virtual CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept override;
+	void dump(StringBuilder& builder) const noexcept;
+	CgType* codegen(Cg& cg, Maybe<StringView> name) const noexcept;
 private:
-	Array<Enumerator> m_enums;
-	Array<AstAttr*>   m_attrs;
+	AstList<Enumerator> m_enums;
+	AstList<AstAttr*>   m_attrs;
 };
 
+template<typename F>
+decltype(auto) AstType::visit(F&& f) const noexcept {
+	switch (m_kind) {
+	case Kind::TUPLE:   return f(static_cast<const AstTupleType*>(this));
+	case Kind::ARGS:    return f(static_cast<const AstArgsType*>(this));
+	case Kind::GROUP:   return f(static_cast<const AstGroupType*>(this));
+	case Kind::UNION:   return f(static_cast<const AstUnionType*>(this));
+	case Kind::ENUM:    return f(static_cast<const AstEnumType*>(this));
+	case Kind::PTR:     return f(static_cast<const AstPtrType*>(this));
+	case Kind::ATOM:    return f(static_cast<const AstAtomType*>(this));
+	case Kind::ARRAY:   return f(static_cast<const AstArrayType*>(this));
+	case Kind::VECTOR:  return f(static_cast<const AstVectorType*>(this));
+	case Kind::SLICE:   return f(static_cast<const AstSliceType*>(this));
+	case Kind::IDENT:   return f(static_cast<const AstIdentType*>(this));
+	case Kind::VARARGS: return f(static_cast<const AstVarArgsType*>(this));
+	case Kind::FN:      return f(static_cast<const AstFnType*>(this));
+	}
+	BIRON_UNREACHABLE();
+}
+
 } // namespace Biron
 
 #endif // BIRON_AST_TYPE_H
\ No newline at end of file
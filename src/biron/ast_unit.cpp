@@ -16,7 +16,7 @@ void AstFn::dump(StringBuilder& builder, int depth) const noexcept {
 	builder.append("fn");
 	m_objs->dump(builder);
 	builder.append(' ');
-	builder.append(m_name);
+	builder.append(m_name.string());
 	m_args->dump(builder);
 	if (m_effects.length()) {
 		builder.append(' ');
@@ -36,14 +36,6 @@ void AstFn::dump(StringBuilder& builder, int depth) const noexcept {
 	m_body->dump(builder, depth);
 }
 
-Ast::~Ast() noexcept {
-	for (auto& cache : m_caches) if (cache) {
-		for (auto node : *cache) {
-			static_cast<AstNode*>(node)->~AstNode();
-		}
-	}
-}
-
 void Ast::dump(StringBuilder& builder) const noexcept {
 	static_cast<const AstModule*>((*m_caches[AstID::id<AstModule>()])[0])->dump(builder);
 	const auto& fns = m_caches[AstID::id<AstFn>()];
@@ -1,8 +1,11 @@
 #include <biron/cg.h>
 #include <biron/cg_value.h>
+#include <biron/ast_stmt.h>
 
+#include <biron/util/numeric.inl>
 #include <biron/util/system.inl>
 #include <biron/util/terminal.inl>
+#include <biron/util/trace.h>
 
 namespace Biron {
 
@@ -62,6 +65,7 @@ CgMachine::~CgMachine() noexcept {
 Maybe<Cg> Cg::make(Terminal& terminal,
                    Allocator& allocator,
                    LLVM& llvm,
+                   Symbols& symbols,
                    Diagnostic& diagnostic) noexcept
 {
 	auto context = llvm.ContextCreate();
@@ -89,6 +93,7 @@ Maybe<Cg> Cg::make(Terminal& terminal,
 		terminal,
 		allocator,
 		llvm,
+		symbols,
 		scratch,
 		context,
 		builder,
@@ -104,19 +109,22 @@ Bool Cg::optimize(CgMachine& machine, Ulen level) noexcept {
 	}
 	auto options = llvm.CreatePassBuilderOptions();
 	LLVM::ErrorRef result = nullptr;
-	switch (level) {
-	case 0:
-		result = llvm.RunPasses(module, "default<O0>", machine.ref(), options);
-		break;
-	case 1:
-		result = llvm.RunPasses(module, "default<O1>", machine.ref(), options);
-		break;
-	case 2:
-		result = llvm.RunPasses(module, "default<O2>", machine.ref(), options);
-		break;
-	case 3:
-		result = llvm.RunPasses(module, "default<O3>", machine.ref(), options);
-		break;
+	{
+		TraceScope scope{trace, "RunPasses"};
+		switch (level) {
+		case 0:
+			result = llvm.RunPasses(module, "default<O0>", machine.ref(), options);
+			break;
+		case 1:
+			result = llvm.RunPasses(module, "default<O1>", machine.ref(), options);
+			break;
+		case 2:
+			result = llvm.RunPasses(module, "default<O2>", machine.ref(), options);
+			break;
+		case 3:
+			result = llvm.RunPasses(module, "default<O3>", machine.ref(), options);
+			break;
+		}
 	}
 	llvm.DisposePassBuilderOptions(options);
 	if (result) {
@@ -127,6 +135,7 @@ Bool Cg::optimize(CgMachine& machine, Ulen level) noexcept {
 }
 
 Bool Cg::verify() noexcept {
+	TraceScope scope{trace, "Verify"};
 	char* error = nullptr;
 	if (llvm.VerifyModule(module,
 	                      LLVM::VerifierFailureAction::ReturnStatus,
@@ -141,10 +150,32 @@ Bool Cg::verify() noexcept {
 }
 
 Bool Cg::dump() noexcept {
-	llvm.DumpModule(module);
+	// Print through the terminal rather than DumpModule so the output is kept
+	// together with the rest of the diagnostics for this unit.
+	auto ir = llvm.PrintModuleToString(module);
+	if (!ir) {
+		return false;
+	}
+	m_terminal.err(StringView { ir });
+	llvm.DisposeMessage(ir);
 	return true;
 }
 
+Maybe<StringBuilder> Cg::print(Allocator& allocator) noexcept {
+	auto ir = llvm.PrintModuleToString(module);
+	if (!ir) {
+		return None{};
+	}
+	StringBuilder builder{allocator};
+	builder.append(StringView { ir });
+	llvm.DisposeMessage(ir);
+	if (!builder.valid()) {
+		m_terminal.err("Out of memory\n");
+		return None{};
+	}
+	return builder;
+}
+
 Bool Cg::emit(CgMachine& machine, StringView name) noexcept {
 	char* error = nullptr;
 	if (!verify()) {
@@ -155,6 +186,7 @@ Bool Cg::emit(CgMachine& machine, StringView name) noexcept {
 		m_terminal.err("Out of memory\n");
 		return false;
 	}
+	TraceScope scope{trace, "EmitToFile", name};
 	if (llvm.TargetMachineEmitToFile(machine.ref(),
 	                                 module,
 	                                 terminated,
@@ -169,6 +201,50 @@ Bool Cg::emit(CgMachine& machine, StringView name) noexcept {
 	return true;
 }
 
+Maybe<Array<Uint8>> Cg::emit(CgMachine& machine, Allocator& allocator) noexcept {
+	char* error = nullptr;
+	if (!verify()) {
+		return None{};
+	}
+	LLVM::MemoryBufferRef buffer = nullptr;
+	TraceScope scope{trace, "EmitToMemoryBuffer"};
+	if (llvm.TargetMachineEmitToMemoryBuffer(machine.ref(),
+	                                         module,
+	                                         LLVM::CodeGenFileType::Object,
+	                                         &error,
+	                                         &buffer) != 0)
+	{
+		m_terminal.err("Could not compile module: %s\n", error);
+		llvm.DisposeMessage(error);
+		return None{};
+	}
+	llvm.DisposeMessage(error);
+	const auto data = llvm.GetBufferStart(buffer);
+	const auto size = llvm.GetBufferSize(buffer);
+	Array<Uint8> object{allocator};
+	if (!object.resize(size)) {
+		llvm.DisposeMemoryBuffer(buffer);
+		m_terminal.err("Out of memory\n");
+		return None{};
+	}
+	for (Ulen i = 0; i < size; i++) {
+		object[i] = data[i];
+	}
+	llvm.DisposeMemoryBuffer(buffer);
+	return object;
+}
+
+Maybe<CgValue> Cg::memory_order() noexcept {
+	// Sema bound the MemoryOrder effect in scope at every statement.
+	if (!stmt) {
+		return None{};
+	}
+	if (auto effect = lookup(CgNode { stmt }, symbols[KnownSymbol::MEMORY_ORDER])) {
+		return effect->load(*this);
+	}
+	return None{};
+}
+
 CgAddr Cg::emit_alloca(CgType* type) noexcept {
 	// Emit the alloca at the end of the entry basic block.
 	auto block = llvm.GetInsertBlock(builder);
@@ -181,6 +257,38 @@ CgAddr Cg::emit_alloca(CgType* type) noexcept {
 	return CgAddr { type->addrof(*this), value };
 }
 
+Maybe<CgValue> Cg::emit_eq(const CgValue& lhs, const CgValue& rhs, Range range) noexcept {
+	if (lhs.type()->is_integer() || lhs.type()->is_pointer() || lhs.type()->is_bool()) {
+		auto value = llvm.BuildICmp(builder, LLVM::IntPredicate::EQ, lhs.ref(), rhs.ref(), "");
+		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_real()) {
+		auto value = llvm.BuildFCmp(builder, LLVM::RealPredicate::OEQ, lhs.ref(), rhs.ref(), "");
+		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_eq);
+	}
+	auto lhs_type_string = lhs.type()->to_string(*scratch);
+	return error(range,
+	             "Operands to '==' operator must have scalar type. Got '%S' instead",
+	             lhs_type_string);
+}
+
+Maybe<CgValue> Cg::emit_ne(const CgValue& lhs, const CgValue& rhs, Range range) noexcept {
+	if (lhs.type()->is_integer() || lhs.type()->is_pointer() || lhs.type()->is_bool()) {
+		auto value = llvm.BuildICmp(builder, LLVM::IntPredicate::NE, lhs.ref(), rhs.ref(), "");
+		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_real()) {
+		auto value = llvm.BuildFCmp(builder, LLVM::RealPredicate::ONE, lhs.ref(), rhs.ref(), "");
+		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_ne);
+	}
+	auto lhs_type_string = lhs.type()->to_string(*scratch);
+	return error(range,
+	             "Operands to '!=' operator must have scalar type. Got '%S' instead",
+	             lhs_type_string);
+}
+
 Maybe<CgValue> Cg::emit_lt(const CgValue& lhs, const CgValue& rhs, Range range) noexcept {
 	if (lhs.type()->is_sint()) {
 		auto value = llvm.BuildICmp(builder, LLVM::IntPredicate::SLT, lhs.ref(), rhs.ref(), "");
@@ -191,6 +299,10 @@ Maybe<CgValue> Cg::emit_lt(const CgValue& lhs, const CgValue& rhs, Range range)
 	} else if (lhs.type()->is_real()) {
 		auto value = llvm.BuildFCmp(builder, LLVM::RealPredicate::OLT, lhs.ref(), rhs.ref(), "");
 		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_array()) {
+		return emit_for_array(lhs, rhs, range, &Cg::emit_lt);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_lt);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -208,6 +320,10 @@ Maybe<CgValue> Cg::emit_le(const CgValue& lhs, const CgValue& rhs, Range range)
 	} else if (lhs.type()->is_real()) {
 		auto value = llvm.BuildFCmp(builder, LLVM::RealPredicate::OLE, lhs.ref(), rhs.ref(), "");
 		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_array()) {
+		return emit_for_array(lhs, rhs, range, &Cg::emit_le);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_le);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -225,6 +341,10 @@ Maybe<CgValue> Cg::emit_gt(const CgValue& lhs, const CgValue& rhs, Range range)
 	} else if (lhs.type()->is_real()) {
 		auto value = llvm.BuildFCmp(builder, LLVM::RealPredicate::OGT, lhs.ref(), rhs.ref(), "");
 		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_array()) {
+		return emit_for_array(lhs, rhs, range, &Cg::emit_gt);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_gt);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -242,6 +362,10 @@ Maybe<CgValue> Cg::emit_ge(const CgValue& lhs, const CgValue& rhs, Range range)
 	} else if (lhs.type()->is_real()) {
 		auto value = llvm.BuildFCmp(builder, LLVM::RealPredicate::OGE, lhs.ref(), rhs.ref(), "");
 		return CgValue { types.b32(), value };
+	} else if (lhs.type()->is_array()) {
+		return emit_for_array(lhs, rhs, range, &Cg::emit_ge);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_ge);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -256,6 +380,8 @@ Maybe<CgValue> Cg::emit_add(const CgValue& lhs, const CgValue& rhs, Range range)
 		return CgValue { lhs.type(), llvm.BuildFAdd(builder, lhs.ref(), rhs.ref(), "") };
 	} else if (lhs.type()->is_array()) {
 		return emit_for_array(lhs, rhs, range, &Cg::emit_add);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_add);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -270,6 +396,8 @@ Maybe<CgValue> Cg::emit_sub(const CgValue& lhs, const CgValue& rhs, Range range)
 		return CgValue { lhs.type(), llvm.BuildFSub(builder, lhs.ref(), rhs.ref(), "") };
 	} else if (lhs.type()->is_array()) {
 		return emit_for_array(lhs, rhs, range, &Cg::emit_sub);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_sub);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -284,6 +412,8 @@ Maybe<CgValue> Cg::emit_mul(const CgValue& lhs, const CgValue& rhs, Range range)
 		return CgValue { lhs.type(), llvm.BuildFMul(builder, lhs.ref(), rhs.ref(), "") };
 	} else if (lhs.type()->is_array()) {
 		return emit_for_array(lhs, rhs, range, &Cg::emit_mul);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_mul);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -300,6 +430,8 @@ Maybe<CgValue> Cg::emit_div(const CgValue& lhs, const CgValue& rhs, Range range)
 		return CgValue { lhs.type(), llvm.BuildUDiv(builder, lhs.ref(), rhs.ref(), "") };
 	} else if (lhs.type()->is_array()) {
 		return emit_for_array(lhs, rhs, range, &Cg::emit_div);
+	} else if (lhs.type()->is_vector()) {
+		return emit_for_vector(lhs, rhs, range, &Cg::emit_div);
 	}
 	auto lhs_type_string = lhs.type()->to_string(*scratch);
 	return error(range,
@@ -308,6 +440,9 @@ Maybe<CgValue> Cg::emit_div(const CgValue& lhs, const CgValue& rhs, Range range)
 }
 
 Maybe<CgValue> Cg::emit_min(const CgValue& lhs, const CgValue& rhs, Range range) noexcept {
+	if (lhs.type()->is_array()) {
+		return emit_for_array(lhs, rhs, range, &Cg::emit_min);
+	}
 	if (auto cmp = emit_lt(lhs, rhs, range)) {
 		// lhs < rhs ? lhs : rhs
 		return CgValue { lhs.type(), llvm.BuildSelect(builder, cmp->ref(), lhs.ref(), rhs.ref(), "") };
@@ -316,6 +451,9 @@ Maybe<CgValue> Cg::emit_min(const CgValue& lhs, const CgValue& rhs, Range range)
 }
 
 Maybe<CgValue> Cg::emit_max(const CgValue& lhs, const CgValue& rhs, Range range) noexcept {
+	if (lhs.type()->is_array()) {
+		return emit_for_array(lhs, rhs, range, &Cg::emit_max);
+	}
 	if (auto cmp = emit_gt(lhs, rhs, range)) {
 		// lhs > rhs ? lhs : rhs
 		return CgValue { lhs.type(), llvm.BuildSelect(builder, cmp->ref(), lhs.ref(), rhs.ref(), "") };
@@ -323,6 +461,13 @@ Maybe<CgValue> Cg::emit_max(const CgValue& lhs, const CgValue& rhs, Range range)
 	return None{};
 }
 
+// The machines are made for the generic CPU where a vector register is 16 bytes.
+static constexpr const Ulen VECTOR_BYTES = 16;
+
+// Arrays of numbers are operated on as LLVM vectors. The elements are taken in
+// chunks which fill a vector register and the last chunk takes what is left.
+// Everything else is operated on an element at a time. The results are put
+// straight into the aggregate that is returned.
 Maybe<CgValue> Cg::emit_for_array(const CgValue& lhs,
                                   const CgValue& rhs,
                                   Range range,
@@ -330,28 +475,108 @@ Maybe<CgValue> Cg::emit_for_array(const CgValue& lhs,
                                                              const CgValue&,
                                                              Range))
 {
+	const auto base = lhs.type()->deref();
+	const auto extent = lhs.type()->extent();
+	const auto lanes = base->is_integer() || base->is_real()
+		? max(VECTOR_BYTES / base->size(), 1_ulen)
+		: 1_ulen;
+
 	Array<CgValue> values{*scratch};
-	if (!values.reserve(lhs.type()->extent())) {
+	if (!values.reserve(extent)) {
 		return oom();
 	}
-	for (Ulen l = lhs.type()->extent(), i = 0; i < l; i++) {
-		auto lhs_n = lhs.at(*this, i);
-		auto rhs_n = rhs.at(*this, i);
-		if (!lhs_n || !rhs_n) {
-			return None{};
+	auto i32 = types.u32()->ref();
+	for (Ulen i = 0; i < extent; i += lanes) {
+		const auto n = min(lanes, extent - i);
+		if (n == 1) {
+			auto lhs_n = lhs.at(*this, i);
+			auto rhs_n = rhs.at(*this, i);
+			if (!lhs_n || !rhs_n) {
+				return None{};
+			}
+			auto value = (this->*emit)(*lhs_n, *rhs_n, range);
+			if (!value) {
+				return None{};
+			}
+			(void)values.push_back(*value);
+			continue;
 		}
-		auto value = (this->*emit)(*lhs_n, *rhs_n, range);
+		// The vector is given the type of an element, the emit functions pick the
+		// instruction by it and LLVM applies that instruction to every lane.
+		auto vector = llvm.VectorType(base->ref(), n);
+		auto lhs_v = llvm.GetUndef(vector);
+		auto rhs_v = llvm.GetUndef(vector);
+		for (Ulen j = 0; j < n; j++) {
+			auto lane = llvm.ConstInt(i32, j, false);
+			auto lhs_n = llvm.BuildExtractValue(builder, lhs.ref(), i + j, "");
+			auto rhs_n = llvm.BuildExtractValue(builder, rhs.ref(), i + j, "");
+			lhs_v = llvm.BuildInsertElement(builder, lhs_v, lhs_n, lane, "");
+			rhs_v = llvm.BuildInsertElement(builder, rhs_v, rhs_n, lane, "");
+		}
+		auto value = (this->*emit)(CgValue { base, lhs_v }, CgValue { base, rhs_v }, range);
 		if (!value) {
 			return None{};
 		}
-		(void)values.push_back(*value);
+		for (Ulen j = 0; j < n; j++) {
+			auto lane = llvm.ConstInt(i32, j, false);
+			auto elem = llvm.BuildExtractElement(builder, value->ref(), lane, "");
+			(void)values.push_back(CgValue { value->type(), elem });
+		}
+	}
+
+	// Comparisons give an array of booleans rather than of the operands.
+	auto type = lhs.type();
+	if (extent != 0 && *values[0].type() != *base) {
+		type = types.make(CgType::ArrayInfo { values[0].type(), extent, None{} });
+		if (!type) {
+			return oom();
+		}
 	}
-	auto dst = emit_alloca(lhs.type());
-	Ulen i = 0;
-	for (auto value : values) {
-		dst.at(*this, i++).store(*this, value);
+	auto dst = llvm.GetUndef(type->ref());
+	for (Ulen i = 0; i < extent; i++) {
+		dst = llvm.BuildInsertValue(builder, dst, values[i].ref(), i, "");
 	}
-	return dst.load(*this);
+	return CgValue { type, dst };
+}
+
+// A vector is operated on with the instruction for its element type, which LLVM
+// applies to every lane.
+Maybe<CgValue> Cg::emit_for_vector(const CgValue& lhs,
+                                   const CgValue& rhs,
+                                   Range range,
+                                   Maybe<CgValue> (Cg::*emit)(const CgValue&,
+                                                              const CgValue&,
+                                                              Range))
+{
+	auto base = lhs.type()->deref();
+	auto value = (this->*emit)(CgValue { base, lhs.ref() }, CgValue { base, rhs.ref() }, range);
+	if (!value) {
+		return None{};
+	}
+	if (*value->type() == *base) {
+		return CgValue { lhs.type(), value->ref() };
+	}
+	// Comparisons give a vector of booleans, which is a mask for select.
+	auto type = types.make(CgType::VectorInfo { value->type(), lhs.type()->extent(), None{} });
+	if (!type) {
+		return oom();
+	}
+	return CgValue { type, value->ref() };
+}
+
+LLVM::ValueRef Cg::emit_intrinsic(StringView name,
+                                  LLVM::TypeRef* overloads,
+                                  Ulen n_overloads,
+                                  LLVM::ValueRef* args,
+                                  Ulen n_args) noexcept
+{
+	auto id = llvm.LookupIntrinsicID(name.data(), name.length());
+	if (id == 0) {
+		return nullptr;
+	}
+	auto fn = llvm.GetIntrinsicDeclaration(module, id, overloads, n_overloads);
+	auto type = llvm.IntrinsicGetType(context, id, overloads, n_overloads);
+	return llvm.BuildCall2(builder, type, fn, args, n_args, "");
 }
 
 const char* Cg::nameof(StringView name) const noexcept {
@@ -370,38 +595,37 @@ const char* Cg::nameof(StringView name) const noexcept {
 	return dst;
 }
 
-Maybe<CgVar> Cg::lookup_let(StringView name) const noexcept {
-	for (Ulen l =	scopes.length(), i = l - 1; i < l; i--) {
-		if (auto find = scopes[i].lookup_let(name)) {
-			return find;
+Maybe<CgAddr> Cg::lookup(CgNode use, Symbol name) const noexcept {
+	auto binding = bindings.find(use);
+	if (binding && binding->kind == CgBinding::Kind::LOCAL) {
+		if (auto local = locals.find(binding->local)) {
+			return *local;
 		}
+		return None{};
 	}
-	return None{};
-}
-
-Maybe<CgVar> Cg::lookup_using(StringView name) const noexcept {
-	for (Ulen l =	scopes.length(), i = l - 1; i < l; i--) {
-		if (auto find = scopes[i].lookup_using(name)) {
-			return find;
+	if (!binding || binding->kind == CgBinding::Kind::FN) {
+		if (auto fn = fns.find(name)) {
+			return fn->addr();
+		}
+	}
+	if (!binding || binding->kind == CgBinding::Kind::GLOBAL) {
+		if (auto global = globals.find(name)) {
+			return global->var().addr();
 		}
 	}
 	return None{};
 }
 
-Maybe<CgVar> Cg::lookup_fn(StringView name) const noexcept {
-	for (const auto& fn : fns) {
-		if (fn.name() == name) {
-			return fn;
-		}
+Maybe<CgVar> Cg::lookup_fn(Symbol name) const noexcept {
+	if (auto find = fns.find(name)) {
+		return *find;
 	}
 	return None{};
 }
 
-Maybe<CgAddr> Cg::intrinsic(StringView name) const noexcept {
-	for (const auto& intrinsic : intrinsics) {
-		if (intrinsic.name() == name) {
-			return intrinsic.addr();
-		}
+Maybe<CgAddr> Cg::intrinsic(Symbol name) const noexcept {
+	if (auto find = intrinsics.find(name)) {
+		return *find;
 	}
 	return None{};
 }
@@ -2,21 +2,26 @@
 #define BIRON_CG_H
 #include <biron/cg_type.h>
 #include <biron/cg_value.h>
+#include <biron/symbol.h>
 
 #include <biron/diagnostic.h>
 
 #include <biron/util/string.h>
+#include <biron/util/map.inl>
+#include <biron/util/hash.inl>
 #include <biron/util/error.inl>
 
 namespace Biron {
 
 struct Allocator;
 struct Terminal;
+struct Trace;
 
 struct Diagnostic;
 
 struct Ast;
 struct AstStmt;
+struct AstExpr;
 struct AstFn;
 
 // We keep track of the loop post and exit BBs for "continue" and "break"
@@ -25,46 +30,67 @@ struct Loop {
 	LLVM::BasicBlockRef exit;
 };
 
+// The names of a scope are resolved by Sema ahead of lowering so a scope only
+// has the defers and the loop it is the body of.
 struct CgScope {
 	constexpr CgScope(Allocator& allocator) noexcept
-		: vars{allocator}, tests{allocator}, defers{allocator}, usings{allocator}
+		: defers{allocator}
 	{
 	}
 
 	Bool emit_defers(Cg& cg) const noexcept;
 
-	Maybe<CgVar> lookup_let(StringView name) const noexcept {
-		// Search the flow-sensitive type aliases list first.
-		for (Ulen l = tests.length(), i = l - 1; i < l; i--) {
-			const auto& test = tests[i];
-			if (test.name() == name) {
-				return test;
-			}
-		}
-		for (Ulen l = vars.length(), i = l - 1; i < l; i--) {
-			const auto& var = vars[i];
-			if (var.name() == name) {
-				return var;
-			}
-		}
-		return None{};
+	Array<AstStmt*> defers;
+	Maybe<Loop>     loop;
+};
+
+// A node, or one of the many things a node declares or uses. The locals of a
+// function are known by the node declaring them: the arguments and effects by
+// the function in order, a 'let' or 'using' by its statement and the alias of
+// an 'is' test by its expression. A call uses each effect of its callee.
+struct CgNode {
+	const AstNode* node;
+	Ulen           index = 0;
+	[[nodiscard]] Uint64 hash() const noexcept {
+		return Hash{}.value(node).value(index).result();
 	}
+	[[nodiscard]] constexpr Bool operator==(const CgNode&) const noexcept = default;
+};
 
-	Maybe<CgVar> lookup_using(StringView name) const noexcept {
-		for (Ulen l = usings.length(), i = l - 1; i < l; i--) {
-			const auto& u = usings[i];
-			if (u.name() == name) {
-				return u;
-			}
-		}
-		return None{};
+// What Sema resolved a name to. A local is given its storage by lowering while
+// functions and globals are found by name in the unit.
+struct CgBinding {
+	enum class Kind : Uint8 { LOCAL, FN, GLOBAL };
+	Kind    kind;
+	CgNode  local; // Only for LOCAL
+	CgType* type;  // The type of the address
+};
+
+// A typedef or effect and the unit it is declared in. Types are generated on
+// first use, which may be from another unit with -whole-program.
+struct CgDecl {
+	const AstNode* node;
+	const Ast*     ast;
+	Diagnostic*    diagnostic;
+};
+
+// The type inferred for an expression where a given type is wanted. Typing an
+// expression types its operands again, so the result is kept in Cg::inferred.
+struct CgInfer {
+	const AstExpr* expr;
+	CgType*        want;
+	[[nodiscard]] Uint64 hash() const noexcept {
+		return Hash{}.value(expr).value(want).result();
 	}
+	[[nodiscard]] constexpr Bool operator==(const CgInfer&) const noexcept = default;
+};
 
-	Array<CgVar>    vars;
-	Array<CgVar>    tests;
-	Array<AstStmt*> defers;
-	Array<CgVar>    usings;
-	Maybe<Loop>     loop;
+// The functions of a unit can be generated by many Cg at once, each with its own
+// LLVM context and module. Every Cg lowers only the functions of its partition
+// and declares the others. Globals are defined by the first partition.
+struct CgPartition {
+	Ulen index = 0;
+	Ulen count = 1;
 };
 
 struct CgMachine {
@@ -103,12 +129,15 @@ struct Cg {
 	static Maybe<Cg> make(Terminal& terminal,
 	                      Allocator& allocator,
 	                      LLVM& llvm,
+	                      Symbols& symbols,
 	                      Diagnostic& diagnostic) noexcept;
 
 	[[nodiscard]] Bool optimize(CgMachine& machine, Ulen level) noexcept;
 	[[nodiscard]] Bool verify() noexcept;
 	[[nodiscard]] Bool dump() noexcept;
 	[[nodiscard]] Bool emit(CgMachine& machine, StringView name) noexcept;
+	[[nodiscard]] Maybe<Array<Uint8>> emit(CgMachine& machine, Allocator& allocator) noexcept;
+	[[nodiscard]] Maybe<StringBuilder> print(Allocator& allocator) noexcept;
 
 	// Searches for the lexically closest loop
 	const Loop* loop() const noexcept {
@@ -122,13 +151,13 @@ struct Cg {
 
 	template<typename... Ts>
 	Error error(Range range, StringView fmt, Ts&&... args) const noexcept {
-		m_diagnostic.error(range, fmt, forward<Ts>(args)...);
+		m_diagnostic->error(range, fmt, forward<Ts>(args)...);
 		return {};
 	}
 
 	template<typename... Ts>
 	Error fatal(Range range, StringView fmt, Ts&&... args) const noexcept {
-		m_diagnostic.fatal(range, fmt, forward<Ts>(args)...);
+		m_diagnostic->fatal(range, fmt, forward<Ts>(args)...);
 		return {};
 	}
 
@@ -136,9 +165,118 @@ struct Cg {
 		return fatal(Range{0, 0}, "Out of memory while generating code");
 	}
 
-	Maybe<CgAddr> intrinsic(StringView name) const noexcept;
+	[[nodiscard]] Bool enter_scope() noexcept {
+		return scopes.emplace_back(allocator);
+	}
+	Bool leave_scope() noexcept {
+		return scopes.pop_back();
+	}
+
+	// Diagnostics are reported against the source of the unit being generated.
+	// With -whole-program one Cg generates many units so this is switched.
+	void use(Diagnostic& diagnostic) noexcept {
+		m_diagnostic = &diagnostic;
+	}
+
+	// Declares |node| named |name| in the current unit. The first declaration of
+	// a name wins.
+	[[nodiscard]] Bool declare(HashMap<Symbol, CgDecl>& decls, Symbol name, const AstNode* node) noexcept {
+		return decls.find(name) || decls.insert(name, node, ast, m_diagnostic);
+	}
+
+	// Calls |generate| with the unit of |decl| made current.
+	template<typename F>
+	[[nodiscard]] Bool generate(const CgDecl& decl, F&& generate) noexcept {
+		auto last_ast = exchange(ast, decl.ast);
+		auto last_diagnostic = exchange(m_diagnostic, decl.diagnostic);
+		const auto result = generate();
+		ast = last_ast;
+		m_diagnostic = last_diagnostic;
+		return result;
+	}
+
+	Maybe<CgAddr> intrinsic(Symbol name) const noexcept;
+
+	// Calls the LLVM intrinsic |name| with the overloaded types |overloads|.
+	// Returns nullptr when LLVM has no such intrinsic.
+	LLVM::ValueRef emit_intrinsic(StringView name,
+	                              LLVM::TypeRef* overloads,
+	                              Ulen n_overloads,
+	                              LLVM::ValueRef* args,
+	                              Ulen n_args) noexcept;
+
+	// Atomics are ordered by the MemoryOrder effect in scope, or sequentially
+	// consistent without one. The effect is only known at run time so |emit| is
+	// lowered once for every order behind a switch on it. The switch folds away
+	// when the optimizer finds the order. Returns the phi of the values of |emit|
+	// when |type| is given.
+	template<typename F>
+	LLVM::ValueRef emit_ordered(LLVM::TypeRef type, F&& emit) noexcept {
+		using Ordering = LLVM::AtomicOrdering;
+		static constexpr const Ordering ORDERS[] = {
+			Ordering::Monotonic,              // .RELAXED
+			Ordering::Acquire,                // .ACQUIRE
+			Ordering::Release,                // .RELEASE
+			Ordering::AcquireRelease,         // .ACQ_REL
+			Ordering::SequentiallyConsistent, // .SEQ_CST
+		};
+		auto order = memory_order();
+		if (!order) {
+			return emit(Ordering::SequentiallyConsistent);
+		}
+		auto this_fn = llvm.GetBasicBlockParent(llvm.GetInsertBlock(builder));
+		auto exit_bb = llvm.CreateBasicBlockInContext(context, "ordered");
+		LLVM::BasicBlockRef blocks[countof(ORDERS)];
+		LLVM::ValueRef values[countof(ORDERS)];
+		for (Ulen i = 0; i < countof(ORDERS); i++) {
+			blocks[i] = llvm.CreateBasicBlockInContext(context, "order");
+		}
+		// Any other value is sequentially consistent.
+		const auto last = countof(ORDERS) - 1;
+		auto test = llvm.BuildSwitch(builder, order->ref(), blocks[last], last);
+		for (Ulen i = 0; i < last; i++) {
+			llvm.AddCase(test, llvm.ConstInt(order->type()->ref(), i, false), blocks[i]);
+		}
+		for (Ulen i = 0; i < countof(ORDERS); i++) {
+			llvm.AppendExistingBasicBlock(this_fn, blocks[i]);
+			llvm.PositionBuilderAtEnd(builder, blocks[i]);
+			values[i] = emit(ORDERS[i]);
+			blocks[i] = llvm.GetInsertBlock(builder);
+			llvm.BuildBr(builder, exit_bb);
+		}
+		llvm.AppendExistingBasicBlock(this_fn, exit_bb);
+		llvm.PositionBuilderAtEnd(builder, exit_bb);
+		if (!type) {
+			return nullptr;
+		}
+		auto phi = llvm.BuildPhi(builder, type, "");
+		llvm.AddIncoming(phi, values, blocks, countof(ORDERS));
+		return phi;
+	}
+
+	// A load cannot release and a store cannot acquire so that half of the order
+	// is dropped for them.
+	static constexpr LLVM::AtomicOrdering load_order(LLVM::AtomicOrdering order) noexcept {
+		switch (order) {
+		case LLVM::AtomicOrdering::Release:        return LLVM::AtomicOrdering::Monotonic;
+		case LLVM::AtomicOrdering::AcquireRelease: return LLVM::AtomicOrdering::Acquire;
+		default:                                   return order;
+		}
+	}
+	static constexpr LLVM::AtomicOrdering store_order(LLVM::AtomicOrdering order) noexcept {
+		switch (order) {
+		case LLVM::AtomicOrdering::Acquire:        return LLVM::AtomicOrdering::Monotonic;
+		case LLVM::AtomicOrdering::AcquireRelease: return LLVM::AtomicOrdering::Release;
+		default:                                   return order;
+		}
+	}
+
+	// The value of the MemoryOrder effect in scope.
+	Maybe<CgValue> memory_order() noexcept;
 
 	CgAddr emit_alloca(CgType* type) noexcept;
+	Maybe<CgValue> emit_eq(const CgValue& lhs, const CgValue& rhs, Range range) noexcept;
+	Maybe<CgValue> emit_ne(const CgValue& lhs, const CgValue& rhs, Range range) noexcept;
 	Maybe<CgValue> emit_lt(const CgValue& lhs, const CgValue& rhs, Range range) noexcept;
 	Maybe<CgValue> emit_le(const CgValue& lhs, const CgValue& rhs, Range range) noexcept;
 	Maybe<CgValue> emit_gt(const CgValue& lhs, const CgValue& rhs, Range range) noexcept;
@@ -155,49 +293,78 @@ struct Cg {
 	                              Maybe<CgValue> (Cg::*emit)(const CgValue&,
 	                                                         const CgValue&,
 	                                                         Range));
+	Maybe<CgValue> emit_for_vector(const CgValue& lhs,
+	                               const CgValue& rhs,
+	                               Range range,
+	                               Maybe<CgValue> (Cg::*emit)(const CgValue&,
+	                                                          const CgValue&,
+	                                                          Range));
 
 	const char* nameof(StringView name) const noexcept;
 
-	Maybe<CgVar> lookup_let(StringView name) const noexcept;
-	Maybe<CgVar> lookup_using(StringView name) const noexcept;
-	Maybe<CgVar> lookup_fn(StringView name) const noexcept;
-
-	Allocator&          allocator;
-	LLVM&               llvm;
-	ScratchAllocator*   scratch;
-	ContextRef          context;
-	BuilderRef          builder;
-	ModuleRef           module;
-	CgTypeCache         types;
-	Array<CgVar>        fns;
-	Array<CgGlobal>     globals;
-	Array<CgScope>      scopes;
-	Array<CgTypeDef>    typedefs;
-	Array<CgTypeDef>    effects;
-	Array<CgVar>        intrinsics;
-	const Ast*          ast; // Current unit
-	const AstFn*        fn;  // Current function
-	LLVM::BasicBlockRef entry;
-	StringView          prefix;
+	// The address of what Sema bound |name| used by |use| to. Nothing is bound
+	// outside of functions so there only functions and globals are found.
+	Maybe<CgAddr> lookup(CgNode use, Symbol name) const noexcept;
+	Maybe<CgVar> lookup_fn(Symbol name) const noexcept;
+
+	Allocator&                    allocator;
+	LLVM&                         llvm;
+	Symbols&                      symbols;
+	ScratchAllocator*             scratch;
+	ContextRef                    context;
+	BuilderRef                    builder;
+	ModuleRef                     module;
+	CgTypeCache                   types;
+	HashMap<Symbol, CgVar>        fns;      // The first definition of a name wins
+	HashMap<const AstFn*, CgAddr> fn_addrs; // Every function, by node
+	HashMap<Symbol, CgGlobal>     globals;
+	Array<CgScope>                scopes;
+	HashMap<CgNode, CgBinding>    bindings;  // Every name used by the function, by use
+	HashMap<CgNode, CgAddr>       locals;    // Storage of the locals of the function
+	HashMap<CgNode, AstConst>     constants; // Every constant expression of the function
+	HashMap<Symbol, CgType*>      typedefs;
+	HashMap<Symbol, CgType*>      effects;
+	HashMap<Symbol, CgDecl>       typedef_decls; // Every typedef, by name
+	HashMap<Symbol, CgDecl>       effect_decls;  // Every effect, by name
+	HashMap<Symbol, CgAddr>       intrinsics;
+	HashMap<CgInfer, CgType*>     inferred;
+	const Ast*                    ast;  // Current unit
+	const AstFn*                  fn;   // Current function
+	const AstStmt*                stmt; // Current statement
+	LLVM::BasicBlockRef           entry;
+	StringView                    prefix;
+	CgPartition                   partition;
+	Trace*                        trace; // Optional
 
 	constexpr Cg(Cg&& other) noexcept
 		: allocator{other.allocator}
 		, llvm{other.llvm}
+		, symbols{other.symbols}
 		, scratch{exchange(other.scratch, nullptr)}
 		, context{exchange(other.context, nullptr)}
 		, builder{exchange(other.builder, nullptr)}
 		, module{exchange(other.module, nullptr)}
 		, types{move(other.types)}
 		, fns{move(other.fns)}
+		, fn_addrs{move(other.fn_addrs)}
 		, globals{move(other.globals)}
 		, scopes{move(other.scopes)}
+		, bindings{move(other.bindings)}
+		, locals{move(other.locals)}
+		, constants{move(other.constants)}
 		, typedefs{move(other.typedefs)}
 		, effects{move(other.effects)}
+		, typedef_decls{move(other.typedef_decls)}
+		, effect_decls{move(other.effect_decls)}
 		, intrinsics{move(other.intrinsics)}
+		, inferred{move(other.inferred)}
 		, ast{exchange(other.ast, nullptr)}
 		, fn{exchange(other.fn, nullptr)}
+		, stmt{exchange(other.stmt, nullptr)}
 		, entry{exchange(other.entry, nullptr)}
 		, prefix{move(other.prefix)}
+		, partition{other.partition}
+		, trace{exchange(other.trace, nullptr)}
 		, m_terminal{other.m_terminal}
 		, m_diagnostic{other.m_diagnostic}
 	{
@@ -209,6 +376,7 @@ private:
 	constexpr Cg(Terminal&         terminal,
 	             Allocator&        allocator,
 	             LLVM&             llvm,
+	             Symbols&          symbols,
 	             ScratchAllocator* scratch,
 	             ContextRef        context,
 	             BuilderRef        builder,
@@ -217,28 +385,39 @@ private:
 	             Diagnostic&       diagnostic) noexcept
 		: allocator{allocator}
 		, llvm{llvm}
+		, symbols{symbols}
 		, scratch{scratch}
 		, context{context}
 		, builder{builder}
 		, module{module}
 		, types{move(types)}
 		, fns{allocator}
+		, fn_addrs{allocator}
 		, globals{allocator}
 		, scopes{allocator}
+		, bindings{allocator}
+		, locals{allocator}
+		, constants{allocator}
 		, typedefs{allocator}
 		, effects{allocator}
+		, typedef_decls{allocator}
+		, effect_decls{allocator}
 		, intrinsics{allocator}
+		, inferred{allocator}
 		, ast{nullptr}
 		, fn{nullptr}
+		, stmt{nullptr}
 		, entry{nullptr}
 		, prefix{}
+		, partition{}
+		, trace{nullptr}
 		, m_terminal{terminal}
-		, m_diagnostic{diagnostic}
+		, m_diagnostic{&diagnostic}
 	{
 	}
 
 	Terminal&   m_terminal;
-	Diagnostic& m_diagnostic;
+	Diagnostic* m_diagnostic;
 };
 
 } // namespace Biron
@@ -7,23 +7,62 @@
 #include <biron/ast_unit.h>
 
 #include <biron/util/unreachable.inl>
+#include <biron/util/traits/is_same.inl>
 
 namespace Biron {
 
-Maybe<CgAddr> AstExpr::gen_addr(Cg& cg, CgType*) const noexcept {
-	return cg.fatal(range(), "Unsupported gen_addr for %s", name());
+// Expressions which do not implement a method inherit the one of AstExpr and
+// must not be dispatched to, that would recurse forever.
+Maybe<CgAddr> AstExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
+	return visit([&]<typename T>(const T* expr) -> Maybe<CgAddr> {
+		if constexpr (!is_same<decltype(&T::gen_addr), decltype(&AstExpr::gen_addr)>) {
+			return expr->gen_addr(cg, want);
+		} else {
+			return cg.fatal(range(), "Unsupported gen_addr for %s", name());
+		}
+	});
 }
 
-Maybe<CgValue> AstExpr::gen_value(Cg& cg, CgType*) const noexcept {
-	return cg.fatal(range(), "Unsupported gen_value for %s", name());
+Maybe<CgValue> AstExpr::gen_value(Cg& cg, CgType* want) const noexcept {
+	return visit([&]<typename T>(const T* expr) -> Maybe<CgValue> {
+		if constexpr (!is_same<decltype(&T::gen_value), decltype(&AstExpr::gen_value)>) {
+			return expr->gen_value(cg, want);
+		} else {
+			return cg.fatal(range(), "Unsupported gen_value for %s", name());
+		}
+	});
 }
 
-CgType* AstExpr::gen_type(Cg& cg, CgType*) const noexcept {
-	return cg.fatal(range(), "Unsupported gen_type for %s", name());
+CgType* AstExpr::gen_type(Cg& cg, CgType* want) const noexcept {
+	if (auto type = cg.inferred.find({ this, want })) {
+		return *type;
+	}
+	auto type = visit([&]<typename T>(const T* expr) -> CgType* {
+		if constexpr (!is_same<decltype(&T::gen_type), decltype(&AstExpr::gen_type)>) {
+			return expr->gen_type(cg, want);
+		} else {
+			return cg.fatal(range(), "Unsupported gen_type for %s", name());
+		}
+	});
+	// Failures are not kept so that asking again reports the error again.
+	if (type && !cg.inferred.insert({ this, want }, type)) {
+		return cg.oom();
+	}
+	return type;
 }
 
-Maybe<AstConst> AstExpr::eval_value(Cg&) const noexcept {
-	return None{};
+Maybe<AstConst> AstExpr::eval_value(Cg& cg) const noexcept {
+	// Sema folds every constant expression of a function ahead of lowering.
+	if (auto value = cg.constants.find(CgNode { this })) {
+		return value->copy();
+	}
+	return visit([&]<typename T>(const T* expr) -> Maybe<AstConst> {
+		if constexpr (!is_same<decltype(&T::eval_value), decltype(&AstExpr::eval_value)>) {
+			return expr->eval_value(cg);
+		} else {
+			return None{};
+		}
+	});
 }
 
 static AstExpr* detuple(AstExpr* expr) noexcept {
@@ -61,7 +100,7 @@ const char* AstExpr::name() const noexcept {
 }
 
 Maybe<AstConst> AstTupleExpr::eval_value(Cg& cg) const noexcept {
-	Array<AstConst> values{m_exprs.allocator()};
+	Array<AstConst> values{cg.allocator};
 	Maybe<Range> range;
 	for (const auto& expr : m_exprs) {
 		if (range) {
@@ -78,6 +117,11 @@ Maybe<AstConst> AstTupleExpr::eval_value(Cg& cg) const noexcept {
 		}
 	}
 
+	// The unit tuple is not a constant.
+	if (!range) {
+		return None{};
+	}
+
 	// Should we infer the type for ConstTuple here? A compile-time constant tuple
 	// cannot have fields and cannot be indexed any other way than with integers,
 	// for which a type is not needed. However, it might be useful to have a type
@@ -86,7 +130,7 @@ Maybe<AstConst> AstTupleExpr::eval_value(Cg& cg) const noexcept {
 }
 
 Maybe<CgAddr> AstTupleExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want ? want->deref() : nullptr);
+	auto type = AstExpr::gen_type(cg, want ? want->deref() : nullptr);
 	if (!type) {
 		return None{};
 	}
@@ -134,7 +178,7 @@ Maybe<CgAddr> AstTupleExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 }
 
 Maybe<CgValue> AstTupleExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -182,7 +226,469 @@ CgType* AstTupleExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 	return cg.types.make(CgType::TupleInfo { move(types), None{}, None{} });
 }
 
-CgType* AstCallExpr::gen_type(Cg& cg, CgType*) const noexcept {
+struct Intrinsic {
+	enum class Class : Uint8 { INTEGER, SINT, UINT, REAL };
+	enum class Form : Uint8 { PLAIN, BYTES, POISON, OVERFLOW };
+	StringView llvm;
+	Ulen       operands;
+	Class      cls;
+	Form       form;
+};
+
+static constexpr const Intrinsic INTRINSICS[] = {
+	#define INTRINSIC(NAME, STRING, LLVM, OPERANDS, CLASS, FORM) \
+		{ LLVM, OPERANDS, Intrinsic::Class::CLASS, Intrinsic::Form::FORM },
+	#include <biron/intrinsic.inl>
+	#undef INTRINSIC
+};
+
+// The symbols of the intrinsics follow those of the other builtins.
+static constexpr const Uint32 FIRST_INTRINSIC = Uint32(KnownSymbol::CTPOP);
+
+// The vector builtins, atomic methods and LLVM intrinsics are generic over the
+// type of their operands so they are not functions, a call to one is lowered here
+// instead. A function or variable with the same name hides a free builtin, which
+// is when Sema bound the callee. There are no methods otherwise so nothing can
+// hide an atomic one.
+Maybe<KnownSymbol> AstCallExpr::builtin(Cg& cg) const noexcept {
+	if (auto callee = m_callee->to_expr<const AstVarExpr>()) {
+		const auto name = callee->name();
+		const auto id = name.id();
+		const auto vector = id >= Uint32(KnownSymbol::SHUFFLE) && id <= Uint32(KnownSymbol::FENCE);
+		const auto intrinsic = id >= FIRST_INTRINSIC && id < FIRST_INTRINSIC + countof(INTRINSICS);
+		if ((!vector && !intrinsic) || cg.bindings.find(CgNode { callee }) || cg.lookup_fn(name)) {
+			return None{};
+		}
+		return KnownSymbol(id);
+	}
+	// The atomic methods are called on an atomic like x.fetch_add(1)
+	if (auto callee = m_callee->to_expr<const AstAccessExpr>()) {
+		auto method = callee->rhs()->to_expr<const AstVarExpr>();
+		if (!method) {
+			return None{};
+		}
+		const auto id = method->name().id();
+		if (id < Uint32(KnownSymbol::FETCH_ADD) || id > Uint32(KnownSymbol::COMPARE_EXCHANGE)) {
+			return None{};
+		}
+		return KnownSymbol(id);
+	}
+	return None{};
+}
+
+// LLVM returns the literal struct { T, i1 } from the overflow checked intrinsics
+// and cmpxchg. That has none of the padding of the tuple (T, Bool32) so the fields
+// are moved over one at a time.
+static LLVM::ValueRef retuple(Cg& cg, CgType* tuple, LLVM::ValueRef value) noexcept {
+	auto result = cg.llvm.GetUndef(tuple->ref());
+	for (Ulen l = tuple->length(), i = 0, j = 0; i < l; i++) {
+		if (tuple->at(i)->is_padding()) {
+			continue;
+		}
+		auto field = cg.llvm.BuildExtractValue(cg.builder, value, j++, "");
+		result = cg.llvm.BuildInsertValue(cg.builder, result, field, i, "");
+	}
+	return result;
+}
+
+// shuffle(a, b, i0, ..., iN) -> #[N]T
+// select(mask, a, b)         -> #[N]T
+// reduce_op(a)               -> T
+// fence()                    -> ()
+CgType* AstCallExpr::gen_builtin_type(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept {
+	if (Uint32(builtin) >= FIRST_INTRINSIC) {
+		return gen_intrinsic_type(cg, builtin, want);
+	} else if (builtin >= KnownSymbol::FETCH_ADD) {
+		return gen_atomic_type(cg, builtin);
+	} else if (builtin == KnownSymbol::FENCE) {
+		if (m_args->length() != 0) {
+			return cg.error(m_args->range(), "Wrong number of arguments for 'fence'");
+		}
+		return cg.types.unit();
+	}
+	const auto name = cg.symbols[builtin].string();
+	const auto shuffle = builtin == KnownSymbol::SHUFFLE;
+	const auto select = builtin == KnownSymbol::SELECT;
+	const auto length = m_args->length();
+	if (shuffle ? length < 3 : length != (select ? 3 : 1)) {
+		return cg.error(m_args->range(), "Wrong number of arguments for '%S'", name);
+	}
+	auto arg = m_args->at(select ? 1 : 0);
+	auto type = arg->gen_type(cg, nullptr);
+	if (!type) {
+		return nullptr;
+	}
+	if (!type->is_vector()) {
+		auto type_string = type->to_string(*cg.scratch);
+		return cg.error(arg->range(), "Expected vector for '%S'. Got '%S' instead", name, type_string);
+	}
+	if (shuffle) {
+		return cg.types.make(CgType::VectorInfo { type->deref(), length - 2, None{} });
+	} else if (select) {
+		return type;
+	}
+	return type->deref();
+}
+
+Maybe<CgValue> AstCallExpr::gen_builtin_value(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept {
+	if (Uint32(builtin) >= FIRST_INTRINSIC) {
+		return gen_intrinsic_value(cg, builtin, want);
+	} else if (builtin >= KnownSymbol::FETCH_ADD) {
+		return gen_atomic_value(cg, builtin);
+	}
+	auto type = AstExpr::gen_type(cg, nullptr);
+	if (!type) {
+		return None{};
+	}
+	const auto name = cg.symbols[builtin].string();
+
+	if (builtin == KnownSymbol::FENCE) {
+		// A relaxed fence orders nothing so there is no fence for it.
+		cg.emit_ordered(nullptr, [&](LLVM::AtomicOrdering order) -> LLVM::ValueRef {
+			if (order == LLVM::AtomicOrdering::Monotonic) {
+				return nullptr;
+			}
+			return cg.llvm.BuildFence(cg.builder, order, false, "");
+		});
+		return CgValue { type, nullptr };
+	}
+
+	// The vector operands of the builtin must all have the same type.
+	const auto select = builtin == KnownSymbol::SELECT;
+	const auto count = builtin > KnownSymbol::SELECT ? 1_ulen : 2_ulen;
+	auto vector = m_args->at(select ? 1 : 0)->gen_type(cg, nullptr);
+	LLVM::ValueRef values[2] = {};
+	for (Ulen i = 0; i < count; i++) {
+		auto arg = m_args->at(select ? i + 1 : i);
+		auto value = arg->gen_value(cg, vector);
+		if (!value) {
+			return None{};
+		}
+		if (*value->type() != *vector) {
+			auto want_type_string = vector->to_string(*cg.scratch);
+			auto have_type_string = value->type()->to_string(*cg.scratch);
+			return cg.error(arg->range(),
+			                "Expected expression of type '%S' for argument. Got '%S' instead",
+			                want_type_string,
+			                have_type_string);
+		}
+		values[i] = value->ref();
+	}
+
+	const auto base = vector->deref();
+	auto u32 = cg.types.u32()->ref();
+	switch (builtin) {
+	case KnownSymbol::SHUFFLE:
+		{
+			// The lanes are numbered across both vectors so b[0] is lane N.
+			Array<LLVM::ValueRef> lanes{*cg.scratch};
+			if (!lanes.reserve(type->extent())) {
+				return cg.oom();
+			}
+			for (Ulen l = m_args->length(), i = 2; i < l; i++) {
+				auto arg = m_args->at(i);
+				auto eval = arg->eval_value(cg);
+				auto lane = eval && eval->is_integral() ? eval->to<Uint64>() : None{};
+				if (!lane || *lane >= vector->extent() * 2) {
+					return cg.error(arg->range(), "Expected lane index less than %zu", vector->extent() * 2);
+				}
+				(void)lanes.push_back(cg.llvm.ConstInt(u32, *lane, false));
+			}
+			auto mask = cg.llvm.ConstVector(lanes.data(), lanes.length());
+			auto value = cg.llvm.BuildShuffleVector(cg.builder, values[0], values[1], mask, "");
+			return CgValue { type, value };
+		}
+	case KnownSymbol::SELECT:
+		{
+			auto arg = m_args->at(0);
+			auto mask = arg->gen_value(cg, nullptr);
+			if (!mask) {
+				return None{};
+			}
+			auto mask_type = mask->type();
+			if (!mask_type->is_vector() || !mask_type->deref()->is_bool() || mask_type->extent() != vector->extent()) {
+				auto type_string = mask_type->to_string(*cg.scratch);
+				return cg.error(arg->range(),
+				                "Expected boolean vector of %zu lanes for mask. Got '%S' instead",
+				                vector->extent(),
+				                type_string);
+			}
+			auto value = cg.llvm.BuildSelect(cg.builder, mask->ref(), values[0], values[1], "");
+			return CgValue { type, value };
+		}
+	default:
+		break;
+	}
+
+	// The reductions are the llvm.vector.reduce intrinsics for the element type.
+	// Those on reals take a start value and reduce the lanes in order.
+	StringView intrinsic;
+	LLVM::ValueRef start = nullptr;
+	if (base->is_real()) {
+		switch (builtin) {
+		case KnownSymbol::REDUCE_ADD:
+			intrinsic = "llvm.vector.reduce.fadd";
+			start = cg.llvm.ConstReal(base->ref(), -0.0);
+			break;
+		case KnownSymbol::REDUCE_MUL:
+			intrinsic = "llvm.vector.reduce.fmul";
+			start = cg.llvm.ConstReal(base->ref(), 1.0);
+			break;
+		case KnownSymbol::REDUCE_MIN:
+			intrinsic = "llvm.vector.reduce.fmin";
+			break;
+		case KnownSymbol::REDUCE_MAX:
+			intrinsic = "llvm.vector.reduce.fmax";
+			break;
+		default:
+			break;
+		}
+	} else {
+		const auto sint = base->is_sint();
+		const auto uint = base->is_uint();
+		switch (builtin) {
+		case KnownSymbol::REDUCE_ADD:
+			if (sint || uint) intrinsic = "llvm.vector.reduce.add";
+			break;
+		case KnownSymbol::REDUCE_MUL:
+			if (sint || uint) intrinsic = "llvm.vector.reduce.mul";
+			break;
+		case KnownSymbol::REDUCE_MIN:
+			if (sint) intrinsic = "llvm.vector.reduce.smin";
+			if (uint) intrinsic = "llvm.vector.reduce.umin";
+			break;
+		case KnownSymbol::REDUCE_MAX:
+			if (sint) intrinsic = "llvm.vector.reduce.smax";
+			if (uint) intrinsic = "llvm.vector.reduce.umax";
+			break;
+		case KnownSymbol::REDUCE_AND:
+			intrinsic = "llvm.vector.reduce.and";
+			break;
+		case KnownSymbol::REDUCE_OR:
+			intrinsic = "llvm.vector.reduce.or";
+			break;
+		case KnownSymbol::REDUCE_XOR:
+			intrinsic = "llvm.vector.reduce.xor";
+			break;
+		default:
+			break;
+		}
+	}
+	if (intrinsic.empty()) {
+		auto type_string = vector->to_string(*cg.scratch);
+		return cg.error(m_args->range(), "Cannot use '%S' on '%S'", name, type_string);
+	}
+	LLVM::TypeRef overloads[] = { vector->ref() };
+	LLVM::ValueRef args[] = { start, values[0] };
+	auto value = cg.emit_intrinsic(intrinsic, overloads, 1, args + !start, countof(args) - !start);
+	if (!value) {
+		return cg.fatal(range(), "Could not find intrinsic '%S'", intrinsic);
+	}
+	return CgValue { type, value };
+}
+
+// ctpop(a) -> T, fma(a, b, c) -> T, sadd_overflow(a, b) -> (T, Bool32), ...
+//
+// The result has the type of the operands so that is inferred from what is
+// wanted, except for the tuple of the overflow checked ones.
+CgType* AstCallExpr::gen_intrinsic_type(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept {
+	const auto& intrinsic = INTRINSICS[Uint32(builtin) - FIRST_INTRINSIC];
+	const auto name = cg.symbols[builtin].string();
+	const auto overflow = intrinsic.form == Intrinsic::Form::OVERFLOW;
+	if (m_args->length() != intrinsic.operands) {
+		return cg.error(m_args->range(), "Wrong number of arguments for '%S'", name);
+	}
+	auto arg = m_args->at(0);
+	auto type = arg->gen_type(cg, overflow ? nullptr : want);
+	if (!type) {
+		return nullptr;
+	}
+	auto base = type->is_vector() ? type->deref() : type;
+	Bool valid = false;
+	switch (intrinsic.cls) {
+	case Intrinsic::Class::INTEGER:
+		valid = base->is_integer();
+		break;
+	case Intrinsic::Class::SINT:
+		valid = base->is_sint();
+		break;
+	case Intrinsic::Class::UINT:
+		valid = base->is_uint();
+		break;
+	case Intrinsic::Class::REAL:
+		valid = base->is_real();
+		break;
+	}
+	if (intrinsic.form == Intrinsic::Form::BYTES && base->size() % 2 != 0) {
+		valid = false;
+	}
+	if (!valid) {
+		auto type_string = type->to_string(*cg.scratch);
+		return cg.error(arg->range(), "Cannot use '%S' on '%S'", name, type_string);
+	}
+	if (!overflow) {
+		return type;
+	}
+	auto flag = cg.types.b32();
+	if (type->is_vector()) {
+		flag = cg.types.make(CgType::VectorInfo { flag, type->extent(), None{} });
+	}
+	Array<CgType*> types{*cg.scratch};
+	if (!flag || !types.push_back(type) || !types.push_back(flag)) {
+		return cg.oom();
+	}
+	return cg.types.make(CgType::TupleInfo { move(types), None{}, None{} });
+}
+
+Maybe<CgValue> AstCallExpr::gen_intrinsic_value(Cg& cg, KnownSymbol builtin, CgType* want) const noexcept {
+	auto type = AstExpr::gen_type(cg, want);
+	if (!type) {
+		return None{};
+	}
+	const auto& intrinsic = INTRINSICS[Uint32(builtin) - FIRST_INTRINSIC];
+	const auto overflow = intrinsic.form == Intrinsic::Form::OVERFLOW;
+	auto operand = overflow ? type->at_virt(0) : type;
+
+	LLVM::ValueRef values[4] = {};
+	Ulen n_values = 0;
+	for (Ulen i = 0; i < intrinsic.operands; i++) {
+		auto arg = m_args->at(i);
+		auto value = arg->gen_value(cg, operand);
+		if (!value) {
+			return None{};
+		}
+		if (*value->type() != *operand) {
+			auto want_type_string = operand->to_string(*cg.scratch);
+			auto have_type_string = value->type()->to_string(*cg.scratch);
+			return cg.error(arg->range(),
+			                "Expected expression of type '%S' for argument. Got '%S' instead",
+			                want_type_string,
+			                have_type_string);
+		}
+		values[n_values++] = value->ref();
+	}
+	if (intrinsic.form == Intrinsic::Form::POISON) {
+		values[n_values++] = cg.llvm.ConstInt(cg.types.b32()->ref(), 0, false);
+	}
+
+	LLVM::TypeRef overloads[] = { operand->ref() };
+	auto value = cg.emit_intrinsic(intrinsic.llvm, overloads, 1, values, n_values);
+	if (!value) {
+		return cg.fatal(range(), "Could not find intrinsic '%S'", intrinsic.llvm);
+	}
+	if (overflow) {
+		value = retuple(cg, type, value);
+	}
+	return CgValue { type, value };
+}
+
+// x.fetch_op(v)            -> T
+// x.exchange(v)            -> T
+// x.compare_exchange(e, v) -> (T, Bool32)
+//
+// Where x is a @T or *@T. The fetch operations are only for integers.
+CgType* AstCallExpr::gen_atomic_type(Cg& cg, KnownSymbol builtin) const noexcept {
+	const auto name = cg.symbols[builtin].string();
+	const auto compare = builtin == KnownSymbol::COMPARE_EXCHANGE;
+	auto lhs = static_cast<const AstAccessExpr*>(m_callee)->lhs();
+	auto type = lhs->gen_type(cg, nullptr);
+	if (!type) {
+		return nullptr;
+	}
+	if (type->is_pointer() && type->deref()) {
+		type = type->deref();
+	}
+	if (!type->is_atomic()) {
+		auto type_string = type->to_string(*cg.scratch);
+		return cg.error(lhs->range(), "Expected atomic for '%S'. Got '%S' instead", name, type_string);
+	}
+	if (m_args->length() != (compare ? 2 : 1)) {
+		return cg.error(m_args->range(), "Wrong number of arguments for '%S'", name);
+	}
+	auto base = type->deref();
+	if (builtin < KnownSymbol::EXCHANGE && !base->is_integer()) {
+		auto type_string = type->to_string(*cg.scratch);
+		return cg.error(lhs->range(), "Cannot use '%S' on '%S'", name, type_string);
+	}
+	if (!compare) {
+		return base;
+	}
+	Array<CgType*> types{*cg.scratch};
+	if (!types.push_back(base) || !types.push_back(cg.types.b32())) {
+		return cg.oom();
+	}
+	return cg.types.make(CgType::TupleInfo { move(types), None{}, None{} });
+}
+
+Maybe<CgValue> AstCallExpr::gen_atomic_value(Cg& cg, KnownSymbol builtin) const noexcept {
+	auto type = AstExpr::gen_type(cg, nullptr);
+	if (!type) {
+		return None{};
+	}
+	auto addr = static_cast<const AstAccessExpr*>(m_callee)->lhs()->gen_addr(cg, nullptr);
+	if (!addr) {
+		return None{};
+	}
+	if (addr->type()->deref()->is_pointer()) {
+		// Handle implicit dereference:
+		//	a.fetch_add(1) -> (*a).fetch_add(1)
+		addr = addr->load(cg).to_addr();
+	}
+	auto base = addr->type()->deref()->deref();
+
+	LLVM::ValueRef values[2] = {};
+	for (Ulen l = m_args->length(), i = 0; i < l; i++) {
+		auto arg = m_args->at(i);
+		auto value = arg->gen_value(cg, base);
+		if (!value) {
+			return None{};
+		}
+		if (*value->type() != *base) {
+			auto want_type_string = base->to_string(*cg.scratch);
+			auto have_type_string = value->type()->to_string(*cg.scratch);
+			return cg.error(arg->range(),
+			                "Expected expression of type '%S' for argument. Got '%S' instead",
+			                want_type_string,
+			                have_type_string);
+		}
+		values[i] = value->ref();
+	}
+
+	if (builtin == KnownSymbol::COMPARE_EXCHANGE) {
+		// The order when the compare fails cannot release as nothing is stored.
+		LLVM::TypeRef fields[] = { base->ref(), cg.types.b32()->ref() };
+		auto result = cg.llvm.StructTypeInContext(cg.context, fields, countof(fields), false);
+		auto value = cg.emit_ordered(result, [&](LLVM::AtomicOrdering order) {
+			return cg.llvm.BuildAtomicCmpXchg(cg.builder,
+			                                  addr->ref(),
+			                                  values[0],
+			                                  values[1],
+			                                  order,
+			                                  Cg::load_order(order),
+			                                  false);
+		});
+		return CgValue { type, retuple(cg, type, value) };
+	}
+
+	LLVM::AtomicRMWBinOp op;
+	switch (builtin) {
+	case KnownSymbol::FETCH_ADD: op = LLVM::AtomicRMWBinOp::Add;  break;
+	case KnownSymbol::FETCH_SUB: op = LLVM::AtomicRMWBinOp::Sub;  break;
+	case KnownSymbol::FETCH_AND: op = LLVM::AtomicRMWBinOp::And;  break;
+	case KnownSymbol::FETCH_OR:  op = LLVM::AtomicRMWBinOp::Or;   break;
+	case KnownSymbol::FETCH_XOR: op = LLVM::AtomicRMWBinOp::Xor;  break;
+	default:                     op = LLVM::AtomicRMWBinOp::Xchg; break;
+	}
+	auto value = cg.emit_ordered(base->ref(), [&](LLVM::AtomicOrdering order) {
+		return cg.llvm.BuildAtomicRMW(cg.builder, op, addr->ref(), values[0], order, false);
+	});
+	return CgValue { type, value };
+}
+
+CgType* AstCallExpr::gen_type(Cg& cg, CgType* want) const noexcept {
+	if (auto builtin = this->builtin(cg)) {
+		return gen_builtin_type(cg, *builtin, want);
+	}
 	auto fn = m_callee->gen_type(cg, nullptr);
 	if (!fn) {
 		return nullptr;
@@ -230,8 +736,11 @@ Maybe<CgAddr> AstCallExpr::gen_addr(Cg&, CgType*) const noexcept {
 	return None{};
 }
 
-Maybe<CgValue> AstCallExpr::gen_value(Cg& cg, CgType*) const noexcept {
-	if (!gen_type(cg, nullptr)) {
+Maybe<CgValue> AstCallExpr::gen_value(Cg& cg, CgType* want) const noexcept {
+	if (auto builtin = this->builtin(cg)) {
+		return gen_builtin_value(cg, *builtin, want);
+	}
+	if (!AstExpr::gen_type(cg, nullptr)) {
 		return None{};
 	}
 
@@ -275,13 +784,19 @@ Maybe<CgValue> AstCallExpr::gen_value(Cg& cg, CgType*) const noexcept {
 
 	// Populate the optional effects.
 	if (effects != cg.types.unit()) {
-		Array<CgVar> usings{*cg.scratch};
+		// Sema bound every effect of the callee to the one in scope at the call.
+		Array<CgAddr> usings{*cg.scratch};
 		const auto& fields = effects->fields();
-		for (const auto& field : fields) {
+		for (Ulen l = fields.length(), i = 0; i < l; i++) {
+			const auto& field = fields[i];
 			if (!field.name) {
 				continue;
 			}
-			auto lookup = cg.lookup_using(*field.name);
+			auto name = cg.symbols.intern(*field.name);
+			if (!name) {
+				return cg.oom();
+			}
+			auto lookup = cg.lookup(CgNode { this, i }, *name);
 			if (!lookup) {
 				return cg.error(m_callee->range(), "This function requires the '%S' effect", *field.name);
 			}
@@ -301,7 +816,7 @@ Maybe<CgValue> AstCallExpr::gen_value(Cg& cg, CgType*) const noexcept {
 			(void)dsts.emplace_back(dst.at_virt(cg, i));
 		}
 		for (Ulen l = usings.length(), i = 0; i < l; i++) {
-			dsts[i].store(cg, usings[i].addr().load(cg));
+			dsts[i].store(cg, usings[i].load(cg));
 		}
 		// Then pass that tuple by address as the first argument to the function.
 		if (!values.push_back(dst.ref())) {
@@ -420,40 +935,26 @@ Maybe<CgValue> AstCallExpr::gen_value(Cg& cg, CgType*) const noexcept {
 }
 
 Maybe<AstConst> AstVarExpr::eval_value(Cg& cg) const noexcept {
-	for (const auto& global : cg.globals) {
-		if (global.var().name() == m_name) {
-			return global.value().copy();
-		}
+	// Only a global is a valid compile-time expression, a local may shadow one.
+	auto binding = cg.bindings.find(CgNode { this });
+	if (binding && binding->kind != CgBinding::Kind::GLOBAL) {
+		return None{};
+	}
+	if (auto global = cg.globals.find(m_name)) {
+		return global->value().copy();
 	}
-	// Not a valid compile-time expression
 	return None{};
 }
 
 Maybe<CgAddr> AstVarExpr::gen_addr(Cg& cg, CgType*) const noexcept {
-	auto lookup = cg.lookup_let(m_name);
-	if (lookup) {
-		return lookup->addr();
-	}
-
-	// Search module for functions.
-	for (const auto& fn : cg.fns) {
-		if (fn.name() == m_name) {
-			return fn.addr();
-		}
-	}
-
-	// Search module for globals.
-	for (const auto& global : cg.globals) {
-		if (global.var().name() == m_name) {
-			return global.var().addr();
-		}
+	if (auto addr = cg.lookup(CgNode { this }, m_name)) {
+		return addr;
 	}
-
-	return cg.error(range(), "Could not find symbol '%S'", m_name);
+	return cg.error(range(), "Could not find symbol '%S'", m_name.string());
 }
 
 Maybe<CgValue> AstVarExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -464,11 +965,15 @@ Maybe<CgValue> AstVarExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 }
 
 CgType* AstVarExpr::gen_type(Cg& cg, CgType* want) const noexcept {
-	auto addr = gen_addr(cg, want ? want->addrof(cg) : nullptr);
-	if (!addr) {
+	// The type of a local is known before it has storage.
+	CgType* type = nullptr;
+	if (auto binding = cg.bindings.find(CgNode { this })) {
+		type = binding->type;
+	} else if (auto addr = gen_addr(cg, want ? want->addrof(cg) : nullptr)) {
+		type = addr->type();
+	} else {
 		return cg.fatal(range(), "Could not generate type (AstVarExpr)");
 	}
-	auto type = addr->type();
 	auto deref = type->deref();
 	return deref->is_fn() ? type : deref;
 }
@@ -505,7 +1010,7 @@ CgType* AstSelectorExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 }
 
 Maybe<CgValue> AstSelectorExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -559,7 +1064,7 @@ Maybe<CgValue> AstIntExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		want = want->types()[0];
 	}
 
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -619,7 +1124,7 @@ Maybe<AstConst> AstFltExpr::eval_value(Cg&) const noexcept {
 }
 
 Maybe<CgValue> AstFltExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -667,7 +1172,7 @@ Maybe<AstConst> AstStrExpr::eval_value(Cg&) const noexcept {
 }
 
 Maybe<CgValue> AstStrExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -708,7 +1213,7 @@ Maybe<AstConst> AstBoolExpr::eval_value(Cg&) const noexcept {
 }
 
 Maybe<CgValue> AstBoolExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	auto value = cg.llvm.ConstInt(type->ref(), m_value ? 1 : 0, false);
 	return CgValue { type, value };
 }
@@ -722,8 +1227,11 @@ CgType* AstBoolExpr::gen_type(Cg& cg, CgType*) const noexcept {
 }
 
 Maybe<AstConst> AstAggExpr::eval_value(Cg& cg) const noexcept {
-	ScratchAllocator scratch{m_exprs.allocator()};
-	Array<AstConst> values{m_exprs.allocator()};
+	if (m_exprs.empty()) {
+		return None{};
+	}
+	ScratchAllocator scratch{cg.allocator};
+	Array<AstConst> values{cg.allocator};
 	if (!values.reserve(m_exprs.length())) {
 		return None{};
 	}
@@ -748,7 +1256,7 @@ Maybe<AstConst> AstAggExpr::eval_value(Cg& cg) const noexcept {
 }
 
 Maybe<CgAddr> AstAggExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want ? want->deref() : nullptr);
+	auto type = AstExpr::gen_type(cg, want ? want->deref() : nullptr);
 	if (!type) {
 		return cg.fatal(range(), "Could not generate type (AstAggExpr)");
 	}
@@ -757,6 +1265,15 @@ Maybe<CgAddr> AstAggExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 	// likely cannot fit into a regsiter. This means an aggregate has an address.
 	auto addr = cg.emit_alloca(type);
 
+	// A vector does fit in a register so it is built as a value.
+	if (type->is_vector()) {
+		auto value = gen_value(cg, type);
+		if (!value || !addr.store(cg, *value)) {
+			return None{};
+		}
+		return addr;
+	}
+
 	Ulen count = 1;
 	Bool scalar = false;
 	if (type->is_array()) {
@@ -828,6 +1345,9 @@ Maybe<CgAddr> AstAggExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 		} else if (auto expr = m_exprs.at(j++)) {
 			// Otherwise take the next expression and store it at i'th.
 			auto infer = type->is_array() ? type->at(0) : type->at(i);
+			if (infer->is_atomic()) {
+				infer = infer->deref();
+			}
 			auto value = (*expr)->gen_value(cg, infer);
 			if (!value) {
 				return None{};
@@ -841,6 +1361,11 @@ Maybe<CgAddr> AstAggExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 				}
 			}
 
+			// An atomic is initialized with a value of its base type.
+			if (dst_type->is_atomic() && *value->type() == *dst_type->deref()) {
+				dst_type = value->type();
+			}
+
 			if (*value->type() != *dst_type) {
 				return cg.error(m_exprs[0]->range(), "Expression with incompatible type in aggregate");
 			}
@@ -859,10 +1384,30 @@ Maybe<CgAddr> AstAggExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 }
 
 Maybe<CgValue> AstAggExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
+	if (type->is_vector()) {
+		if (m_exprs.length() > type->extent()) {
+			return cg.error(range(), "Too many expressions in aggregate initializer");
+		}
+		// The lanes without an expression are zero.
+		auto base = type->deref();
+		auto value = cg.llvm.ConstNull(type->ref());
+		for (Ulen l = m_exprs.length(), i = 0; i < l; i++) {
+			auto elem = m_exprs[i]->gen_value(cg, base);
+			if (!elem) {
+				return None{};
+			}
+			if (*elem->type() != *base) {
+				return cg.error(m_exprs[i]->range(), "Expression with incompatible type in aggregate");
+			}
+			auto index = cg.llvm.ConstInt(cg.types.u32()->ref(), i, false);
+			value = cg.llvm.BuildInsertElement(cg.builder, value, elem->ref(), index, "");
+		}
+		return CgValue { type, value };
+	}
 	if (auto addr = gen_addr(cg, type->addrof(cg))) {
 		return addr->load(cg);
 	}
@@ -922,13 +1467,13 @@ CgType* AstAccessExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 		if (lhs_type->is_tuple() || lhs_type->is_enum()) {
 			Ulen i = 0;
 			for (const auto& field : lhs_type->fields()) {
-				if (field.name && *field.name == rhs->name()) {
+				if (field.name && *field.name == rhs->name().string()) {
 					return lhs_type->at(i);
 				}
 				i++;
 			}
 		}
-		return cg.error(m_rhs->range(), "Undeclared field '%S'", rhs->name());
+		return cg.error(m_rhs->range(), "Undeclared field '%S'", rhs->name().string());
 	} else if (m_rhs->is_expr<AstIntExpr>()) {
 		const auto value = m_rhs->eval_value(cg);
 		if (!value || !value->is_integral()) {
@@ -944,7 +1489,7 @@ CgType* AstAccessExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 }
 
 Maybe<CgAddr> AstAccessExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
-	if (!gen_type(cg, want ? want->deref() : nullptr)) {
+	if (!AstExpr::gen_type(cg, want ? want->deref() : nullptr)) {
 		return None{};
 	}
 
@@ -1002,7 +1547,7 @@ Maybe<CgAddr> AstAccessExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 			type = type->deref();
 		}
 		if (type->is_tuple()) {
-			const auto& name = expr->name();
+			const auto name = expr->name().string();
 			const auto& fields = type->fields();
 			for (Ulen l = fields.length(), i = 0; i < l; i++) {
 				const auto& field = fields[i];
@@ -1115,9 +1660,6 @@ Maybe<AstConst> AstBinExpr::eval_value(Cg& cg) const noexcept {
 }
 
 Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	using IntPredicate = LLVM::IntPredicate;
-	using RealPredicate = LLVM::RealPredicate;
-
 	CgType* lhs_type = nullptr;
 	CgType* rhs_type = nullptr;
 
@@ -1151,6 +1693,9 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		return None{};
 	}
 
+	// The bitwise operators on a vector apply to every lane.
+	auto elem_type = lhs_type->is_vector() ? lhs_type->deref() : lhs_type;
+
 	switch (m_op) {
 	case Op::ADD:
 		return cg.emit_add(*lhs, *rhs, range());
@@ -1165,14 +1710,10 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 	case Op::MAX:
 		return cg.emit_max(*lhs, *rhs, range());
 	case Op::EQ:
-		if (lhs_type->is_sint() || lhs_type->is_uint() || lhs_type->is_pointer()) {
-			auto value = cg.llvm.BuildICmp(cg.builder, IntPredicate::EQ, lhs->ref(), rhs->ref(), "");
-			return CgValue { cg.types.b32(), value };
-		} else if (lhs_type->is_real()) {
-			auto value = cg.llvm.BuildFCmp(cg.builder, RealPredicate::OEQ, lhs->ref(), rhs->ref(), "");
-			return CgValue { cg.types.b32(), value };
+		if (lhs_type->is_integer() || lhs_type->is_pointer() || lhs_type->is_real() || lhs_type->is_vector()) {
+			return cg.emit_eq(*lhs, *rhs, range());
 		} else {
-			auto intrinsic = cg.intrinsic("memory_eq");
+			auto intrinsic = cg.intrinsic(cg.symbols[KnownSymbol::MEMORY_EQ]);
 			if (!intrinsic) {
 				return cg.fatal(range(), "Could not find 'memory_eq' intrinsic");
 			}
@@ -1193,14 +1734,10 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		}
 		break;
 	case Op::NE:
-		if (lhs_type->is_sint() || lhs_type->is_uint() || lhs_type->is_pointer()) {
-			auto value = cg.llvm.BuildICmp(cg.builder, IntPredicate::NE, lhs->ref(), rhs->ref(), "");
-			return CgValue { cg.types.b32(), value };
-		} else if (lhs_type->is_real()) {
-			auto value = cg.llvm.BuildFCmp(cg.builder, RealPredicate::ONE, lhs->ref(), rhs->ref(), "");
-			return CgValue { cg.types.b32(), value };
+		if (lhs_type->is_integer() || lhs_type->is_pointer() || lhs_type->is_real() || lhs_type->is_vector()) {
+			return cg.emit_ne(*lhs, *rhs, range());
 		} else {
-			auto intrinsic = cg.intrinsic("memory_ne");
+			auto intrinsic = cg.intrinsic(cg.symbols[KnownSymbol::MEMORY_NE]);
 			if (!intrinsic) {
 				return cg.fatal(range(), "Could not find 'memory_ne' intrinsic");
 			}
@@ -1229,7 +1766,7 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 	case Op::LE:
 		return cg.emit_le(*lhs, *rhs, range());
 	case Op::BOR:
-		if (lhs_type->is_integer() || lhs_type->is_bool()) {
+		if (elem_type->is_integer() || elem_type->is_bool()) {
 			auto value = cg.llvm.BuildOr(cg.builder, lhs->ref(), rhs->ref(), "");
 			return CgValue { lhs_type, value };
 		} else {
@@ -1241,7 +1778,7 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		}
 		break;
 	case Op::BAND:
-		if (lhs_type->is_integer() || lhs_type->is_bool()) {
+		if (elem_type->is_integer() || elem_type->is_bool()) {
 			auto value = cg.llvm.BuildAnd(cg.builder, lhs->ref(), rhs->ref(), "");
 			return CgValue { lhs_type, value };
 		} else {
@@ -1252,7 +1789,7 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		}
 		break;
 	case Op::LSHIFT:
-		if (lhs_type->is_integer()) {
+		if (elem_type->is_integer()) {
 			auto value = cg.llvm.BuildShl(cg.builder, lhs->ref(), rhs->ref(), "");
 			return CgValue { lhs_type, value };
 		} else {
@@ -1263,10 +1800,10 @@ Maybe<CgValue> AstBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		}
 		break;
 	case Op::RSHIFT:
-		if (lhs_type->is_sint()) {
+		if (elem_type->is_sint()) {
 			auto value = cg.llvm.BuildAShr(cg.builder, lhs->ref(), rhs->ref(), "");
 			return CgValue { lhs_type, value };
-		} else if (lhs_type->is_uint()) {
+		} else if (elem_type->is_uint()) {
 			auto value = cg.llvm.BuildLShr(cg.builder, lhs->ref(), rhs->ref(), "");
 			return CgValue { lhs_type, value };
 		} else {
@@ -1295,14 +1832,31 @@ Maybe<CgAddr> AstBinExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 
 CgType* AstBinExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 	auto lhs_expr = detuple(m_lhs);
-	if (auto type = lhs_expr->gen_type(cg, want)) {
-		return type;
+	auto type = lhs_expr->gen_type(cg, want);
+	if (!type) {
+		auto rhs_expr = detuple(m_rhs);
+		type = rhs_expr->gen_type(cg, want);
 	}
-	auto rhs_expr = detuple(m_rhs);
-	if (auto type = rhs_expr->gen_type(cg, want)) {
-		return type;
+	if (!type) {
+		return nullptr;
 	}
-	return nullptr;
+	// Arrays and vectors are compared element-wise which gives an array or vector
+	// of booleans.
+	switch (m_op) {
+	case Op::LT: case Op::LE: case Op::GT: case Op::GE:
+		if (type->is_array()) {
+			return cg.types.make(CgType::ArrayInfo { cg.types.b32(), type->extent(), None{} });
+		}
+		[[fallthrough]];
+	case Op::EQ: case Op::NE:
+		if (type->is_vector()) {
+			return cg.types.make(CgType::VectorInfo { cg.types.b32(), type->extent(), None{} });
+		}
+		break;
+	default:
+		break;
+	}
+	return type;
 }
 
 Maybe<CgValue> AstLBinExpr::gen_value(Cg& cg, CgType* want) const noexcept {
@@ -1565,7 +2119,7 @@ Maybe<CgAddr> AstUnaryExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
 }
 
 Maybe<CgValue> AstUnaryExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return None{};
 	}
@@ -1574,7 +2128,8 @@ Maybe<CgValue> AstUnaryExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 	switch (m_op) {
 	case Op::NEG:
 		if (auto value = operand->gen_value(cg, type)) {
-			if (value->type()->is_real()) {
+			auto elem = value->type()->is_vector() ? value->type()->deref() : value->type();
+			if (elem->is_real()) {
 				return CgValue { value->type(), cg.llvm.BuildFNeg(cg.builder, value->ref(), "") };
 			} else {
 				return CgValue { value->type(), cg.llvm.BuildNeg(cg.builder, value->ref(), "") };
@@ -1642,6 +2197,11 @@ Maybe<CgAddr> AstIndexExpr::gen_addr(Cg& cg, CgType*) const noexcept {
 		operand = operand->at(cg, 0);
 	}
 
+	if (auto type = operand->type()->deref(); type->is_vector() && type->deref()->is_bool()) {
+		auto type_string = type->to_string(*cg.scratch);
+		return cg.error(range(), "Cannot take the address of a lane of '%S'", type_string);
+	}
+
 	// Optimization for constant integer expression indexing.
 	if (auto eval = m_index->eval_value(cg)) {
 		if (!eval->is_integral()) {
@@ -1670,11 +2230,29 @@ Maybe<CgAddr> AstIndexExpr::gen_addr(Cg& cg, CgType*) const noexcept {
 }
 
 Maybe<CgValue> AstIndexExpr::gen_value(Cg& cg, CgType* want) const noexcept {
-	auto type = gen_type(cg, want);
+	auto type = AstExpr::gen_type(cg, want);
 	if (!type) {
 		return cg.fatal(range(), "Could not generate type");
 	}
 
+	// A lane of a vector is extracted from its value, it need not have an address.
+	auto operand_expr = detuple(m_operand);
+	if (auto operand_type = operand_expr->gen_type(cg, nullptr); operand_type && operand_type->is_vector()) {
+		auto operand = operand_expr->gen_value(cg, operand_type);
+		auto index = m_index->gen_value(cg, cg.types.u64());
+		if (!operand || !index) {
+			return None{};
+		}
+		if (!index->type()->is_integer()) {
+			auto index_type_string = index->type()->to_string(*cg.scratch);
+			return cg.error(m_index->range(),
+			                "Expected expression of integer type for index. Got '%S' instead",
+			                index_type_string);
+		}
+		auto value = cg.llvm.BuildExtractElement(cg.builder, operand->ref(), index->ref(), "");
+		return CgValue { type, value };
+	}
+
 	// Cannot use CgValue::at when working with something that requires a load.
 	// TODO(dweiler): reenable when I work out chained pointer dereference typing
 	if (false && !type->is_pointer() && !type->is_slice() && !type->is_string()) {
@@ -1709,7 +2287,7 @@ CgType* AstIndexExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 		return nullptr;
 	}
 
-	if (!type->is_pointer() && !type->is_array() && !type->is_slice() && !type->is_string()) {
+	if (!type->is_pointer() && !type->is_array() && !type->is_vector() && !type->is_slice() && !type->is_string()) {
 		auto type_string = type->to_string(*cg.scratch);
 		return cg.error(range(), "Cannot index expression of type '%S'", type_string);
 	}
@@ -1734,7 +2312,7 @@ Maybe<AstConst> AstIndexExpr::eval_value(Cg& cg) const noexcept {
 			return value->copy();
 		}
 	} else if (operand->is_array()) {
-		if (auto value = index->as_array().elems.at(*i)) {
+		if (auto value = operand->as_array().elems.at(*i)) {
 			return value->copy();
 		}
 	} else if (operand->is_string()) {
@@ -1754,11 +2332,11 @@ Maybe<CgAddr> AstEffExpr::gen_addr(Cg& cg, CgType*) const noexcept {
 	if (!expr) {
 		return cg.error(m_operand->range(), "Expected expression for effect");
 	}
-	auto find = cg.lookup_using(expr->name());
+	auto find = cg.lookup(CgNode { this }, expr->name());
 	if (!find) {
-		return cg.error(m_operand->range(), "Could not find effect '%S'", expr->name());
+		return cg.error(m_operand->range(), "Could not find effect '%S'", expr->name().string());
 	}
-	return find->addr();
+	return find;
 }
 
 Maybe<CgValue> AstEffExpr::gen_value(Cg& cg, CgType* want) const noexcept {
@@ -1770,6 +2348,9 @@ Maybe<CgValue> AstEffExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 }
 
 CgType* AstEffExpr::gen_type(Cg& cg, CgType* want) const noexcept {
+	if (auto binding = cg.bindings.find(CgNode { this })) {
+		return binding->type->deref();
+	}
 	auto addr = gen_addr(cg, want ? want->addrof(cg) : nullptr);
 	if (!addr) {
 		return nullptr;
@@ -1784,7 +2365,11 @@ Maybe<AstConst> AstCastExpr::eval_value(Cg& cg) const noexcept {
 		return None{};
 	}
 	// TODO(dweiler): constant casting
-	return AstConst { value->range(), *value->to<Uint64>() };
+	auto u64 = value->to<Uint64>();
+	if (!u64) {
+		return None{};
+	}
+	return AstConst { value->range(), *u64 };
 }
 
 Maybe<CgAddr> AstCastExpr::gen_addr(Cg& cg, CgType* want) const noexcept {
@@ -1810,7 +2395,7 @@ Maybe<CgValue> AstCastExpr::gen_value(Cg& cg, CgType* want) const noexcept {
 		return None{};
 	}
 
-	auto dst = gen_type(cg, want);
+	auto dst = AstExpr::gen_type(cg, want);
 	if (!dst) {
 		return None{};
 	}
@@ -1861,10 +2446,10 @@ Maybe<CgValue> AstTestExpr::gen_value(Cg& cg, CgType*) const noexcept {
 			auto have = expr->load(cg).at(cg, 1)->ref();
 			auto test = cg.llvm.BuildICmp(cg.builder, LLVM::IntPredicate::EQ, have, want, "");
 
-			// We also emit the flow-sensitive alias if the operand was an AstVarExpr
-			if (auto var = operand->to_expr<AstVarExpr>()) {
+			// The flow-sensitive alias Sema made for an AstVarExpr is the variant
+			if (operand->is_expr<AstVarExpr>()) {
 				auto addr = CgAddr { type->addrof(cg), expr->at(cg, 0).ref() };
-				if (!cg.scopes.last().tests.emplace_back(this, var->name(), move(addr))) {
+				if (!cg.locals.insert(CgNode { this }, move(addr))) {
 					return None{};
 				}
 			}
@@ -1898,7 +2483,7 @@ Maybe<AstConst> AstPropExpr::eval_value(Cg& cg) const noexcept {
 	CgType* type = nullptr;
 	// Convert the AstVarExpr to AstIdentType to allow `prop of T`
 	if (auto expr = m_expr->to_expr<AstVarExpr>()) {
-		type = AstIdentType{expr->name(), *cg.scratch, m_expr->range()}.codegen(cg, None{});
+		type = AstIdentType{expr->name(), {}, m_expr->range()}.codegen(cg, None{});
 	} else {
 		type = m_expr->gen_type(cg, nullptr);
 	}
@@ -1911,21 +2496,21 @@ Maybe<AstConst> AstPropExpr::eval_value(Cg& cg) const noexcept {
 	}
 	auto name = prop->name();
 	auto range = m_prop->range().include(m_expr->range());
-	if (name == "size") {
+	if (name == KnownSymbol::SIZE) {
 		return AstConst { range, Uint64(type->size()) };
-	} else if (name == "align") {
+	} else if (name == KnownSymbol::ALIGN) {
 		return AstConst { range, Uint64(type->align()) };
-	} else if (name == "count") {
+	} else if (name == KnownSymbol::COUNT) {
 		return AstConst { range, Uint64(type->extent()) };
 	}
-	return cg.error(m_prop->range(), "Unknown property '%S'", name);
+	return cg.error(m_prop->range(), "Unknown property '%S'", name.string());
 }
 
 CgType* AstPropExpr::gen_type(Cg& cg, CgType* want) const noexcept {
 	// The OF operator always returns some integer constant expression except
 	// for "type of"
 	if (auto prop = m_prop->to_expr<const AstVarExpr>()) {
-		if (prop->name() == "type") {
+		if (prop->name() == KnownSymbol::TYPE) {
 			return m_expr->gen_type(cg, want);
 		} else {
 			// size  of => u64
@@ -12,7 +12,7 @@ namespace Biron {
 
 Bool AstBlockStmt::codegen(Cg& cg) const noexcept {
 	// We generate a scope for each new block we add
-	if (!cg.scopes.emplace_back(cg.allocator)) {
+	if (!cg.enter_scope()) {
 		return false;
 	}
 	for (auto stmt : m_stmts) {
@@ -26,16 +26,13 @@ Bool AstBlockStmt::codegen(Cg& cg) const noexcept {
 		return false;
 	}
 
-	return cg.scopes.pop_back();
+	return cg.leave_scope();
 }
 
 Bool AstReturnStmt::codegen(Cg& cg) const noexcept {
 	CgType* return_type = nullptr;
-	for (auto fn : cg.fns) {
-		if (fn.node() == cg.fn) {
-			return_type = fn.addr().type()->deref()->at(3);
-			break;
-		}
+	if (auto addr = cg.fn_addrs.find(cg.fn)) {
+		return_type = addr->type()->deref()->at(3);
 	}
 
 	if (!return_type) {
@@ -125,7 +122,7 @@ Bool AstIfStmt::codegen(Cg& cg) const noexcept {
 		// }
 		// on_exit();
 
-		if (!cg.scopes.emplace_back(cg.allocator)) {
+		if (!cg.enter_scope()) {
 			return false;
 		}
 
@@ -164,9 +161,6 @@ Bool AstIfStmt::codegen(Cg& cg) const noexcept {
 		cg.llvm.BuildBr(cg.builder, join_bb);
 	}
 
-	// We clear the current scope tests before the 'else'
-	cg.scopes.last().tests.clear();
-
 	if (m_elif) {
 		cg.llvm.AppendExistingBasicBlock(this_fn, else_bb);
 		cg.llvm.PositionBuilderAtEnd(cg.builder, else_bb);
@@ -183,7 +177,7 @@ Bool AstIfStmt::codegen(Cg& cg) const noexcept {
 	cg.llvm.PositionBuilderAtEnd(cg.builder, join_bb);
 
 	if (m_init) {
-		cg.scopes.pop_back();
+		cg.leave_scope();
 	}
 
 	return true;
@@ -232,8 +226,8 @@ L_value:
 		}
 	}
 	for (const auto& attr : m_attrs) {
-		if (attr->name() != "align") {
-			return cg.error(range(), "Unknown attribute '%S' for 'let'", attr->name());
+		if (attr->name() != KnownSymbol::ALIGN) {
+			return cg.error(range(), "Unknown attribute '%S' for 'let'", attr->name().string());
 		}
 		auto eval = attr->eval(cg);
 		if (!eval || !eval->is_integral()) {
@@ -242,7 +236,7 @@ L_value:
 		cg.llvm.SetAlignment(addr->ref(), *eval->to<Uint64>());
 		break;
 	}
-	if (!cg.scopes.last().vars.emplace_back(this, m_name, move(*addr))) {
+	if (!cg.locals.insert(CgNode { this }, move(*addr))) {
 		return false;
 	}
 	return true;
@@ -264,17 +258,29 @@ Bool AstGLetStmt::codegen(Cg& cg) const noexcept {
 		return false;
 	}
 
-	auto dst = cg.llvm.AddGlobal(cg.module, type->ref(), cg.nameof(m_name));
+	auto dst = cg.llvm.AddGlobal(cg.module, type->ref(), cg.nameof(m_name.string()));
 
 	auto addr = CgAddr { src->type()->addrof(cg), dst };
-	if (!cg.globals.emplace_back(CgVar { this, m_name, move(addr) }, move(*eval))) {
+	if (!cg.globals.find(m_name) && !cg.globals.insert(m_name, CgVar { this, m_name, move(addr) }, move(*eval))) {
 		return cg.oom();
 	}
 
-	cg.llvm.SetInitializer(dst, src->ref());
-	cg.llvm.SetLinkage(dst, LLVM::Linkage::Private);
+	// With partitions the first one defines the global and the others declare it.
+	// The optimizer cannot fold loads of a global which is not private, but each
+	// partition cannot have a private copy either since globals in sections like
+	// the limine requests must exist once.
+	if (cg.partition.count == 1) {
+		cg.llvm.SetInitializer(dst, src->ref());
+		cg.llvm.SetLinkage(dst, LLVM::Linkage::Private);
+	} else {
+		if (cg.partition.index == 0) {
+			cg.llvm.SetInitializer(dst, src->ref());
+		}
+		cg.llvm.SetLinkage(dst, LLVM::Linkage::External);
+		cg.llvm.SetVisibility(dst, LLVM::Visibility::Hidden);
+	}
 	for (auto attr : m_attrs) {
-		if (attr->name() == "section") {
+		if (attr->name() == KnownSymbol::SECTION) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_string()) {
 				return cg.error(eval->range(), "Expected string constant expression in attribute");
@@ -287,27 +293,28 @@ Bool AstGLetStmt::codegen(Cg& cg) const noexcept {
 			} else {
 				return cg.oom();
 			}
-		} else if (attr->name() == "align") {
+		} else if (attr->name() == KnownSymbol::ALIGN) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_integral()) {
 				return cg.error(eval->range(), "Expected integer constant expression in attribute");
 			}
 			cg.llvm.SetAlignment(dst, *eval->to<Uint64>());
 			continue;
-		} else if (attr->name() == "used") {
+		} else if (attr->name() == KnownSymbol::USED) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_bool()) {
 				return cg.error(eval->range(), "Expected boolean constant expression in attribute");
 			}
 			// TODO(dweiler): Figure out how to mark 'dst' as used.
 			continue;
-		} else if (attr->name() == "export") {
+		} else if (attr->name() == KnownSymbol::EXPORT) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_bool()) {
 				return cg.error(eval->range(), "Expected boolean constant expression in attribute");
 			}
 			if (eval->as_bool()) {
 				cg.llvm.SetLinkage(dst, LLVM::Linkage::External);
+				cg.llvm.SetVisibility(dst, LLVM::Visibility::Default);
 			}
 			continue;
 		}
@@ -318,23 +325,18 @@ Bool AstGLetStmt::codegen(Cg& cg) const noexcept {
 }
 
 Bool AstUsingStmt::codegen(Cg& cg) const noexcept {
-	CgType* type = nullptr;
-	for (const auto& effect : cg.effects) {
-		if (effect.name() == m_name) {
-			type = effect.type();
-			break;
-		}
-	}
-	if (!type) {
-		return cg.error(range(), "Undeclared effect '%S'", m_name);
+	auto effect = cg.effects.find(m_name);
+	if (!effect) {
+		return cg.error(range(), "Undeclared effect '%S'", m_name.string());
 	}
 
+	auto type = *effect;
 	auto addr = cg.emit_alloca(type);
 	auto value = m_init->gen_value(cg, type);
 	if (!addr.store(cg, *value)) {
 		return false;
 	}
-	if (!cg.scopes.last().usings.emplace_back(this, m_name, move(addr))) {
+	if (!cg.locals.insert(CgNode { this }, move(addr))) {
 		return false;
 	}
 	return true;
@@ -353,6 +355,42 @@ Bool AstExprStmt::codegen(Cg& cg) const noexcept {
 	return false;
 }
 
+// The store to an atomic is atomic and '+=' and '-=' are a single atomic
+// read-modify-write. There are none for '*=' and '/='.
+Bool AstAssignStmt::assign_atomic(Cg& cg, const CgAddr& dst, const CgValue& src) const noexcept {
+	auto dst_type = dst.type()->deref();
+	auto base = dst_type->deref();
+	if (*src.type() != *base && *src.type() != *dst_type) {
+		auto dst_type_string = dst_type->to_string(*cg.scratch);
+		auto src_type_string = src.type()->to_string(*cg.scratch);
+		return cg.error(range(),
+		                "Cannot assign an lvalue of type '%S' to an rvalue of type '%S'",
+		                src_type_string,
+		                dst_type_string);
+	}
+	LLVM::AtomicRMWBinOp op;
+	switch (m_op) {
+	case StoreOp::WR:
+		return dst.store(cg, src);
+	case StoreOp::ADD:
+		op = LLVM::AtomicRMWBinOp::Add;
+		break;
+	case StoreOp::SUB:
+		op = LLVM::AtomicRMWBinOp::Sub;
+		break;
+	default:
+		return cg.error(range(), "Cannot multiply or divide an atomic in place");
+	}
+	if (!base->is_integer()) {
+		auto type_string = dst_type->to_string(*cg.scratch);
+		return cg.error(range(), "Cannot add to or subtract from '%S'", type_string);
+	}
+	cg.emit_ordered(nullptr, [&](LLVM::AtomicOrdering order) {
+		return cg.llvm.BuildAtomicRMW(cg.builder, op, dst.ref(), src.ref(), order, false);
+	});
+	return true;
+}
+
 Bool AstAssignStmt::codegen(Cg& cg) const noexcept {
 	auto dst = m_dst->gen_addr(cg, nullptr);
 	if (!dst) {
@@ -361,14 +399,15 @@ Bool AstAssignStmt::codegen(Cg& cg) const noexcept {
 
 	auto dst_type = dst->type()->deref();
 
-	auto src = m_src->gen_value(cg, dst_type);
+	// An atomic is assigned a value of its base type.
+	auto src = m_src->gen_value(cg, dst_type->is_atomic() ? dst_type->deref() : dst_type);
 	if (!src) {
 		return false;
 	}
 
 	auto src_type = src->type();
 	if (dst_type->is_atomic()) {
-		return cg.error(range(), "Cannot assign to atomic type");
+		return assign_atomic(cg, *dst, *src);
 	}
 
 	// When the destination is a union type look for a compatible inner type.
@@ -417,7 +456,7 @@ Bool AstAssignStmt::codegen(Cg& cg) const noexcept {
 Bool AstForStmt::codegen(Cg& cg) const noexcept {
 	// We always generate a scope outside for this statement since it may have an
 	// optional init-stmt which should be scoped to the for block only
-	if (!cg.scopes.emplace_back(cg.allocator)) {
+	if (!cg.enter_scope()) {
 		return false;
 	}
 	// <init-stmt>?
@@ -491,7 +530,7 @@ Bool AstForStmt::codegen(Cg& cg) const noexcept {
 	cg.llvm.PositionBuilderAtEnd(cg.builder, exit_bb);
 	cg.llvm.AppendExistingBasicBlock(this_fn, exit_bb);
 
-	cg.scopes.pop_back();
+	cg.leave_scope();
 
 	return true;
 }
@@ -127,6 +127,12 @@ void CgType::dump(StringBuilder& builder) const noexcept {
 		builder.append(']');
 		at(0)->dump(builder);
 		break;
+	case Kind::VECTOR:
+		builder.append("#[");
+		builder.append(Uint64(m_extent));
+		builder.append(']');
+		at(0)->dump(builder);
+		break;
 	case Kind::PADDING:
 		builder.append(".Pad");
 		builder.append(Uint64(m_layout.size));
@@ -232,36 +238,133 @@ CgType* CgType::addrof(Cg& cg) noexcept {
 	return cg.types.make(CgType::PtrInfo { { 8, 8 }, this, None{} });
 }
 
-Bool CgType::operator!=(const CgType& other) const noexcept {
-	if (other.m_kind != m_kind) {
-		return true;
+CgTypeCache::Exact CgTypeCache::Exact::of(const CgType* type) noexcept {
+	return {
+		type->m_kind,
+		type->m_layout,
+		type->m_extent,
+		type->m_types ? &*type->m_types : nullptr,
+		type->m_fields ? &*type->m_fields : nullptr,
+		type->m_name,
+	};
+}
+
+Bool CgTypeCache::Exact::internable() const noexcept {
+	if (fields) for (const auto& field : *fields) {
+		if (field.init) {
+			return false;
+		}
 	}
-	if (other.m_layout != m_layout) {
-		return true;
+	return true;
+}
+
+Uint64 CgTypeCache::Exact::hash() const noexcept {
+	Hash hash;
+	hash.value(kind).value(layout.size).value(layout.align).value(extent);
+	if (types) {
+		hash.value(types->length());
+		for (auto type : *types) {
+			hash.value(type);
+		}
+	}
+	if (fields) {
+		hash.value(fields->length());
+		for (const auto& field : *fields) {
+			hash.string(field.name ? *field.name : StringView{});
+		}
 	}
-	if (other.m_extent != m_extent) {
-		return true;
+	if (name) {
+		hash.string(*name);
+	}
+	return hash.result();
+}
+
+Bool CgTypeCache::Exact::operator==(const Exact& other) const noexcept {
+	if (kind != other.kind || layout != other.layout || extent != other.extent) {
+		return false;
 	}
-	if (other.m_types) { 
-		if (!m_types) {
-			// Other has types but we do not.
-			return true;
+	if (!types != !other.types || !fields != !other.fields || !name != !other.name) {
+		return false;
+	}
+	if (name && *name != *other.name) {
+		return false;
+	}
+	if (types) {
+		if (types->length() != other.types->length()) {
+			return false;
 		}
-		const auto& lhs = *other.m_types;
-		const auto& rhs = *m_types;
-		if (lhs.length() != rhs.length()) {
-			// The type lists are not the same length.
-			return true;
+		for (Ulen l = types->length(), i = 0; i < l; i++) {
+			if ((*types)[i] != (*other.types)[i]) {
+				return false;
+			}
 		}
-		for (Ulen l = lhs.length(), i = 0; i < l; i++) {
-			if (*lhs[i] != *rhs[i]) {
-				// The types are not the same.
-				return true;
+	}
+	if (fields) {
+		if (fields->length() != other.fields->length()) {
+			return false;
+		}
+		for (Ulen l = fields->length(), i = 0; i < l; i++) {
+			const auto& lhs = (*fields)[i].name;
+			const auto& rhs = (*other.fields)[i].name;
+			if (!lhs != !rhs || (lhs && *lhs != *rhs)) {
+				return false;
 			}
 		}
 	}
-	// We do not compare m_ref
-	return false;
+	return true;
+}
+
+Uint64 CgTypeCache::Shape::hash() const noexcept {
+	Hash hash;
+	hash.value(type->m_kind).value(type->m_layout.size).value(type->m_layout.align);
+	hash.value(type->m_extent).value(type->length());
+	for (Ulen l = type->length(), i = 0; i < l; i++) {
+		hash.value(type->at(i)->m_canonical);
+	}
+	return hash.result();
+}
+
+Bool CgTypeCache::Shape::operator==(const Shape& other) const noexcept {
+	const auto lhs = type;
+	const auto rhs = other.type;
+	if (lhs->m_kind != rhs->m_kind || lhs->m_layout != rhs->m_layout || lhs->m_extent != rhs->m_extent) {
+		return false;
+	}
+	if (!lhs->m_types != !rhs->m_types || lhs->length() != rhs->length()) {
+		return false;
+	}
+	for (Ulen l = lhs->length(), i = 0; i < l; i++) {
+		if (lhs->at(i)->m_canonical != rhs->at(i)->m_canonical) {
+			return false;
+		}
+	}
+	return true;
+}
+
+CgType* CgTypeCache::find(const Exact& exact) noexcept {
+	if (auto type = m_exact.find(exact)) {
+		return *type;
+	}
+	return nullptr;
+}
+
+CgType* CgTypeCache::intern(CgType* type) noexcept {
+	if (!type) {
+		return nullptr;
+	}
+	if (auto exact = Exact::of(type); exact.internable() && !m_exact.insert(exact, type)) {
+		return nullptr;
+	}
+	if (auto canonical = m_shapes.find(Shape { type })) {
+		type->m_canonical = *canonical;
+	} else if (!m_shapes.insert(Shape { type }, type)) {
+		return nullptr;
+	}
+	return type;
+}
+
+CgType* AstType::codegen(Cg& cg, Maybe<StringView> name) const noexcept {
+	return visit([&](auto type) { return type->codegen(cg, name); });
 }
 
 CgType* AstTupleType::codegen(Cg& cg, Maybe<StringView> name) const noexcept {
@@ -342,60 +445,51 @@ CgType* AstUnionType::codegen(Cg& cg, Maybe<StringView> name) const noexcept {
 }
 
 CgType* AstIdentType::codegen(Cg& cg, Maybe<StringView> name) const noexcept {
-	/**/ if (m_ident == "Uint8")   return cg.types.u8();
-	else if (m_ident == "Uint16")  return cg.types.u16();
-	else if (m_ident == "Uint32")  return cg.types.u32();
-	else if (m_ident == "Uint64")  return cg.types.u64();
-	else if (m_ident == "Sint8")   return cg.types.s8();
-	else if (m_ident == "Sint16")  return cg.types.s16();
-	else if (m_ident == "Sint32")  return cg.types.s32();
-	else if (m_ident == "Sint64")  return cg.types.s64();
-	else if (m_ident == "Bool8")   return cg.types.b8();
-	else if (m_ident == "Bool16")  return cg.types.b16();
-	else if (m_ident == "Bool32")  return cg.types.b32();
-	else if (m_ident == "Bool64")  return cg.types.b64();
-	else if (m_ident == "Real32")  return cg.types.f32();
-	else if (m_ident == "Real64")  return cg.types.f64();
-	else if (m_ident == "String")  return cg.types.str();
-	else if (m_ident == "Address") return cg.types.ptr();
-	else if (m_ident == "Length")  return cg.types.u64();
-	for (auto type : cg.typedefs) {
-		if (type.name() == m_ident) {
-			return type.type();
-		}
-	}
-
-	for (auto effect : cg.effects) {
-		if (effect.name() == m_ident) {
-			return effect.type();
-		}
-	}
-
-	// Check the unit for non-generated types and generate them here. This will
-	// basically perform an implicit dependency sort of the types for us for free.
-	if (const auto typedefs = cg.ast->cache<AstTypedef>()) {
-		for (auto opaque : *typedefs) {
-			const auto type = static_cast<const AstTypedef*>(opaque);
-			if (type->name() == m_ident) {
-				if (type->codegen(cg)) {
-					return codegen(cg, name);
-				}
-			}
+	/**/ if (m_ident == KnownSymbol::UINT8)   return cg.types.u8();
+	else if (m_ident == KnownSymbol::UINT16)  return cg.types.u16();
+	else if (m_ident == KnownSymbol::UINT32)  return cg.types.u32();
+	else if (m_ident == KnownSymbol::UINT64)  return cg.types.u64();
+	else if (m_ident == KnownSymbol::SINT8)   return cg.types.s8();
+	else if (m_ident == KnownSymbol::SINT16)  return cg.types.s16();
+	else if (m_ident == KnownSymbol::SINT32)  return cg.types.s32();
+	else if (m_ident == KnownSymbol::SINT64)  return cg.types.s64();
+	else if (m_ident == KnownSymbol::BOOL8)   return cg.types.b8();
+	else if (m_ident == KnownSymbol::BOOL16)  return cg.types.b16();
+	else if (m_ident == KnownSymbol::BOOL32)  return cg.types.b32();
+	else if (m_ident == KnownSymbol::BOOL64)  return cg.types.b64();
+	else if (m_ident == KnownSymbol::REAL32)  return cg.types.f32();
+	else if (m_ident == KnownSymbol::REAL64)  return cg.types.f64();
+	else if (m_ident == KnownSymbol::STRING)  return cg.types.str();
+	else if (m_ident == KnownSymbol::ADDRESS) return cg.types.ptr();
+	else if (m_ident == KnownSymbol::LENGTH)  return cg.types.u64();
+	if (auto type = cg.typedefs.find(m_ident)) {
+		return *type;
+	}
+
+	if (auto effect = cg.effects.find(m_ident)) {
+		return *effect;
+	}
+
+	// Check for non-generated types and generate them here. This will basically
+	// perform an implicit dependency sort of the types for us for free. The type
+	// may be in another unit so it is generated against that.
+	if (auto decl = cg.typedef_decls.find(m_ident)) {
+		auto type = static_cast<const AstTypedef*>(decl->node);
+		if (!cg.generate(*decl, [&]{ return type->codegen(cg); })) {
+			return nullptr;
 		}
+		return codegen(cg, name);
 	}
 
-	if (const auto effects = cg.ast->cache<AstEffect>()) {
-		for (auto opaque : *effects) {
-			const auto effect = static_cast<const AstEffect*>(opaque);
-			if (effect->name() == m_ident) {
-				if (effect->codegen(cg)) {
-					return codegen(cg, name);
-				}
-			}
+	if (auto decl = cg.effect_decls.find(m_ident)) {
+		auto effect = static_cast<const AstEffect*>(decl->node);
+		if (!cg.generate(*decl, [&]{ return effect->codegen(cg); })) {
+			return nullptr;
 		}
+		return codegen(cg, name);
 	}
 
-	return cg.error(range(), "Undeclared entity '%S'", m_ident, range().length);
+	return cg.error(range(), "Undeclared entity '%S'", m_ident.string(), range().length);
 }
 
 CgType* AstVarArgsType::codegen(Cg&, Maybe<StringView>) const noexcept {
@@ -428,6 +522,29 @@ CgType* AstArrayType::codegen(Cg& cg, Maybe<StringView> name) const noexcept {
 	return cg.types.make(CgType::ArrayInfo { base, *extent, name });
 }
 
+CgType* AstVectorType::codegen(Cg& cg, Maybe<StringView> name) const noexcept {
+	auto base = m_base->codegen(cg, None{});
+	if (!base) {
+		return nullptr;
+	}
+	if (!base->is_integer() && !base->is_real() && !base->is_bool()) {
+		auto type_string = base->to_string(*cg.scratch);
+		return cg.error(m_base->range(), "Cannot have a vector of type '%S'", type_string);
+	}
+	auto value = m_extent->eval_value(cg);
+	if (!value || !value->is_integral()) {
+		return cg.error(m_extent->range(), "Expected integer constant expression for vector extent");
+	}
+	auto extent = value->to<Uint64>();
+	if (!extent) {
+		return nullptr;
+	}
+	if (*extent == 0) {
+		return cg.error(m_extent->range(), "Cannot have a vector with no elements");
+	}
+	return cg.types.make(CgType::VectorInfo { base, *extent, name });
+}
+
 CgType* AstSliceType::codegen(Cg& cg, Maybe<StringView>) const noexcept {
 	auto base = m_type->codegen(cg, None{});
 	if (!base) {
@@ -457,7 +574,7 @@ CgType* AstFnType::codegen(Cg& cg, Maybe<StringView>) const noexcept {
 		if (!info.types.push_back(type)) {
 			return nullptr;
 		}
-		if (!info.fields->emplace_back(effect->name(), None{})) {
+		if (!info.fields->emplace_back(effect->name().string(), None{})) {
 			return nullptr;
 		}
 	}
@@ -551,7 +668,10 @@ CgType* CgTypeCache::make(CgType::IntInfo info) noexcept {
 	default:
 		return nullptr;
 	}
-	return m_cache.make<CgType>(
+	if (auto type = find({ kind, info, 0_ulen, nullptr, nullptr, info.named })) {
+		return type;
+	}
+	return intern(m_cache.make<CgType>(
 		kind,
 		info,
 		0_ulen,
@@ -559,7 +679,7 @@ CgType* CgTypeCache::make(CgType::IntInfo info) noexcept {
 		None{},
 		info.named,
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::RealInfo info) noexcept {
@@ -577,7 +697,10 @@ CgType* CgTypeCache::make(CgType::RealInfo info) noexcept {
 	default:
 		return nullptr;
 	}
-	return m_cache.make<CgType>(
+	if (auto type = find({ kind, info, 0_ulen, nullptr, nullptr, info.named })) {
+		return type;
+	}
+	return intern(m_cache.make<CgType>(
 		kind,
 		info,
 		0_ulen,
@@ -585,7 +708,7 @@ CgType* CgTypeCache::make(CgType::RealInfo info) noexcept {
 		None{},
 		info.named,
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::PtrInfo info) noexcept {
@@ -593,16 +716,20 @@ CgType* CgTypeCache::make(CgType::PtrInfo info) noexcept {
 	if (info.base && !types.emplace(m_cache.allocator()).push_back(info.base)) {
 		return nullptr;
 	}
+	const auto kind = CgType::Kind::POINTER;
+	if (auto type = find({ kind, info, 0_ulen, types ? &*types : nullptr, nullptr, info.named })) {
+		return type;
+	}
 	auto ref = m_llvm.PointerTypeInContext(m_context, 0);
-	return m_cache.make<CgType>(
-		CgType::Kind::POINTER,
+	return intern(m_cache.make<CgType>(
+		kind,
 		info,
 		0_ulen,
 		move(types),
 		None{},
 		info.named,
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::BoolInfo info) noexcept {
@@ -624,7 +751,10 @@ CgType* CgTypeCache::make(CgType::BoolInfo info) noexcept {
 	default:
 		return nullptr;
 	}
-	return m_cache.make<CgType>(
+	if (auto type = find({ kind, info, 0_ulen, nullptr, nullptr, info.named })) {
+		return type;
+	}
+	return intern(m_cache.make<CgType>(
 		kind,
 		info,
 		0_ulen,
@@ -632,7 +762,7 @@ CgType* CgTypeCache::make(CgType::BoolInfo info) noexcept {
 		None{},
 		info.named,
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::StringInfo) noexcept {
@@ -655,7 +785,7 @@ CgType* CgTypeCache::make(CgType::StringInfo) noexcept {
 	}
 	types[0] = make(CgType::PtrInfo { { 8, 8 }, u8(), None{} });
 	types[1] = u64();
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::STRING,
 		CgType::Layout {
 			sum(ptr()->size(), u64()->size()),
@@ -666,7 +796,7 @@ CgType* CgTypeCache::make(CgType::StringInfo) noexcept {
 		None{},
 		None{},
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::TupleInfo info) noexcept {
@@ -720,6 +850,10 @@ CgType* CgTypeCache::make(CgType::TupleInfo info) noexcept {
 		}
 		offset = aligned_offset;
 	}
+	const auto layout = CgType::Layout { offset, alignment };
+	if (auto type = find({ CgType::Kind::TUPLE, layout, 0_ulen, &padded, &fields, info.named })) {
+		return type;
+	}
 	LLVM::TypeRef ref = nullptr;
 	Maybe<StringView> name = info.named;
 	if (padded.empty()) {
@@ -746,15 +880,15 @@ CgType* CgTypeCache::make(CgType::TupleInfo info) noexcept {
 			ref = m_llvm.StructTypeInContext(m_context, types.data(), types.length(), true);
 		}
 	}
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::TUPLE,
-		CgType::Layout { offset, alignment },
+		layout,
 		0_ulen,
 		move(padded),
 		move(fields),
 		move(name),
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::UnionInfo info) noexcept {
@@ -765,6 +899,11 @@ CgType* CgTypeCache::make(CgType::UnionInfo info) noexcept {
 		align = max(size, type->align());
 	}
 
+	const auto layout = CgType::Layout { size + 1, align };
+	if (auto type = find({ CgType::Kind::UNION, layout, 0_ulen, &info.types, nullptr, info.named })) {
+		return type;
+	}
+
 	auto array = make(CgType::ArrayInfo { u8(), size, None{} });
 	if (!array) {
 		return nullptr;
@@ -782,7 +921,7 @@ CgType* CgTypeCache::make(CgType::UnionInfo info) noexcept {
 	// We always use a u8 type tag but we still need to work out how many bytes
 	// of padding we need to add after the tag so that an array of the union type
 	// will be correctly aligned.
-	Ulen offset = size + 1;
+	const auto offset = layout.size;
 	const auto align_mask = align - 1;
 	const auto aligned_offset = (offset + align_mask) & ~align_mask;
 	if (auto padding = aligned_offset - offset) {
@@ -816,15 +955,15 @@ CgType* CgTypeCache::make(CgType::UnionInfo info) noexcept {
 		return nullptr;
 	}
 
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::UNION,
-		CgType::Layout { offset, align },
+		layout,
 		0_ulen,
 		move(copy),
 		None{},
 		info.named,
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::ArrayInfo info) noexcept {
@@ -832,22 +971,66 @@ CgType* CgTypeCache::make(CgType::ArrayInfo info) noexcept {
 	if (!types.push_back(info.base)) {
 		return nullptr;
 	}
+	const auto layout = CgType::Layout {
+		info.base->size() * info.extent,
+		info.base->align()
+	};
+	if (auto type = find({ CgType::Kind::ARRAY, layout, info.extent, &types, nullptr, info.named })) {
+		return type;
+	}
 	auto ref = m_llvm.ArrayType2(info.base->ref(), info.extent);
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::ARRAY,
-		CgType::Layout {
-			info.base->size() * info.extent,
-			info.base->align()
-		},
+		layout,
 		info.extent,
 		move(types),
 		None{},
 		info.named,
 		ref
-	);
+	));
+}
+
+CgType* CgTypeCache::make(CgType::VectorInfo info) noexcept {
+	Array<CgType*> types{m_cache.allocator()};
+	if (!types.push_back(info.base)) {
+		return nullptr;
+	}
+	// Vectors are padded to a power of two and aligned to their size, which is
+	// how LLVM lays them out and what the vector loads and stores expect.
+	Ulen size = 1;
+	while (size < info.base->size() * info.extent) {
+		size *= 2;
+	}
+	const auto layout = CgType::Layout { size, size };
+	if (auto type = find({ CgType::Kind::VECTOR, layout, info.extent, &types, nullptr, info.named })) {
+		return type;
+	}
+	auto ref = m_llvm.VectorType(info.base->ref(), info.extent);
+	return intern(m_cache.make<CgType>(
+		CgType::Kind::VECTOR,
+		layout,
+		info.extent,
+		move(types),
+		None{},
+		info.named,
+		ref
+	));
 }
 
 CgType* CgTypeCache::make(CgType::SliceInfo info) noexcept {
+	Array<CgType*> types{m_cache.allocator()};
+	if (!types.resize(2)) {
+		return nullptr;
+	}
+	types[0] = info.base;
+	types[1] = u64();
+	const auto layout = CgType::Layout {
+		sum(ptr()->size(), u64()->size()),
+		max(ptr()->align(), u64()->align())
+	};
+	if (auto type = find({ CgType::Kind::SLICE, layout, 0_ulen, &types, nullptr, None{} })) {
+		return type;
+	}
 	LLVM::TypeRef ref = nullptr;
 	if (auto find = m_llvm.GetTypeByName2(m_context, ".Slice")) {
 		ref = find;
@@ -861,24 +1044,15 @@ CgType* CgTypeCache::make(CgType::SliceInfo info) noexcept {
 	} else {
 		return nullptr;
 	}
-	Array<CgType*> types{m_cache.allocator()};
-	if (!types.resize(2)) {
-		return nullptr;
-	}
-	types[0] = info.base;
-	types[1] = u64();
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::SLICE,
-		CgType::Layout {
-			sum(ptr()->size(), u64()->size()),
-			max(ptr()->align(), u64()->align())
-		},
+		layout,
 		0_ulen,
 		move(types),
 		None{},
 		None{},
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::PaddingInfo info) noexcept {
@@ -889,7 +1063,7 @@ CgType* CgTypeCache::make(CgType::PaddingInfo info) noexcept {
 	if (!name.valid()) {
 		return nullptr;
 	}
-	auto array = make(CgType::ArrayInfo { u8(), info.padding, name.view() });
+	auto array = make(CgType::ArrayInfo { u8(), info.padding, None{} });
 	if (!array) {
 		return nullptr;
 	}
@@ -908,7 +1082,7 @@ CgType* CgTypeCache::make(CgType::PaddingInfo info) noexcept {
 	if (!types.push_back(array)) {
 		return nullptr;
 	}
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::PADDING,
 		CgType::Layout { info.padding, 1_ulen },
 		0_ulen,
@@ -916,7 +1090,7 @@ CgType* CgTypeCache::make(CgType::PaddingInfo info) noexcept {
 		None{},
 		None{},
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::FnInfo info) noexcept {
@@ -929,6 +1103,11 @@ CgType* CgTypeCache::make(CgType::FnInfo info) noexcept {
 	types[2] = info.effects;
 	types[3] = info.ret;
 
+	const auto layout = CgType::Layout { 8_ulen, 8_ulen };
+	if (auto type = find({ CgType::Kind::FN, layout, 0_ulen, &types, nullptr, None{} })) {
+		return type;
+	}
+
 	ScratchAllocator scratch{m_cache.allocator()};
 	Array<LLVM::TypeRef> args{scratch};
 	Bool has_va = false;
@@ -981,19 +1160,19 @@ CgType* CgTypeCache::make(CgType::FnInfo info) noexcept {
 	                               args.length(),
 	                               has_va);
 
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::FN,
-		CgType::Layout { 8_ulen, 8_ulen },
+		layout,
 		0_ulen,
 		move(types),
 		None{},
 		None{},
 		ref
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::VaInfo) noexcept {
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::VA,
 		CgType::Layout { 0_ulen, 0_ulen },
 		0_ulen,
@@ -1001,7 +1180,7 @@ CgType* CgTypeCache::make(CgType::VaInfo) noexcept {
 		None{},
 		None{},
 		nullptr
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::AtomicInfo info) noexcept {
@@ -1009,7 +1188,10 @@ CgType* CgTypeCache::make(CgType::AtomicInfo info) noexcept {
 	if (!types.push_back(info.base)) {
 		return nullptr;
 	}
-	return m_cache.make<CgType>(
+	if (auto type = find({ CgType::Kind::ATOMIC, info.base->layout(), 0_ulen, &types, nullptr, info.named })) {
+		return type;
+	}
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::ATOMIC,
 		info.base->layout(),
 		0_ulen,
@@ -1017,7 +1199,7 @@ CgType* CgTypeCache::make(CgType::AtomicInfo info) noexcept {
 		None{},
 		info.named,
 		info.base->ref()
-	);
+	));
 }
 
 CgType* CgTypeCache::make(CgType::EnumInfo info) noexcept {
@@ -1033,7 +1215,7 @@ CgType* CgTypeCache::make(CgType::EnumInfo info) noexcept {
 			return nullptr;
 		}
 	}
-	return m_cache.make<CgType>(
+	return intern(m_cache.make<CgType>(
 		CgType::Kind::ENUM,
 		info.base->layout(),
 		0_ulen,
@@ -1041,7 +1223,7 @@ CgType* CgTypeCache::make(CgType::EnumInfo info) noexcept {
 		move(fields),
 		info.named,
 		info.base->ref()
-	);
+	));
 }
 
 CgType* CgTypeCache::ensure_padding(Ulen padding) noexcept {
@@ -3,6 +3,7 @@
 #include <biron/llvm.h>
 
 #include <biron/util/pool.h>
+#include <biron/util/map.inl>
 #include <biron/util/string.h>
 
 #include <biron/ast_const.h>
@@ -25,6 +26,7 @@ struct CgType {
 		ATOMIC,            // @T
 		SLICE,             // []T
 		ARRAY,             // [N]T
+		VECTOR,            // #[N]T
 		PADDING,           // [N]u8 // Special meta-type for tuple padding
 		TUPLE,             // {T1, ..., Tn}
 		UNION,             // T1 | ... | Tn
@@ -117,6 +119,7 @@ struct CgType {
 	[[nodiscard]] constexpr Bool is_string() const noexcept { return m_kind == Kind::STRING; }
 	[[nodiscard]] constexpr Bool is_slice() const noexcept { return m_kind == Kind::SLICE; }
 	[[nodiscard]] constexpr Bool is_array() const noexcept { return m_kind == Kind::ARRAY; }
+	[[nodiscard]] constexpr Bool is_vector() const noexcept { return m_kind == Kind::VECTOR; }
 	[[nodiscard]] constexpr Bool is_padding() const noexcept { return m_kind == Kind::PADDING; }
 	[[nodiscard]] constexpr Bool is_tuple() const noexcept { return m_kind == Kind::TUPLE; }
 	[[nodiscard]] constexpr Bool is_union() const noexcept { return m_kind == Kind::UNION; }
@@ -129,9 +132,14 @@ struct CgType {
 
 	constexpr const Maybe<StringView>& name() const noexcept { return m_name; }
 
-	[[nodiscard]] Bool operator!=(const CgType& other) const noexcept;
+	// Types are equal when they have the same shape, which ignores names and
+	// fields. The type cache gives every shape one canonical type so comparing
+	// types is comparing those.
 	[[nodiscard]] Bool operator==(const CgType& other) const noexcept {
-		return !operator!=(other);
+		return m_canonical == other.m_canonical;
+	}
+	[[nodiscard]] Bool operator!=(const CgType& other) const noexcept {
+		return !operator==(other);
 	}
 
 	struct IntInfo : Layout {
@@ -173,6 +181,12 @@ struct CgType {
 		Maybe<StringView> named;
 	};
 
+	struct VectorInfo {
+		CgType*           base;
+		Ulen              extent;
+		Maybe<StringView> named;
+	};
+
 	struct SliceInfo {
 		CgType* base;
 	};
@@ -219,6 +233,7 @@ private:
 		, m_fields{move(fields)}
 		, m_name{move(name)}
 		, m_ref{ref}
+		, m_canonical{this}
 	{
 	}
 
@@ -229,6 +244,7 @@ private:
 	Maybe<Array<ConstField>> m_fields;
 	Maybe<StringView> m_name;
 	LLVM::TypeRef m_ref;
+	CgType* m_canonical;
 };
 
 struct CgTypeCache {
@@ -266,6 +282,7 @@ struct CgTypeCache {
 	CgType* make(CgType::TupleInfo info) noexcept;
 	CgType* make(CgType::UnionInfo info) noexcept;
 	CgType* make(CgType::ArrayInfo info) noexcept;
+	CgType* make(CgType::VectorInfo info) noexcept;
 	CgType* make(CgType::SliceInfo info) noexcept;
 	CgType* make(CgType::PaddingInfo info) noexcept;
 	CgType* make(CgType::FnInfo info) noexcept;
@@ -280,11 +297,41 @@ struct CgTypeCache {
 private:
 	CgType* ensure_padding(Ulen padding) noexcept;
 
+	// Everything a CgType is made from. Making a type with the same description
+	// as one already made gives back that type and its LLVM type. Types with
+	// initialized fields (enums) are not interned since AstConst values cannot
+	// be compared cheaply.
+	struct Exact {
+		static Exact of(const CgType* type) noexcept;
+		[[nodiscard]] Bool internable() const noexcept;
+		[[nodiscard]] Uint64 hash() const noexcept;
+		[[nodiscard]] Bool operator==(const Exact& other) const noexcept;
+		CgType::Kind             kind;
+		CgType::Layout           layout;
+		Ulen                     extent;
+		const Array<CgType*>*    types;
+		const Array<ConstField>* fields;
+		Maybe<StringView>        name;
+	};
+
+	// The shape of a type: the description without names and fields, and with
+	// nested types replaced by their canonical types.
+	struct Shape {
+		[[nodiscard]] Uint64 hash() const noexcept;
+		[[nodiscard]] Bool operator==(const Shape& other) const noexcept;
+		const CgType* type;
+	};
+
+	CgType* find(const Exact& exact) noexcept;
+	CgType* intern(CgType* type) noexcept;
+
 	constexpr CgTypeCache(Cache&& cache, LLVM& llvm, LLVM::ContextRef context) noexcept
 		: m_cache{move(cache)}
 		, m_llvm{llvm}
 		, m_context{context}
 		, m_padding_cache{m_cache.allocator()}
+		, m_exact{m_cache.allocator()}
+		, m_shapes{m_cache.allocator()}
 	{
 	}
 
@@ -293,6 +340,8 @@ private:
 	LLVM::ContextRef m_context;
 	CgType* m_builtin[18];
 	Array<CgType*> m_padding_cache; // Indexed by padding size
+	HashMap<Exact, CgType*> m_exact;
+	HashMap<Shape, CgType*> m_shapes; // The canonical type of each shape
 };
 
 } // namespace Biron
@@ -6,6 +6,10 @@
 
 #include <biron/cg.h>
 #include <biron/cg_value.h>
+#include <biron/sema.h>
+
+#include <biron/util/trace.h>
+#include <biron/util/unreachable.inl>
 
 namespace Biron {
 
@@ -39,7 +43,7 @@ Bool AstFn::prepass(Cg& cg) const noexcept {
 		if (!info.types.push_back(type)) {
 			return false;
 		}
-		if (!info.fields->emplace_back(effect->name(), None{})) {
+		if (!info.fields->emplace_back(effect->name().string(), None{})) {
 			return false;
 		}
 	}
@@ -65,14 +69,14 @@ Bool AstFn::prepass(Cg& cg) const noexcept {
 	const char* name = nullptr;
 	Bool exported = false;
 	for (auto attr : m_attrs) {
-		if (attr->name() == "export") {
+		if (attr->name() == KnownSymbol::EXPORT) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_bool()) {
 				return cg.error(eval->range(), "Expected boolean constant expression for attribute");
 			}
 			auto value = eval->to<Bool>();
 			if (value) {
-				name = m_name.terminated(*cg.scratch);
+				name = m_name.string().terminated(*cg.scratch);
 				if (!name) {
 					return cg.oom();
 				}
@@ -83,25 +87,36 @@ Bool AstFn::prepass(Cg& cg) const noexcept {
 	}
 	if (!name) {
 		// Use the mangled name
-		name = cg.nameof(m_name);
+		name = cg.nameof(m_name.string());
 	}
 
 	LLVM::ValueRef fn_v = nullptr;
 	StringView builtin = "__biron_runtime_";
-	if (m_name.starts_with(builtin)) {
-		fn_v = cg.intrinsic(m_name.slice(builtin.length()))->ref();
+	if (m_name.string().starts_with(builtin)) {
+		auto intrinsic = cg.symbols.intern(m_name.string().slice(builtin.length()));
+		if (!intrinsic) {
+			return cg.oom();
+		}
+		fn_v = cg.intrinsic(*intrinsic)->ref();
 	} else {
 		fn_v = cg.llvm.AddFunction(cg.module, name, fn_t->ref());
 	}
 
 	if (exported) {
 		cg.llvm.SetLinkage(fn_v, LLVM::Linkage::External);
+	} else if (cg.partition.count > 1) {
+		// The function is defined by one partition and called from the others so
+		// it must be visible to them but not outside of the unit. Unlike private
+		// linkage this keeps the optimizer from dropping the function once every
+		// call is inlined, which is the price of partitioning.
+		cg.llvm.SetLinkage(fn_v, LLVM::Linkage::External);
+		cg.llvm.SetVisibility(fn_v, LLVM::Visibility::Hidden);
 	} else {
 		cg.llvm.SetLinkage(fn_v, LLVM::Linkage::Private);
 	}
 
 	for (auto attr : m_attrs) {
-		if (attr->name() == "redzone") {
+		if (attr->name() == KnownSymbol::REDZONE) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_bool()) {
 				return cg.error(eval->range(), "Expected boolean constant expression for attribute");
@@ -112,7 +127,7 @@ Bool AstFn::prepass(Cg& cg) const noexcept {
 			auto kind = cg.llvm.GetEnumAttributeKindForName(name.data(), name.length());
 			auto data = cg.llvm.CreateEnumAttribute(cg.context, kind, 0);
 			cg.llvm.AddAttributeAtIndex(fn_v, -1, data);
-		} else if (attr->name() == "alignstack") {
+		} else if (attr->name() == KnownSymbol::ALIGNSTACK) {
 			auto eval = attr->eval(cg);
 			if (!eval || !eval->is_integral()) {
 				return cg.error(eval->range(), "Expected integer constant expression for attribute");
@@ -124,7 +139,11 @@ Bool AstFn::prepass(Cg& cg) const noexcept {
 		}
 	}
 
-	if (!cg.fns.emplace_back(this, m_name, CgAddr { fn_t->addrof(cg), fn_v })) {
+	auto addr = CgAddr { fn_t->addrof(cg), fn_v };
+	if (!cg.fn_addrs.insert(this, addr)) {
+		return false;
+	}
+	if (!cg.fns.find(m_name) && !cg.fns.insert(m_name, this, m_name, move(addr))) {
 		return false;
 	}
 
@@ -136,23 +155,17 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 	BIRON_ASSERT(cg.scopes.empty());
 
 	// Search for the function by node
-	Maybe<CgAddr> addr;
-	for (const auto &var : cg.fns) {
-		if (var.node() == this) {
-			addr = var.addr();
-			break;
-		}
-	}
-
+	auto addr = cg.fn_addrs.find(this);
 	if (!addr) {
 		return false;
 	}
 
-	if (!cg.scopes.emplace_back(cg.allocator)) {
+	if (!cg.enter_scope()) {
 		return false;
 	}
 
 	cg.fn = this;
+	cg.locals.reset();
 
 	auto type = addr->type()->deref();
 	auto effects = type->at(2);
@@ -179,8 +192,12 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 	if (effects != cg.types.unit()) {
 		i++;
 	}
+
+	// The locals are numbered like Sema numbers them, see AstFn::analyze.
+	Ulen n = 0;
 	for (const auto& elem : m_objs->elems()) {
-		if (auto name = elem.name()) {
+		const auto local = CgNode { this, n++ };
+		if (elem.name()) {
 			auto type = elem.type()->codegen(cg, None{});
 			if (!type) {
 				return false;
@@ -189,7 +206,7 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 			if (!args.emplace_back(dst, i)) {
 				return false;
 			}
-			if (!cg.scopes.last().vars.emplace_back(this, *name, move(dst))) {
+			if (!cg.locals.insert(local, move(dst))) {
 				return false;
 			}
 		}
@@ -197,7 +214,8 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 	}
 
 	for (const auto& elem : m_args->elems()) {
-		if (auto name = elem.name()) {
+		const auto local = CgNode { this, n++ };
+		if (elem.name()) {
 			auto type = elem.type()->codegen(cg, None{});
 			if (!type) {
 				return false;
@@ -206,7 +224,7 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 			if (!args.emplace_back(dst, i)) {
 				return false;
 			}
-			if (!cg.scopes.last().vars.emplace_back(this, *name, move(dst))) {
+			if (!cg.locals.insert(local, move(dst))) {
 				return false;
 			}
 		}
@@ -225,8 +243,9 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 		// Populate the using for this scope
 		Ulen i = 0;
 		for (const auto& field : effects->fields()) {
+			const auto local = CgNode { this, n++ };
 			auto field_addr = src.at(cg, i);
-			if (field.name && !cg.scopes.last().usings.emplace_back(this, *field.name, move(field_addr))) {
+			if (field.name && !cg.locals.insert(local, move(field_addr))) {
 				return false;
 			}
 			i++;
@@ -289,18 +308,18 @@ Bool AstFn::codegen(Cg& cg) const noexcept {
 		}
 	}
 
-	return cg.scopes.pop_back();
+	return cg.leave_scope();
 }
 
 Bool AstTypedef::codegen(Cg& cg) const noexcept {
 	if (m_generated) {
 		return true;
 	}
-	auto type = m_type->codegen(cg, m_name);
+	auto type = m_type->codegen(cg, m_name.string());
 	if (!type) {
 		return false;
 	}	
-	if (!cg.typedefs.emplace_back(m_name, type)) {
+	if (!cg.typedefs.find(m_name) && !cg.typedefs.insert(m_name, type)) {
 		return false;
 	}
 	m_generated = true;
@@ -315,7 +334,7 @@ Bool AstEffect::codegen(Cg& cg) const noexcept {
 	if (!type) {
 		return false;
 	}
-	if (!cg.effects.emplace_back(m_name, type)) {
+	if (!cg.effects.find(m_name) && !cg.effects.insert(m_name, type)) {
 		return false;
 	}
 	m_generated = true;
@@ -330,31 +349,46 @@ Bool AstModule::codegen(Cg& cg) const noexcept {
 	return true;
 }
 
-Bool Ast::codegen(Cg& cg) const noexcept {
-	// We should have at least one top-level module.
-	const auto modules = cache<AstModule>();
-	if (!modules || modules->empty()) {
-		return cg.error(Range{0, 0}, "Missing 'module'");
-	}
-	if (modules->length() > 1) {
-		return cg.error(Range{0, 0}, "Multiple 'module' definitions in file");
-	}
-	auto module = static_cast<const AstModule*>((*modules)[0]);
-	if (!module->codegen(cg)) {
-		return false;
-	}
+// The functions every unit declares. The LLVM intrinsics are not among them,
+// those are generic and lowered by AstCallExpr, see intrinsic.inl.
+enum class PreludeType : Uint8 { S32, B32, U64, PTR, STRING, VA };
+
+static constexpr const struct Prelude {
+	KnownSymbol name;
+	const char* link;
+	Bool        runtime; // Defined by the runtime and found in Cg::intrinsics
+	PreludeType ret;
+	PreludeType args[3];
+	Ulen        n_args;
+} PRELUDE[] = {
+	{ KnownSymbol::PRINTF,    "printf",                    false, PreludeType::S32, { PreludeType::STRING, PreludeType::VA },                    2 },
+	{ KnownSymbol::MEMORY_EQ, "__biron_runtime_memory_eq", true,  PreludeType::B32, { PreludeType::PTR,    PreludeType::PTR, PreludeType::U64 }, 3 },
+	{ KnownSymbol::MEMORY_NE, "__biron_runtime_memory_ne", true,  PreludeType::B32, { PreludeType::PTR,    PreludeType::PTR, PreludeType::U64 }, 3 },
+};
+
+static CgType* prelude_type(Cg& cg, PreludeType type) noexcept {
+	switch (type) {
+	case PreludeType::S32:    return cg.types.s32();
+	case PreludeType::B32:    return cg.types.b32();
+	case PreludeType::U64:    return cg.types.u64();
+	case PreludeType::PTR:    return cg.types.ptr();
+	case PreludeType::STRING: return cg.types.u8()->addrof(cg);
+	case PreludeType::VA:     return cg.types.va();
+	}
+	BIRON_UNREACHABLE();
+}
 
-	// Somewhat frustrating this is needed until we add a dependency sorter.
-	cg.ast = this;
-	
-	// Register a "printf" function for debugging purposes
-	{
+Bool Ast::prelude(Cg& cg) noexcept {
+	for (const auto& prelude : PRELUDE) {
 		Array<CgType*> args{cg.allocator};
-		if (!args.push_back(cg.types.u8()->addrof(cg)) || !args.push_back(cg.types.va())) {
+		Array<CgType*> rets{cg.allocator};
+		if (!args.reserve(prelude.n_args)) {
 			return false;
 		}
-		Array<CgType*> rets{cg.allocator};
-		if (!rets.push_back(cg.types.s32())) {
+		for (Ulen i = 0; i < prelude.n_args; i++) {
+			(void)args.push_back(prelude_type(cg, prelude.args[i]));
+		}
+		if (!rets.push_back(prelude_type(cg, prelude.ret))) {
 			return false;
 		}
 		auto args_t = cg.types.make(CgType::TupleInfo { move(args), None{}, None{} });
@@ -362,128 +396,173 @@ Bool Ast::codegen(Cg& cg) const noexcept {
 		if (!args_t || !rets_t) {
 			return false;
 		}
-
 		auto fn_t = cg.types.make(CgType::FnInfo { cg.types.unit(), args_t, cg.types.unit(), rets_t });
 		if (!fn_t) {
 			return false;
 		}
-		auto fn_v = cg.llvm.AddFunction(cg.module, "printf", fn_t->ref());
-		if (!cg.fns.emplace_back(nullptr, "printf", CgAddr { fn_t->addrof(cg), fn_v })) {
+		auto fn_v = cg.llvm.AddFunction(cg.module, prelude.link, fn_t->ref());
+		auto name = cg.symbols[prelude.name];
+		auto addr = CgAddr { fn_t->addrof(cg), fn_v };
+		if (prelude.runtime ? !cg.intrinsics.insert(name, move(addr))
+		                    : !cg.fns.insert(name, nullptr, name, move(addr)))
+		{
 			return false;
 		}
 	}
 
-	// sqrt
-	{
-		Array<CgType*> args{cg.allocator};
-		Array<CgType*> rets{cg.allocator};
-		if (!args.push_back(cg.types.f32())) {
-			return false;
-		}
-		if (!rets.push_back(cg.types.f32())) {
-			return false;
-		}
-		auto args_t = cg.types.make(CgType::TupleInfo { move(args), None{}, None{} });
-		auto ret_t = cg.types.f32();
-		if (!args_t || !ret_t) {
-			return false;
-		}
-		auto fn_t = cg.types.make(CgType::FnInfo { cg.types.unit(), args_t, cg.types.unit(), ret_t });
-		if (!fn_t) {
-			return false;
-		}
-		auto fn_v = cg.llvm.AddFunction(cg.module, "llvm.sqrt.f32", fn_t->ref());
-		if (!cg.fns.emplace_back(nullptr, "sqrt", CgAddr { fn_t->addrof(cg), fn_v })) {
+	// The MemoryOrder effect orders atomics, see Cg::emit_ordered.
+	static constexpr const StringView ORDERS[] = {
+		"RELAXED", "ACQUIRE", "RELEASE", "ACQ_REL", "SEQ_CST"
+	};
+	Array<ConstField> fields{*cg.scratch};
+	for (Ulen l = countof(ORDERS), i = 0; i < l; i++) {
+		if (!fields.emplace_back(ORDERS[i], AstConst { Range{0, 0}, Sint64(i) })) {
 			return false;
 		}
 	}
+	auto order_t = cg.types.make(CgType::EnumInfo { cg.types.u64(), move(fields), StringView { "MemoryOrder" } });
+	if (!order_t || !cg.effects.insert(cg.symbols[KnownSymbol::MEMORY_ORDER], order_t)) {
+		return false;
+	}
 
-	// Register memory_ne and memory_eq intrinsic
-	{
-		Array<CgType*> args{cg.allocator};
-		if (!args.resize(3)) {
-			return false;
-		}
-		args[0] = cg.types.ptr();
-		args[1] = cg.types.ptr();
-		args[2] = cg.types.u64();
-		Array<CgType*> rets{cg.allocator};
-		if (!rets.push_back(cg.types.b32())) {
-			return false;
-		}
-		auto args_t = cg.types.make(CgType::TupleInfo { move(args), None{}, None{} });
-		auto rets_t = cg.types.make(CgType::TupleInfo { move(rets), None{}, None{} });
-		if (!args_t || !rets_t) {
-			return false;
-		}
-		auto fn_t = cg.types.make(CgType::FnInfo { cg.types.unit(), args_t, cg.types.unit(), rets_t });
-		if (!fn_t) {
-			return false;
-		}
-		auto fn_v = cg.llvm.AddFunction(cg.module, "__biron_runtime_memory_ne", fn_t->ref());
-		if (!cg.intrinsics.emplace_back(nullptr, "memory_ne", CgAddr { fn_t->addrof(cg), fn_v })) {
-			return false;
-		}
-		// We can just reuse all of the same things
-		fn_v = cg.llvm.AddFunction(cg.module, "__biron_runtime_memory_eq", fn_t->ref());
-		if (!cg.intrinsics.emplace_back(nullptr, "memory_eq", CgAddr { fn_t->addrof(cg), fn_v })) {
-			return false;
-		}
+	return true;
+}
+
+Bool Ast::codegen(Cg& cg, Pass pass) const noexcept {
+	// We should have at least one top-level module.
+	const auto modules = cache<AstModule>();
+	if (!modules || modules->empty()) {
+		return cg.error(Range{0, 0}, "Missing 'module'");
+	}
+	if (modules->length() > 1) {
+		return cg.error(Range{0, 0}, "Multiple 'module' definitions in file");
+	}
+	auto module = static_cast<const AstModule*>((*modules)[0]);
+	if (!module->codegen(cg)) {
+		return false;
 	}
 
-	// Emit all the global let statements first since types may depend on them for
-	// e.g array extents and what not.
-	if (const auto glets = cache<AstGLetStmt>()) {
-		for (auto let : *glets) {
-			cg.scratch->clear();
-			if (!static_cast<const AstGLetStmt*>(let)->codegen(cg)) {
-				return false;
+	// Somewhat frustrating this is needed until we add a dependency sorter.
+	cg.ast = this;
+
+	switch (pass) {
+	case Pass::DECLS:
+		if (const auto typedefs = cache<AstTypedef>()) {
+			for (auto node : *typedefs) {
+				auto type = static_cast<const AstTypedef*>(node);
+				if (!cg.declare(cg.typedef_decls, type->name(), type)) {
+					return cg.oom();
+				}
 			}
 		}
-	}
-
-	// Emit all the types next. Each type will recurse and resolve their types
-	// and mark the type as already being generated so that this main loop does
-	// not generate the same type twice. This is how we do a topological sort.
-	if (const auto typedefs = cache<AstTypedef>()) {
-		for (auto type : *typedefs) {
-			cg.scratch->clear();
-			if (!static_cast<const AstTypedef*>(type)->codegen(cg)) {
-				return false;
+		if (const auto effects = cache<AstEffect>()) {
+			for (auto node : *effects) {
+				auto effect = static_cast<const AstEffect*>(node);
+				if (!cg.declare(cg.effect_decls, effect->name(), effect)) {
+					return cg.oom();
+				}
 			}
 		}
-	}
-
-	// Emit all the effects next.
-	if (const auto effects = cache<AstEffect>()) {
-		for (auto effect : *effects) {
-			cg.scratch->clear();
-			if (!static_cast<const AstEffect*>(effect)->codegen(cg)) {
-				return false;
+		break;
+	case Pass::GLOBALS:
+		// Emit all the global let statements first since types may depend on them
+		// for e.g array extents and what not.
+		if (const auto glets = cache<AstGLetStmt>()) {
+			TraceScope scope{cg.trace, "Globals"};
+			for (auto let : *glets) {
+				cg.scratch->clear();
+				if (!static_cast<const AstGLetStmt*>(let)->codegen(cg)) {
+					return false;
+				}
 			}
 		}
-	}
-
-	if (const auto fns = cache<AstFn>()) {
+		break;
+	case Pass::TYPEDEFS:
+		// Emit all the types next. Each type will recurse and resolve their types
+		// and mark the type as already being generated so that this main loop does
+		// not generate the same type twice. This is how we do a topological sort.
+		if (const auto typedefs = cache<AstTypedef>()) {
+			TraceScope scope{cg.trace, "Typedefs"};
+			for (auto type : *typedefs) {
+				cg.scratch->clear();
+				TraceScope scope{cg.trace, "Typedef", static_cast<const AstTypedef*>(type)->name().string()};
+				if (!static_cast<const AstTypedef*>(type)->codegen(cg)) {
+					return false;
+				}
+			}
+		}
+		break;
+	case Pass::EFFECTS:
+		// Emit all the effects next.
+		if (const auto effects = cache<AstEffect>()) {
+			TraceScope scope{cg.trace, "Effects"};
+			for (auto effect : *effects) {
+				cg.scratch->clear();
+				TraceScope scope{cg.trace, "Effect", static_cast<const AstEffect*>(effect)->name().string()};
+				if (!static_cast<const AstEffect*>(effect)->codegen(cg)) {
+					return false;
+				}
+			}
+		}
+		break;
+	case Pass::PROTOTYPE:
 		// Before we codegen functions we do a preprocessing step to make sure all
 		// functions have values generated for them so that we do not need function
 		// prototypes in our language.
-		for (auto fn : *fns) {
-			cg.scratch->clear();
-			if (!static_cast<const AstFn*>(fn)->prepass(cg)) {
-				return false;
+		if (const auto fns = cache<AstFn>()) {
+			TraceScope scope{cg.trace, "Prepass"};
+			for (auto fn : *fns) {
+				cg.scratch->clear();
+				if (!static_cast<const AstFn*>(fn)->prepass(cg)) {
+					return false;
+				}
 			}
 		}
+		break;
+	case Pass::FUNCTIONS:
 		// We can then codegen functions in any order we so desire.
-		for (auto fn : *fns) {
-			cg.scratch->clear();
-			if (!static_cast<const AstFn*>(fn)->codegen(cg)) {
-				return false;
+		if (const auto fns = cache<AstFn>()) {
+			TraceScope scope{cg.trace, "Functions"};
+			// The partitions are runs of functions with about as much source each.
+			Ulen total = 0;
+			for (auto node : *fns) {
+				total += static_cast<const AstFn*>(node)->range().length;
+			}
+			Ulen offset = 0;
+			Sema sema{cg};
+			for (auto node : *fns) {
+				auto fn = static_cast<const AstFn*>(node);
+				const auto partition = total ? (offset * cg.partition.count) / total : 0;
+				offset += fn->range().length;
+				if (partition != cg.partition.index) {
+					// Declared by the prototype pass, defined by another partition.
+					continue;
+				}
+				cg.scratch->clear();
+				TraceScope scope{cg.trace, "Function", fn->name().string()};
+				// Each function is analyzed right before it is lowered so diagnostics
+				// come out in source order.
+				if (!fn->analyze(sema) || !fn->codegen(cg)) {
+					return false;
+				}
 			}
 		}
+		break;
 	}
 
 	return true;
 }
 
+Bool Ast::codegen(Cg& cg) const noexcept {
+	if (!prelude(cg)) {
+		return false;
+	}
+	for (auto pass : PASSES) {
+		if (!codegen(cg, pass)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 } // namespace Biron
\ No newline at end of file
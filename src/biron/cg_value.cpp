@@ -6,6 +6,15 @@ namespace Biron {
 // CgAddr
 CgValue CgAddr::load(Cg& cg) const noexcept {
 	auto type = m_type->deref();
+	if (type->is_atomic()) {
+		auto load = cg.emit_ordered(type->ref(), [&](LLVM::AtomicOrdering order) {
+			auto load = cg.llvm.BuildLoad2(cg.builder, type->ref(), m_ref, "");
+			cg.llvm.SetAlignment(load, type->align());
+			cg.llvm.SetOrdering(load, Cg::load_order(order));
+			return load;
+		});
+		return CgValue { type, load };
+	}
 	auto load = cg.llvm.BuildLoad2(cg.builder, type->ref(), m_ref, "");
 	cg.llvm.SetAlignment(load, type->align());
 	return CgValue { type, load };
@@ -76,6 +85,16 @@ Bool CgAddr::store(Cg& cg, const CgValue& value) const noexcept {
 				return true;
 			}
 		}
+		// Stores to an atomic are atomic, the value may be of the base type.
+		if (auto dst_type = m_type->deref(); dst_type->is_atomic()) {
+			cg.emit_ordered(nullptr, [&](LLVM::AtomicOrdering order) {
+				auto store = cg.llvm.BuildStore(cg.builder, value.ref(), m_ref);
+				cg.llvm.SetAlignment(store, dst_type->align());
+				cg.llvm.SetOrdering(store, Cg::store_order(order));
+				return store;
+			});
+			return true;
+		}
 		// Regular store for all other types.
 		auto store = cg.llvm.BuildStore(cg.builder, value.ref(), m_ref);
 		cg.llvm.SetAlignment(store, value.type()->align());
@@ -124,6 +143,9 @@ CgAddr CgAddr::at(Cg& cg, const CgValue& index) const noexcept {
 	// 	-  (*x_ptr)[index] is Uint32
 	// 	- &(*x_ptr)[index] is *Uint32
 	auto type = m_type->deref();
+	if (type->is_vector()) {
+		return lane(cg, index.ref());
+	}
 	LLVM::ValueRef indices[] = {
 		cg.llvm.ConstInt(cg.types.u32()->ref(), 0, false),
 		index.ref(),
@@ -159,6 +181,16 @@ CgAddr CgAddr::at_virt(Cg& cg, Ulen v) const noexcept {
 	BIRON_UNREACHABLE();
 }
 
+CgAddr CgAddr::lane(Cg& cg, LLVM::ValueRef index) const noexcept {
+	// The lanes of a vector are addressed as an array of its element type since
+	// LLVM discourages getelementptr into vectors. Vectors of booleans are packed
+	// so their lanes have no address, the callers must not get here with one.
+	auto base = m_type->deref()->deref();
+	BIRON_ASSERT(!base->is_bool() && "Lanes of boolean vectors have no address");
+	auto gep = cg.llvm.BuildInBoundsGEP2(cg.builder, base->ref(), m_ref, &index, 1, "");
+	return CgAddr { base->addrof(cg), gep };
+}
+
 CgAddr::CgAddr(CgType *const type, LLVM::ValueRef ref) noexcept
 	: m_type{type}
 	, m_ref{ref}
@@ -170,6 +202,9 @@ CgAddr CgAddr::at(Cg& cg, Ulen i) const noexcept {
 	auto u32 = cg.types.u32();
 
 	auto type = m_type->deref();
+	if (type->is_vector()) {
+		return lane(cg, cg.llvm.ConstInt(u32->ref(), i, false));
+	}
 	LLVM::ValueRef indices[] = {
 		cg.llvm.ConstInt(u32->ref(), 0, false),
 		cg.llvm.ConstInt(u32->ref(), i, false),
@@ -196,6 +231,10 @@ Maybe<CgValue> CgValue::at(Cg& cg, Ulen i) const noexcept {
 	} else if (m_type->is_tuple() || m_type->is_union()) {
 		auto value = cg.llvm.BuildExtractValue(cg.builder, m_ref, i, "");
 		return CgValue { m_type->at(i), value };
+	} else if (m_type->is_vector()) {
+		auto index = cg.llvm.ConstInt(cg.types.u32()->ref(), i, false);
+		auto value = cg.llvm.BuildExtractElement(cg.builder, m_ref, index, "");
+		return CgValue { m_type->deref(), value };
 	}
 	return None{};
 }
@@ -2,6 +2,7 @@
 #define BIRON_CG_VALUE_H
 #include <biron/llvm.h>
 #include <biron/ast_const.h>
+#include <biron/symbol.h>
 #include <biron/util/string.h>
 
 namespace Biron {
@@ -18,6 +19,7 @@ struct CgAddr {
 	CgAddr at(Cg& cg, Ulen index) const noexcept;
 	CgAddr at_virt(Cg& cg, Ulen v) const noexcept;
 	CgAddr at(Cg& cg, const CgValue& index) const noexcept;
+	CgAddr lane(Cg& cg, LLVM::ValueRef index) const noexcept;
 
 	CgValue load(Cg& cg) const noexcept;
 	Bool store(Cg& cg, const CgValue& value) const noexcept;
@@ -74,7 +76,7 @@ inline CgValue CgAddr::to_value() const noexcept {
 }
 
 struct CgVar {
-	constexpr CgVar(const AstNode* node, StringView name, CgAddr&& addr) noexcept
+	constexpr CgVar(const AstNode* node, Symbol name, CgAddr&& addr) noexcept
 		: m_node{node}
 		, m_name{name}
 		, m_addr{move(addr)}
@@ -83,7 +85,7 @@ struct CgVar {
 	[[nodiscard]] constexpr const AstNode* node() const noexcept {
 		return m_node;
 	}
-	[[nodiscard]] constexpr StringView name() const noexcept {
+	[[nodiscard]] constexpr Symbol name() const noexcept {
 		return m_name;
 	}
 	[[nodiscard]] constexpr const CgAddr& addr() const noexcept {
@@ -91,7 +93,7 @@ struct CgVar {
 	}
 private:
 	const AstNode* m_node;
-	StringView     m_name;
+	Symbol         m_name;
 	CgAddr         m_addr;
 };
 
@@ -108,19 +110,6 @@ private:
 	AstConst m_value;
 };
 
-struct CgTypeDef {
-	constexpr CgTypeDef(StringView name, CgType* type) noexcept
-		: m_name{name}
-		, m_type{type}
-	{
-	}
-	[[nodiscard]] constexpr StringView name() const noexcept { return m_name; }
-	[[nodiscard]] constexpr CgType* type() const noexcept { return m_type; }
-private:
-	StringView m_name;
-	CgType*    m_type;
-};
-
 } // namespace Biron
 
 #endif
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <biron/compiler.h>
+
+namespace Biron {
+
+Maybe<Compiler::Result> Compiler::compile(const Array<Source>& sources,
+                                          Output output,
+                                          Ulen opt,
+                                          StringView triple) noexcept
+{
+	Result result{m_allocator};
+	result.ok = generate(sources, output, opt, triple, result);
+
+	// Everything the sources needed is released but the memory is kept around
+	// for the next call.
+	m_arena.rewind();
+
+	Bool valid = true;
+	m_terminal.drain([&](StringView out, StringView err) {
+		result.diagnostics.append(out);
+		result.diagnostics.append(err);
+		valid = result.diagnostics.valid();
+	});
+	if (!valid) {
+		return None{};
+	}
+
+	return result;
+}
+
+Bool Compiler::generate(const Array<Source>& sources,
+                        Output output,
+                        Ulen opt,
+                        StringView triple,
+                        Result& result) noexcept
+{
+	if (sources.empty()) {
+		m_terminal.err("Missing sources\n");
+		return false;
+	}
+
+	Symbols symbols{m_arena};
+	if (!symbols.init()) {
+		m_terminal.err("Out of memory\n");
+		return false;
+	}
+
+	Units units{m_arena, symbols};
+	for (const auto& source : sources) {
+		auto unit = units.add(source.name, source.data, m_terminal);
+		if (!unit) {
+			m_terminal.err("Out of memory\n");
+			return false;
+		}
+		// The arena is not thread safe so lex on this thread.
+		if (!unit->parse(nullptr)) {
+			return false;
+		}
+	}
+
+	auto cg = Cg::make(m_terminal, m_arena, m_llvm, symbols, (*units.begin())->diagnostic);
+	if (!cg) {
+		m_terminal.err("Could not initialize code generator\n");
+		return false;
+	}
+
+	if (!Ast::prelude(*cg)) {
+		return false;
+	}
+	for (auto pass : Ast::PASSES) {
+		for (auto unit : units) {
+			cg->use(unit->diagnostic);
+			if (!unit->ast->codegen(*cg, pass)) {
+				return false;
+			}
+		}
+	}
+
+	if (output == Output::CHECK) {
+		return true;
+	}
+
+	// The target machine is only recreated when the triple changes.
+	if (!m_machine || m_triple.view() != triple) {
+		m_machine.reset();
+		m_triple.clear();
+		if (!m_triple.append(triple)) {
+			m_terminal.err("Out of memory\n");
+			return false;
+		}
+		auto machine = CgMachine::make(m_terminal, m_llvm, triple);
+		if (!machine) {
+			return false;
+		}
+		m_machine.emplace(move(*machine));
+	}
+
+	if (!cg->optimize(*m_machine, opt)) {
+		return false;
+	}
+
+	if (output == Output::IR) {
+		result.ir = cg->print(m_allocator);
+		return result.ir.is_some();
+	}
+
+	result.object = cg->emit(*m_machine, m_allocator);
+	return result.object.is_some();
+}
+
+} // namespace Biron
@@ -0,0 +1,131 @@
+#ifndef BIRON_COMPILER_H
+#define BIRON_COMPILER_H
+#include <biron/util/terminal.inl>
+
+#include <biron/lexer.h>
+#include <biron/diagnostic.h>
+#include <biron/parser.h>
+#include <biron/cg.h>
+
+namespace Biron {
+
+// The Lexer, Diagnostic and Parser of a source refer to each other and the Ast
+// is allocated from the Parser so all of them must live at a stable address for
+// as long as the Ast is used.
+struct Unit {
+	Unit(StringView name, StringView data, Terminal& terminal, Symbols& symbols, Allocator& allocator) noexcept
+		: lexer{name, data}
+		, diagnostic{lexer, terminal, allocator}
+		, parser{lexer, diagnostic, symbols, allocator}
+		, tokens{allocator}
+	{
+	}
+	// The source is lexed up front, on threads when given a |system| and it is
+	// large enough. Should that fail the parser pulls tokens from the lexer.
+	[[nodiscard]] Bool parse(const System* system) noexcept {
+		if (lexer.tokenize(tokens, system)) {
+			parser.use(tokens);
+		}
+		return (ast = parser.parse()).is_some();
+	}
+	Lexer      lexer;
+	Diagnostic diagnostic;
+	Parser     parser;
+	Tokens     tokens;
+	Maybe<Ast> ast;
+};
+
+// All units of a compilation share the Symbols so the same identifier is the
+// same Symbol across units.
+struct Units {
+	constexpr Units(Allocator& allocator, Symbols& symbols) noexcept
+		: m_allocator{allocator}
+		, m_symbols{symbols}
+		, m_units{allocator}
+	{
+	}
+	~Units() noexcept {
+		for (auto unit : m_units) {
+			unit->~Unit();
+			m_allocator.deallocate_object(unit);
+		}
+	}
+	[[nodiscard]] Unit* add(StringView name, StringView data, Terminal& terminal) noexcept {
+		auto unit = m_allocator.make<Unit>(name, data, terminal, m_symbols, m_allocator);
+		if (unit && !m_units.push_back(unit)) {
+			unit->~Unit();
+			m_allocator.deallocate_object(unit);
+			return nullptr;
+		}
+		return unit;
+	}
+	[[nodiscard]] Unit** begin() noexcept { return m_units.begin(); }
+	[[nodiscard]] Unit** end() noexcept { return m_units.end(); }
+private:
+	Allocator&   m_allocator;
+	Symbols&     m_symbols;
+	Array<Unit*> m_units;
+};
+
+// The compiler as a library. Sources are given in memory and the object code or
+// IR is returned in memory together with the diagnostics, nothing touches the
+// filesystem. The LLVM function table, target machine and memory are kept from
+// one call to the next so compiling many small sources stays cheap.
+//
+// A Compiler is not thread safe, use one per thread. They can share the LLVM.
+struct Compiler {
+	struct Source {
+		StringView name;
+		StringView data;
+	};
+
+	enum class Output : Uint8 {
+		OBJECT, // Object code
+		IR,     // Textual LLVM IR
+		CHECK,  // Diagnostics only, works with LLVM::null
+	};
+
+	struct Result {
+		Result(Allocator& allocator) noexcept
+			: diagnostics{allocator}
+		{
+		}
+		Bool                 ok = false;
+		Maybe<Array<Uint8>>  object;
+		Maybe<StringBuilder> ir;
+		StringBuilder        diagnostics;
+	};
+
+	constexpr Compiler(const System& system, LLVM& llvm, Allocator& allocator) noexcept
+		: m_system{system}
+		, m_llvm{llvm}
+		, m_allocator{allocator}
+		, m_arena{allocator}
+		, m_terminal{system, true}
+		, m_triple{allocator}
+	{
+	}
+
+	// All sources are compiled together into a single module the same way as
+	// with -whole-program. The result is allocated from the allocator given to
+	// the Compiler and outlives the call. Returns None only when out of memory.
+	[[nodiscard]] Maybe<Result> compile(const Array<Source>& sources,
+	                                    Output output,
+	                                    Ulen opt = 0,
+	                                    StringView triple = "x86_64-unknown-none") noexcept;
+
+private:
+	Bool generate(const Array<Source>& sources, Output output, Ulen opt, StringView triple, Result& result) noexcept;
+
+	const System&    m_system;
+	LLVM&            m_llvm;
+	Allocator&       m_allocator;
+	ArenaAllocator   m_arena;   // Everything which does not outlive a call
+	Terminal         m_terminal;
+	Maybe<CgMachine> m_machine; // Created on first use for |m_triple|
+	StringBuilder    m_triple;
+};
+
+} // namespace Biron
+
+#endif // BIRON_COMPILER_H
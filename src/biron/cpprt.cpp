@@ -22,8 +22,9 @@ extern "C" {
 		abort();
 	}
 
-	// C++ allows concurrent initialize of static constants. We do not rely on this
-	// behavior so just stub them out
+	// Statics can be initialized concurrently, like the ids of AstID which the
+	// parsers of -j touch first from many threads at once. The first thread to
+	// claim |pending| runs the initializer and the others wait for |done|.
 	using namespace Biron;
 
 	struct Guard {
@@ -34,19 +35,22 @@ extern "C" {
 	static_assert(sizeof(Guard) == 64);
 
 	int __cxa_guard_acquire(Guard* guard) noexcept {
-		if (guard->done) {
+		if (__atomic_load_n(&guard->done, __ATOMIC_ACQUIRE)) {
 			return 0;
 		}
-		if (guard->pending) {
-			fprintf(stderr, "Recursive initialization of statics are not supported");
-			abort();
+		Uint8 expected = 0;
+		if (__atomic_compare_exchange_n(&guard->pending, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+			return 1;
 		}
-		guard->pending = 1;
-		return 1;
+		// Another thread is running the initializer. They are all small so this
+		// spins rather than sleeps.
+		while (!__atomic_load_n(&guard->done, __ATOMIC_ACQUIRE)) {
+		}
+		return 0;
 	}
 
 	void __cxa_guard_release(Guard* guard) noexcept {
-		guard->done = 1;
+		__atomic_store_n(&guard->done, 1, __ATOMIC_RELEASE);
 	}
 } // extern "C"
 
@@ -5,23 +5,18 @@
 namespace Biron {
 
 void Diagnostic::diagnostic(Range range, Kind kind, StringView message) noexcept {
-	// Work out the column and line from the token offset.
-	Ulen line_number = 1;
-	Ulen this_column = 1;
-	// We just count newlines from the beginning of the lexer stream up to but not
-	// including where the token starts itself. We also keep track of the previous
-	// lines length (last_column) to handle the case where a parse error happens
-	// right on the end of a line (see below).
-	for (Ulen i = 0; i < range.offset; i++) {
-		if (m_lexer[i] == '\n') {
-			line_number++;
-			this_column = 0;
-		}
-		this_column++;
+	const auto len = m_lexer.data().length();
+	const auto lines = m_lexer.lines(m_allocator);
+	if (!lines) {
+		m_terminal.err("Out of memory while reporting diagnostic\n");
+		return;
 	}
-	// When the error is right at the end of the line, the above counting logic
-	// will report an error on the first column of the next line.
-	if (range.offset && m_lexer[range.offset - 1] == '\n') {
+
+	// Work out the column and line from the token offset with the line index.
+	auto [line_number, this_column] = lines->locate(min(range.offset, len));
+	// When the error is right at the end of the line, the above will report an
+	// error on the first column of the next line.
+	if (range.offset && range.offset <= len && m_lexer[range.offset - 1] == '\n') {
 		line_number--;
 		range.offset--;
 	}
@@ -51,21 +46,14 @@ void Diagnostic::diagnostic(Range range, Kind kind, StringView message) noexcept
 	m_terminal.err(StringView { msg->data(), msg->length() });
 
 	// Print the offending line.
-	const auto len = m_lexer.data().length();
 	if (range.offset == 0 || range.offset >= len) {
 		// Do not print the offending line when the error range is invalid.
 		return;
 	}
 
-	auto line_beg = range.offset;
-	auto line_end = range.offset;
-	while (line_beg && m_lexer[line_beg - 1] != '\n') {
-		line_beg--;
-	}
-	while (line_end < len && m_lexer[line_end] != '\n') {
-		line_end++;
-	}
-	const auto line_len = line_end - line_beg;
+	const auto line = lines->line(line_number);
+	const auto line_beg = line.offset;
+	const auto line_len = line.length;
 
 	m_terminal.err(m_lexer.string({ line_beg, line_len }));
 	m_terminal.err("\n");
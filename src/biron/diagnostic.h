@@ -19,6 +19,7 @@ struct Diagnostic {
 	constexpr Diagnostic(Lexer& lexer, Terminal& terminal, Allocator& allocator) noexcept
 		: m_lexer{lexer}
 		, m_terminal{terminal}
+		, m_allocator{allocator}
 		, m_scratch{allocator}
 	{
 	}
@@ -52,6 +53,7 @@ struct Diagnostic {
 private:
 	Lexer&           m_lexer;
 	Terminal&        m_terminal;
+	Allocator&       m_allocator;
 	ScratchAllocator m_scratch;
 };
 
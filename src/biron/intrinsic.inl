@@ -0,0 +1,43 @@
+#ifndef INTRINSIC
+#define INTRINSIC(...)
+#endif
+
+// The LLVM intrinsics which can be called by name. Like the vector builtins they
+// are generic, the type of the first operand selects the overload and every other
+// operand must have the same type. Vectors of the same class are accepted too.
+//
+// INTRINSIC(NAME, STRING, LLVM, OPERANDS, CLASS, FORM)
+//
+// CLASS is INTEGER, SINT, UINT or REAL and FORM is one of:
+//   PLAIN    The result has the type of the operands
+//   BYTES    As PLAIN but the operand must be a whole number of 16-bit halves
+//   POISON   As PLAIN but LLVM takes an extra 'is_zero_poison' flag, never set
+//   OVERFLOW The result is the tuple (T, Bool32) of the value and overflow
+
+// Bit manipulation
+INTRINSIC(CTPOP,         "ctpop",         "llvm.ctpop",             1, INTEGER, PLAIN)
+INTRINSIC(CTLZ,          "ctlz",          "llvm.ctlz",              1, INTEGER, POISON)
+INTRINSIC(CTTZ,          "cttz",          "llvm.cttz",              1, INTEGER, POISON)
+INTRINSIC(BSWAP,         "bswap",         "llvm.bswap",             1, INTEGER, BYTES)
+INTRINSIC(BITREVERSE,    "bitreverse",    "llvm.bitreverse",        1, INTEGER, PLAIN)
+INTRINSIC(FSHL,          "fshl",          "llvm.fshl",              3, INTEGER, PLAIN)
+INTRINSIC(FSHR,          "fshr",          "llvm.fshr",              3, INTEGER, PLAIN)
+
+// Math
+INTRINSIC(FMA,           "fma",           "llvm.fma",               3, REAL,    PLAIN)
+INTRINSIC(SQRT,          "sqrt",          "llvm.sqrt",              1, REAL,    PLAIN)
+INTRINSIC(FABS,          "fabs",          "llvm.fabs",              1, REAL,    PLAIN)
+INTRINSIC(FLOOR,         "floor",         "llvm.floor",             1, REAL,    PLAIN)
+INTRINSIC(CEIL,          "ceil",          "llvm.ceil",              1, REAL,    PLAIN)
+INTRINSIC(SMIN,          "smin",          "llvm.smin",              2, SINT,    PLAIN)
+INTRINSIC(SMAX,          "smax",          "llvm.smax",              2, SINT,    PLAIN)
+INTRINSIC(UMIN,          "umin",          "llvm.umin",              2, UINT,    PLAIN)
+INTRINSIC(UMAX,          "umax",          "llvm.umax",              2, UINT,    PLAIN)
+
+// Overflow checked arithmetic
+INTRINSIC(SADD_OVERFLOW, "sadd_overflow", "llvm.sadd.with.overflow", 2, SINT,    OVERFLOW)
+INTRINSIC(UADD_OVERFLOW, "uadd_overflow", "llvm.uadd.with.overflow", 2, UINT,    OVERFLOW)
+INTRINSIC(SSUB_OVERFLOW, "ssub_overflow", "llvm.ssub.with.overflow", 2, SINT,    OVERFLOW)
+INTRINSIC(USUB_OVERFLOW, "usub_overflow", "llvm.usub.with.overflow", 2, UINT,    OVERFLOW)
+INTRINSIC(SMUL_OVERFLOW, "smul_overflow", "llvm.smul.with.overflow", 2, SINT,    OVERFLOW)
+INTRINSIC(UMUL_OVERFLOW, "umul_overflow", "llvm.umul.with.overflow", 2, UINT,    OVERFLOW)
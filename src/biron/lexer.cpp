@@ -1,29 +1,253 @@
 #include <biron/lexer.h>
+#include <biron/util/thread.h>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define BIRON_LEXER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define BIRON_LEXER_SSE2
+#endif
+
+#if defined(BIRON_COMPILER_MSVC)
+	#include <intrin.h>
+#endif
 
 namespace Biron {
 
-static Bool is_space(int ch) noexcept {
-	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
-}
+// Every byte maps to the set of character classes it belongs to. Anything
+// outside of ASCII, as well as -1 for the end of input, belongs to none.
+enum : Uint8 {
+	CLASS_SPACE = 1 << 0,
+	CLASS_ALPHA = 1 << 1,
+	CLASS_DIGIT = 1 << 2,
+	CLASS_BIN   = 1 << 3,
+	CLASS_HEX   = 1 << 4,
+	CLASS_IDENT = 1 << 5,
+};
 
-static Bool is_alpha(int ch) noexcept {
-	return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
-}
+struct CharClasses {
+	constexpr CharClasses() noexcept : classes{} {
+		for (int ch = 0; ch < 256; ch++) {
+			Uint8 c = 0;
+			if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') c |= CLASS_SPACE;
+			if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')) c |= CLASS_ALPHA | CLASS_IDENT;
+			if (ch >= '0' && ch <= '9') c |= CLASS_DIGIT | CLASS_HEX | CLASS_IDENT;
+			if (ch == '0' || ch == '1') c |= CLASS_BIN;
+			if ((ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F')) c |= CLASS_HEX;
+			if (ch == '_') c |= CLASS_IDENT;
+			classes[ch] = c;
+		}
+	}
+	constexpr Bool is(int ch, Uint8 c) const noexcept {
+		return classes[Uint8(ch)] & c;
+	}
+	Uint8 classes[256];
+};
 
-static Bool is_digit(int ch) noexcept {
-	return ch >= '0' && ch <= '9';
-}
+static constexpr const CharClasses CHAR_CLASSES;
+
+static Bool is_space(int ch) noexcept { return CHAR_CLASSES.is(ch, CLASS_SPACE); }
+static Bool is_alpha(int ch) noexcept { return CHAR_CLASSES.is(ch, CLASS_ALPHA); }
+static Bool is_digit(int ch) noexcept { return CHAR_CLASSES.is(ch, CLASS_DIGIT); }
+static Bool is_bin(int ch)   noexcept { return CHAR_CLASSES.is(ch, CLASS_BIN); }
+static Bool is_hex(int ch)   noexcept { return CHAR_CLASSES.is(ch, CLASS_HEX); }
+static Bool is_ident(int ch) noexcept { return CHAR_CLASSES.is(ch, CLASS_IDENT); }
+
+// Keywords are found with a perfect hash over their first, middle and last
+// character and length. The multipliers are searched for at compile time so adding a
+// keyword to lexer.inl is all that is needed.
+struct Keyword {
+	const char* spelling = nullptr;
+	Ulen        length   = 0;
+	Token::Kind kind     = Token::Kind::IDENT;
+};
+
+static constexpr const Keyword KEYWORDS[] = {
+	#define KIND(...)
+	#define KEYWORD(NAME, SPELLING) { SPELLING, sizeof SPELLING - 1, Token::Kind::NAME },
+	#include <biron/lexer.inl>
+	#undef KIND
+};
+
+struct Keywords {
+	static inline constexpr const Uint32 SIZE = 64;
+	static_assert(countof(KEYWORDS) <= SIZE);
+
+	static constexpr Uint32 hash(const char* s, Ulen length, Uint32 a, Uint32 b) noexcept {
+		return (Uint8(s[0]) * a + Uint8(s[length / 2]) * b + Uint8(s[length - 1]) + Uint32(length)) % SIZE;
+	}
+
+	constexpr Keywords() noexcept : table{} {
+		for (a = 1; a < 256; a++) {
+			for (b = 1; b < 256; b++) {
+				if (place()) {
+					return;
+				}
+			}
+		}
+	}
+
+	constexpr Bool place() noexcept {
+		for (auto& entry : table) {
+			entry = {};
+		}
+		for (const auto& keyword : KEYWORDS) {
+			auto& entry = table[hash(keyword.spelling, keyword.length, a, b)];
+			if (entry.length) {
+				return false;
+			}
+			entry = keyword;
+		}
+		return true;
+	}
+
+	// One probe and one compare.
+	Token::Kind find(StringView ident) const noexcept {
+		const auto& entry = table[hash(ident.data(), ident.length(), a, b)];
+		if (entry.length == ident.length() && StringView{entry.spelling, entry.length} == ident) {
+			return entry.kind;
+		}
+		return Token::Kind::IDENT;
+	}
+
+	Uint32  a = 0;
+	Uint32  b = 0;
+	Keyword table[SIZE];
+};
+
+static constexpr const Keywords KEYWORD_TABLE;
+static_assert(KEYWORD_TABLE.a < 256, "Could not find a perfect hash for the keywords");
+
+// The fast paths of the lexer look at a whole vector of bytes at a time and
+// produce a mask with a bit set for every byte matching some class. They never
+// read past the end of the source, the remaining bytes are handled by the same
+// scalar code which is used when SIMD is disabled so the tokens are identical.
+#if defined(BIRON_LEXER_AVX2) || defined(BIRON_LEXER_SSE2)
+struct Simd {
+#if defined(BIRON_LEXER_AVX2)
+	static inline constexpr const Ulen WIDTH = 32;
+	static inline constexpr const Uint32 ALL = 0xffffffff_u32;
+	static Simd load(const char* data) noexcept {
+		return { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)) };
+	}
+	Uint32 eq(char ch) const noexcept {
+		return _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(ch)));
+	}
+	// Bytes in [lo, hi], the compare is signed so bytes >= 0x80 never match.
+	Uint32 in(char lo, char hi) const noexcept {
+		const auto ge = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1));
+		const auto le = _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v);
+		return _mm256_movemask_epi8(_mm256_and_si256(ge, le));
+	}
+	__m256i v;
+#else
+	static inline constexpr const Ulen WIDTH = 16;
+	static inline constexpr const Uint32 ALL = 0xffff_u32;
+	static Simd load(const char* data) noexcept {
+		return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)) };
+	}
+	Uint32 eq(char ch) const noexcept {
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(ch)));
+	}
+	// Bytes in [lo, hi], the compare is signed so bytes >= 0x80 never match.
+	Uint32 in(char lo, char hi) const noexcept {
+		const auto ge = _mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1));
+		const auto le = _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v);
+		return _mm_movemask_epi8(_mm_and_si128(ge, le));
+	}
+	__m128i v;
+#endif
+	// Index of the lowest set bit, |mask| cannot be zero.
+	static Ulen first(Uint32 mask) noexcept {
+	#if defined(BIRON_COMPILER_MSVC)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+	#else
+		return __builtin_ctz(mask);
+	#endif
+	}
+};
+#endif
 
-static Bool is_bin(int ch) noexcept {
-	return ch == '0' || ch == '1';
+// Most runs of whitespace, identifiers and so on are short enough that looking
+// at them a byte at a time is cheaper than a vector compare. The fast paths only
+// take over from the scalar code once a run is at least this long.
+static inline constexpr const Ulen PROBE = 16;
+
+// Returns the offset of the first byte at or after |offset| which is not
+// whitespace.
+template<Bool SIMD>
+static Ulen skip_space(StringView data, Ulen offset) noexcept {
+#if defined(BIRON_LEXER_AVX2) || defined(BIRON_LEXER_SSE2)
+	if constexpr (SIMD) {
+		const auto probe = offset + PROBE < data.length() ? offset + PROBE : data.length();
+		for (; offset < probe; offset++) {
+			if (!is_space(data[offset])) {
+				return offset;
+			}
+		}
+		for (; offset + Simd::WIDTH <= data.length(); offset += Simd::WIDTH) {
+			const auto v = Simd::load(data.data() + offset);
+			const auto mask = v.eq(' ') | v.eq('\t') | v.eq('\n') | v.eq('\r');
+			if (mask != Simd::ALL) {
+				return offset + Simd::first(~mask);
+			}
+		}
+	}
+#endif
+	while (offset < data.length() && is_space(data[offset])) offset++;
+	return offset;
 }
 
-static Bool is_hex(int ch) noexcept {
-	return is_digit(ch) || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+// Returns the offset of the first byte at or after |offset| which cannot be
+// part of an identifier.
+template<Bool SIMD>
+static Ulen skip_ident(StringView data, Ulen offset) noexcept {
+#if defined(BIRON_LEXER_AVX2) || defined(BIRON_LEXER_SSE2)
+	if constexpr (SIMD) {
+		const auto probe = offset + PROBE < data.length() ? offset + PROBE : data.length();
+		for (; offset < probe; offset++) {
+			if (!is_ident(data[offset])) {
+				return offset;
+			}
+		}
+		for (; offset + Simd::WIDTH <= data.length(); offset += Simd::WIDTH) {
+			const auto v = Simd::load(data.data() + offset);
+			const auto mask = v.in('a', 'z') | v.in('A', 'Z') | v.in('0', '9') | v.eq('_');
+			if (mask != Simd::ALL) {
+				return offset + Simd::first(~mask);
+			}
+		}
+	}
+#endif
+	while (offset < data.length() && is_ident(data[offset])) offset++;
+	return offset;
 }
 
-static Bool is_alnum(int ch) noexcept {
-	return is_alpha(ch) || is_digit(ch);
+// Returns the offset of the first |a| or |b| at or after |offset|, or the end
+// of |data| when there is neither.
+template<Bool SIMD>
+static Ulen find(StringView data, Ulen offset, char a, char b) noexcept {
+#if defined(BIRON_LEXER_AVX2) || defined(BIRON_LEXER_SSE2)
+	if constexpr (SIMD) {
+		const auto probe = offset + PROBE < data.length() ? offset + PROBE : data.length();
+		for (; offset < probe; offset++) {
+			if (data[offset] == a || data[offset] == b) {
+				return offset;
+			}
+		}
+		for (; offset + Simd::WIDTH <= data.length(); offset += Simd::WIDTH) {
+			const auto v = Simd::load(data.data() + offset);
+			if (const auto mask = v.eq(a) | v.eq(b)) {
+				return offset + Simd::first(mask);
+			}
+		}
+	}
+#endif
+	while (offset < data.length() && data[offset] != a && data[offset] != b) offset++;
+	return offset;
 }
 
 StringView Token::name() const noexcept {
@@ -44,10 +268,243 @@ Token Lexer::next() noexcept {
 	return token;
 }
 
+Token Lexer::ahead(Ulen n) noexcept {
+	const auto offset = m_offset;
+	auto token = next();
+	for (Ulen i = 1; i < n && !token.eof(); i++) {
+		token = next();
+	}
+	m_offset = offset;
+	return token;
+}
+
+Bool Tokens::push(Token token) noexcept {
+	// Offsets and lengths are 32-bit to keep the tokens compact.
+	if (token.range.offset > 0xffffffff_u32 || token.range.length > 0xffffffff_u32) {
+		return false;
+	}
+	return m_kinds.push_back(token.kind)
+	    && m_offsets.push_back(token.range.offset)
+	    && m_lengths.push_back(token.range.length);
+}
+
+Bool Tokens::append(const Tokens& other, Ulen index) noexcept {
+	const auto n = other.length() - index;
+	if (!m_kinds.reserve(length() + n)
+	 || !m_offsets.reserve(length() + n)
+	 || !m_lengths.reserve(length() + n))
+	{
+		return false;
+	}
+	for (Ulen i = index; i < other.length(); i++) {
+		(void)m_kinds.push_back(other.m_kinds[i]);
+		(void)m_offsets.push_back(other.m_offsets[i]);
+		(void)m_lengths.push_back(other.m_lengths[i]);
+	}
+	return true;
+}
+
+// Lexes from the current offset up to the first token which begins at or after
+// |end|. The offset of the first token and that of the token which begins at or
+// after |end| are stored in |first| and |next|.
+Bool Lexer::lex(Tokens& tokens, Ulen end, Ulen& first, Ulen& next) noexcept {
+	first = ~Ulen(0);
+	for (;;) {
+		const auto token = read();
+		if (first == ~Ulen(0)) {
+			first = token.range.offset;
+		}
+		if (token.range.offset >= end) {
+			next = token.range.offset;
+			return true;
+		}
+		if (token.kind != Token::Kind::COMMENT && !tokens.push(token)) {
+			return false;
+		}
+		if (token.eof()) {
+			next = token.range.offset;
+			return true;
+		}
+	}
+}
+
+// Chunks of a source are lexed independently, starting on a newline, as if
+// nothing before them could affect them. That is not true when a comment or
+// string literal spans the start of a chunk, which is found out and corrected
+// when the chunks are stitched back together.
+struct LexChunk {
+	LexChunk(const Lexer& lexer, Ulen beg, Ulen end, Allocator& allocator) noexcept
+		: lexer{lexer.m_name, lexer.m_data, lexer.m_simd}
+		, end{end}
+		, tokens{allocator}
+	{
+		this->lexer.m_offset = beg;
+	}
+	static void run(void* data) noexcept {
+		auto& chunk = *static_cast<LexChunk*>(data);
+		chunk.ok = chunk.lexer.lex(chunk.tokens, chunk.end, chunk.first, chunk.next);
+	}
+	Lexer  lexer;
+	Ulen   end;
+	Ulen   first = 0;
+	Ulen   next  = 0;
+	Tokens tokens;
+	Bool   ok    = false;
+};
+
+Bool Lexer::tokenize(Tokens& tokens, const System* system) noexcept {
+	// Sources smaller than a couple of chunks are not worth the threads.
+	static constexpr const Ulen CHUNK = 1024 * 1024;
+	static constexpr const Ulen MAX_CHUNKS = 16;
+
+	tokens.clear();
+
+	Lexer lexer{m_name, m_data, m_simd};
+	Ulen first = 0;
+	Ulen next = 0;
+	const auto length = m_data.length();
+	if (!system || length < CHUNK * 2) {
+		return lexer.lex(tokens, ~Ulen(0), first, next);
+	}
+
+	auto& allocator = tokens.allocator();
+	Array<LexChunk> chunks{allocator};
+	const auto n_chunks = min(length / CHUNK, MAX_CHUNKS);
+	if (!chunks.reserve(n_chunks)) {
+		return false;
+	}
+	for (Ulen beg = 0; beg < length; /**/) {
+		auto end = beg + length / n_chunks;
+		while (end < length && m_data[end] != '\n') end++;
+		if (chunks.length() == n_chunks - 1 || end >= length) {
+			end = ~Ulen(0);
+		}
+		if (!chunks.emplace_back(lexer, beg, end, allocator)) {
+			return false;
+		}
+		beg = end;
+	}
+
+	{
+		Array<Thread> threads{allocator};
+		for (Ulen i = 1; i < chunks.length(); i++) {
+			auto thread = Thread::make(*system, LexChunk::run, &chunks[i]);
+			if (!thread || !threads.push_back(move(*thread))) {
+				LexChunk::run(&chunks[i]);
+			}
+		}
+		LexChunk::run(&chunks[0]);
+		// The threads are joined here.
+	}
+
+	for (const auto& chunk : chunks) {
+		if (!chunk.ok) {
+			return false;
+		}
+	}
+
+	if (!tokens.append(chunks[0].tokens, 0)) {
+		return false;
+	}
+	auto resume = chunks[0].next;
+	for (Ulen i = 1; i < chunks.length(); i++) {
+		const auto& chunk = chunks[i];
+		if (resume == chunk.first) {
+			if (!tokens.append(chunk.tokens, 0)) {
+				return false;
+			}
+			resume = chunk.next;
+			continue;
+		}
+		// The previous chunk did not end where this one began. Lex from where it
+		// did end until a token begins on the same offset as one in this chunk,
+		// from there on the tokens are the same.
+		lexer.m_offset = resume;
+		for (Ulen k = 0; /**/; /**/) {
+			const auto token = lexer.read();
+			if (token.range.offset >= chunk.end) {
+				resume = token.range.offset;
+				break;
+			}
+			while (k < chunk.tokens.length() && chunk.tokens.offset(k) < token.range.offset) k++;
+			if (k < chunk.tokens.length() && chunk.tokens.offset(k) == token.range.offset) {
+				if (!tokens.append(chunk.tokens, k)) {
+					return false;
+				}
+				resume = chunk.next;
+				break;
+			}
+			if (token.kind != Token::Kind::COMMENT && !tokens.push(token)) {
+				return false;
+			}
+			if (token.eof()) {
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+Bool LineIndex::build(StringView data, Bool simd) noexcept {
+	m_lines.clear();
+	m_length = data.length();
+	if (!m_lines.push_back(0)) {
+		return false;
+	}
+	for (Ulen offset = 0; /**/; offset++) {
+		offset = simd ? find<true>(data, offset, '\n', '\n')
+		              : find<false>(data, offset, '\n', '\n');
+		if (offset == data.length()) {
+			return true;
+		}
+		if (!m_lines.push_back(offset + 1)) {
+			return false;
+		}
+	}
+}
+
+LineIndex::Location LineIndex::locate(Ulen offset) const noexcept {
+	// Find the last line which begins at or before |offset|.
+	Ulen lo = 0;
+	Ulen hi = m_lines.length();
+	while (hi - lo > 1) {
+		const auto mid = lo + (hi - lo) / 2;
+		if (m_lines[mid] <= offset) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return { lo + 1, offset - m_lines[lo] + 1 };
+}
+
+Range LineIndex::line(Ulen line) const noexcept {
+	const auto beg = m_lines[line - 1];
+	const auto end = line < m_lines.length() ? m_lines[line] - 1 : m_length;
+	return { beg, end - beg };
+}
+
+const LineIndex* Lexer::lines(Allocator& allocator) noexcept {
+	if (!m_lines) {
+		LineIndex lines{allocator};
+		if (!lines.build(m_data, m_simd)) {
+			return nullptr;
+		}
+		m_lines.emplace(move(lines));
+	}
+	return &*m_lines;
+}
+
+Token Lexer::read() noexcept {
+	return m_simd ? read<true>() : read<false>();
+}
+
+template<Bool SIMD>
 Token Lexer::read() noexcept {
 	using Kind = Token::Kind;
 	Ulen n = 0;
-	while (peek() != -1 && is_space(peek())) fwd(); // Skip whitespace
+	m_offset = skip_space<SIMD>(m_data, m_offset); // Skip whitespace
 	switch (peek()) {
 	case -1:  return {Kind::END,      {fwd(), 0}};
 	case '@': return {Kind::AT,       {fwd(), 1}};
@@ -87,6 +544,7 @@ Token Lexer::read() noexcept {
 	case '%': return {Kind::PERCENT,  {fwd(), 1}};
 	case '$': return {Kind::DOLLAR,   {fwd(), 1}};
 	case '?': return {Kind::QUESTION, {fwd(), 1}};
+	case '#': return {Kind::HASH,     {fwd(), 1}};
 	case '|':
 		n = fwd(); // Consume '|'
 		if (peek() == '|') {
@@ -159,9 +617,11 @@ Token Lexer::read() noexcept {
 		return {Kind::LIT_CHR, {n, m_offset - n}};
 	case '"':
 		n = fwd(); // Consume '"'
-		while (peek() != -1 && peek() != '"') {
-			if (peek() == '\\') fwd();
+		for (;;) {
+			m_offset = find<SIMD>(m_data, m_offset, '"', '\\');
+			if (peek() != '\\') break;
 			fwd(); // Consume '\'
+			fwd(); // Consume escaped character
 		}
 		fwd(); // Consume '"'
 		return {Kind::LIT_STR, {n, m_offset - n}};
@@ -170,7 +630,7 @@ Token Lexer::read() noexcept {
 		switch (peek()) {
 		case '/': // Single-line comment
 			fwd(); // Consume '/'
-			while (peek() != -1 && peek() != '\n') fwd();
+			m_offset = find<SIMD>(m_data, m_offset, '\n', '\n');
 			return {Kind::COMMENT, {n, m_offset - n}};
 		case '*': // Multi-line comment
 			fwd(); // Consume '*'
@@ -191,7 +651,8 @@ Token Lexer::read() noexcept {
 					}
 					break;
 				default:
-					fwd(); // Consume
+					// Skip ahead to the next character which can open or close
+					m_offset = find<SIMD>(m_data, m_offset, '/', '*');
 					break;
 				}
 			}
@@ -206,44 +667,9 @@ Token Lexer::read() noexcept {
 	default:
 		if (is_alpha(peek()) || peek() == '_') {
 			n = fwd();
-			while (peek() != -1 && (is_alnum(peek()) || peek() == '_')) fwd();
+			m_offset = skip_ident<SIMD>(m_data, m_offset);
 			Ulen l = m_offset - n;
-			StringView ident = m_data.slice(n, l);
-			switch (l) {
-			case 2:
-				/**/ if (ident == "fn")       return {Kind::KW_FN,       {n, 2}};
-				else if (ident == "if")       return {Kind::KW_IF,       {n, 2}};
-				else if (ident == "as")       return {Kind::KW_AS,       {n, 2}};
-				else if (ident == "of")       return {Kind::KW_OF,       {n, 2}};
-				else if (ident == "is")       return {Kind::KW_IS,       {n, 2}};
-				break;
-			case 3:
-				/**/ if (ident == "let")      return {Kind::KW_LET,      {n, 3}};
-				else if (ident == "new")      return {Kind::KW_NEW,      {n, 3}};
-				else if (ident == "for")      return {Kind::KW_FOR,      {n, 3}};
-				break;
-			case 4:
-				/**/ if (ident == "else")     return {Kind::KW_ELSE,     {n, 4}};
-				else if (ident == "type")     return {Kind::KW_TYPE,     {n, 4}};
-				else if (ident == "true")     return {Kind::KW_TRUE,     {n, 4}};
-				break;
-			case 5:
-				/**/ if (ident == "defer")    return {Kind::KW_DEFER,    {n, 5}};
-				else if (ident == "false")    return {Kind::KW_FALSE,    {n, 5}};
-				else if (ident == "break")    return {Kind::KW_BREAK,    {n, 5}};
-				else if (ident == "using")    return {Kind::KW_USING,    {n, 5}};
-				break;
-			case 6:
-				/**/ if (ident == "return")   return {Kind::KW_RETURN,   {n, 6}};
-				else if (ident == "effect")   return {Kind::KW_EFFECT,   {n, 6}};
-				else if (ident == "module")   return {Kind::KW_MODULE,   {n, 6}};
-				else if (ident == "import")   return {Kind::KW_IMPORT,   {n, 6}};
-				break;
-			case 8:
-				/**/ if (ident == "continue") return {Kind::KW_CONTINUE, {n, 8}};
-				break;
-			}
-			return {Kind::IDENT, {n, l}};
+			return {KEYWORD_TABLE.find(m_data.slice(n, l)), {n, l}};
 		} else if (is_digit(peek())) {
 			// The use of ' is allowed in the digit as a separator but never two
 			// separators next to each other and never the first character in a digit.
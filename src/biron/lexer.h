@@ -1,6 +1,7 @@
 #ifndef BIRON_LEXER_H
 #define BIRON_LEXER_H
 #include <biron/util/string.h>
+#include <biron/util/array.inl>
 #include <biron/util/numeric.inl>
 #include <biron/util/unreachable.inl>
 
@@ -82,14 +83,76 @@ struct Token {
 	Range range;
 };
 
+// The tokens of a whole source, without comments, as a structure of arrays so
+// the parser can index them. The last token is always END.
+struct Tokens {
+	constexpr Tokens(Allocator& allocator) noexcept
+		: m_kinds{allocator}
+		, m_offsets{allocator}
+		, m_lengths{allocator}
+	{
+	}
+	[[nodiscard]] Bool push(Token token) noexcept;
+	// Appends the tokens of |other| starting with the token at |index|.
+	[[nodiscard]] Bool append(const Tokens& other, Ulen index) noexcept;
+	void clear() noexcept {
+		m_kinds.clear();
+		m_offsets.clear();
+		m_lengths.clear();
+	}
+	[[nodiscard]] Token operator[](Ulen i) const noexcept {
+		return {m_kinds[i], {m_offsets[i], m_lengths[i]}};
+	}
+	[[nodiscard]] Ulen offset(Ulen i) const noexcept { return m_offsets[i]; }
+	[[nodiscard]] Ulen length() const noexcept { return m_kinds.length(); }
+	[[nodiscard]] Allocator& allocator() const noexcept { return m_kinds.allocator(); }
+private:
+	Array<Token::Kind> m_kinds;
+	Array<Uint32>      m_offsets;
+	Array<Uint32>      m_lengths;
+};
+
+// The offset of the beginning of every line of a source so the line and column
+// of any offset can be found with a binary search.
+struct LineIndex {
+	struct Location {
+		Ulen line;   // 1-based
+		Ulen column; // 1-based
+	};
+	constexpr LineIndex(Allocator& allocator) noexcept
+		: m_lines{allocator}
+		, m_length{0}
+	{
+	}
+	[[nodiscard]] Bool build(StringView data, Bool simd) noexcept;
+	[[nodiscard]] Location locate(Ulen offset) const noexcept;
+	// The range of the 1-based |line| excluding the newline.
+	[[nodiscard]] Range line(Ulen line) const noexcept;
+private:
+	Array<Ulen> m_lines;
+	Ulen        m_length;
+};
+
+struct System;
+
 struct Lexer {
-	constexpr Lexer(StringView name, StringView data) noexcept
+	// The SIMD fast paths can be disabled to compare against the scalar code, the
+	// tokens are the same either way.
+	constexpr Lexer(StringView name, StringView data, Bool simd = true) noexcept
 		: m_name{name}
 		, m_data{data}
 		, m_offset{0}
+		, m_simd{simd}
 	{
 	}
 	Token next() noexcept;
+	// The token |n| ahead, so ahead(1) is what next() returns, without consuming
+	// any.
+	Token ahead(Ulen n) noexcept;
+	// Lexes the whole source into |tokens|. Large sources are split into chunks
+	// which are lexed on threads when given a |system|. The result is the same
+	// tokens next() would produce.
+	[[nodiscard]] Bool tokenize(Tokens& tokens, const System* system) noexcept;
 	constexpr StringView string(Range range) noexcept {
 		return m_data.slice(range.offset, range.length);
 	}
@@ -102,7 +165,14 @@ struct Lexer {
 	constexpr StringView data() const noexcept {
 		return m_data;
 	}
+	// The line index is built from |allocator| on first use. Returns nullptr when
+	// out of memory.
+	const LineIndex* lines(Allocator& allocator) noexcept;
 private:
+	friend struct LexChunk;
+	Token read() noexcept;
+	Bool lex(Tokens& tokens, Ulen end, Ulen& first, Ulen& next) noexcept;
+	template<Bool SIMD>
 	Token read() noexcept;
 	Ulen fwd() noexcept { return m_offset++; }
 	int peek() noexcept {
@@ -111,6 +181,8 @@ private:
 	StringView m_name;
 	StringView m_data;
 	Ulen m_offset;
+	Bool m_simd;
+	Maybe<LineIndex> m_lines;
 };
 
 } // namespace Biron
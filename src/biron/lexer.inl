@@ -2,6 +2,11 @@
 #define KIND(...)
 #endif
 
+// Keywords are also token kinds. Defining KEYWORD gives access to the spelling.
+#ifndef KEYWORD
+#define KEYWORD(NAME, SPELLING) KIND(NAME)
+#endif
+
 KIND(END)
 KIND(AT)          // '@'
 KIND(COMMA)       // ','
@@ -21,6 +26,7 @@ KIND(PERCENT)     // '%'
 KIND(NOT)         // '!'
 KIND(DOLLAR)      // '$'
 KIND(QUESTION)    // '?'
+KIND(HASH)        // '#'
 KIND(BOR)         // '|'
 KIND(LOR)         // '||'
 KIND(BAND)        // '&'
@@ -46,27 +52,27 @@ KIND(MINUSEQ)     // '-='
 KIND(STAREQ)      // '*='
 KIND(FSLASHEQ)    // '/='
 
-KIND(KW_TRUE)     // true
-KIND(KW_FALSE)    // false
+KEYWORD(KW_TRUE,     "true")
+KEYWORD(KW_FALSE,    "false")
 
-KIND(KW_FN)       // 'fn'
-KIND(KW_IF)       // 'if'
-KIND(KW_AS)       // 'as'
-KIND(KW_OF)       // 'of'
-KIND(KW_IS)       // 'is'
-KIND(KW_LET)      // 'let'
-KIND(KW_NEW)      // 'new'
-KIND(KW_FOR)      // 'for'
-KIND(KW_ELSE)     // 'else'
-KIND(KW_TYPE)     // 'type'
-KIND(KW_DEFER)    // 'defer'
-KIND(KW_BREAK)    // 'break'
-KIND(KW_USING)    // 'using'
-KIND(KW_RETURN)   // 'return'
-KIND(KW_EFFECT)   // 'effect'
-KIND(KW_MODULE)   // 'module'
-KIND(KW_IMPORT)   // 'import'
-KIND(KW_CONTINUE) // 'continue'
+KEYWORD(KW_FN,       "fn")
+KEYWORD(KW_IF,       "if")
+KEYWORD(KW_AS,       "as")
+KEYWORD(KW_OF,       "of")
+KEYWORD(KW_IS,       "is")
+KEYWORD(KW_LET,      "let")
+KEYWORD(KW_NEW,      "new")
+KEYWORD(KW_FOR,      "for")
+KEYWORD(KW_ELSE,     "else")
+KEYWORD(KW_TYPE,     "type")
+KEYWORD(KW_DEFER,    "defer")
+KEYWORD(KW_BREAK,    "break")
+KEYWORD(KW_USING,    "using")
+KEYWORD(KW_RETURN,   "return")
+KEYWORD(KW_EFFECT,   "effect")
+KEYWORD(KW_MODULE,   "module")
+KEYWORD(KW_IMPORT,   "import")
+KEYWORD(KW_CONTINUE, "continue")
 
 // DecDigit
 //  ::= '0' | '1' | '2' | '3' | '4' | '5' | '6' | '7' | '8' | '9'
@@ -97,4 +103,6 @@ KIND(LIT_CHR)
 
 KIND(COMMENT)     // '//' or '/**/'
 
-KIND(UNKNOWN)
\ No newline at end of file
+KIND(UNKNOWN)
+
+#undef KEYWORD
\ No newline at end of file
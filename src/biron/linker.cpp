@@ -0,0 +1,895 @@
+#include <biron/linker.h>
+
+#include <biron/util/file.h>
+#include <biron/util/terminal.inl>
+
+namespace Biron {
+
+// The subset of ELF64 needed to read x86-64 relocatable objects and to write
+// position independent executables.
+namespace Elf {
+	struct Ehdr {
+		Uint8  ident[16];
+		Uint16 type;
+		Uint16 machine;
+		Uint32 version;
+		Uint64 entry;
+		Uint64 phoff;
+		Uint64 shoff;
+		Uint32 flags;
+		Uint16 ehsize;
+		Uint16 phentsize;
+		Uint16 phnum;
+		Uint16 shentsize;
+		Uint16 shnum;
+		Uint16 shstrndx;
+	};
+	struct Shdr {
+		Uint32 name;
+		Uint32 type;
+		Uint64 flags;
+		Uint64 addr;
+		Uint64 offset;
+		Uint64 size;
+		Uint32 link;
+		Uint32 info;
+		Uint64 addralign;
+		Uint64 entsize;
+	};
+	struct Phdr {
+		Uint32 type;
+		Uint32 flags;
+		Uint64 offset;
+		Uint64 vaddr;
+		Uint64 paddr;
+		Uint64 filesz;
+		Uint64 memsz;
+		Uint64 align;
+	};
+	struct Sym {
+		Uint32 name;
+		Uint8  info;
+		Uint8  other;
+		Uint16 shndx;
+		Uint64 value;
+		Uint64 size;
+	};
+	struct Rela {
+		Uint64 offset;
+		Uint64 info;
+		Sint64 addend;
+	};
+	struct Dyn {
+		Sint64 tag;
+		Uint64 val;
+	};
+
+	static_assert(sizeof(Ehdr) == 64);
+	static_assert(sizeof(Shdr) == 64);
+	static_assert(sizeof(Phdr) == 56);
+	static_assert(sizeof(Sym) == 24);
+	static_assert(sizeof(Rela) == 24);
+	static_assert(sizeof(Dyn) == 16);
+
+	static inline constexpr const Uint8  ELFCLASS64       = 2;
+	static inline constexpr const Uint8  ELFDATA2LSB      = 1;
+	static inline constexpr const Uint8  EV_CURRENT       = 1;
+	static inline constexpr const Uint16 ET_REL           = 1;
+	static inline constexpr const Uint16 ET_DYN           = 3;
+	static inline constexpr const Uint16 EM_X86_64        = 62;
+
+	static inline constexpr const Uint32 SHT_NULL         = 0;
+	static inline constexpr const Uint32 SHT_PROGBITS     = 1;
+	static inline constexpr const Uint32 SHT_SYMTAB       = 2;
+	static inline constexpr const Uint32 SHT_STRTAB       = 3;
+	static inline constexpr const Uint32 SHT_RELA         = 4;
+	static inline constexpr const Uint32 SHT_DYNAMIC      = 6;
+	static inline constexpr const Uint32 SHT_NOBITS       = 8;
+	static inline constexpr const Uint32 SHT_REL          = 9;
+
+	static inline constexpr const Uint64 SHF_WRITE        = 0x1;
+	static inline constexpr const Uint64 SHF_ALLOC        = 0x2;
+	static inline constexpr const Uint64 SHF_EXECINSTR    = 0x4;
+	static inline constexpr const Uint64 SHF_TLS          = 0x400;
+
+	static inline constexpr const Uint16 SHN_UNDEF        = 0;
+	static inline constexpr const Uint16 SHN_LORESERVE    = 0xff00;
+	static inline constexpr const Uint16 SHN_ABS          = 0xfff1;
+	static inline constexpr const Uint16 SHN_COMMON       = 0xfff2;
+	static inline constexpr const Uint16 SHN_XINDEX       = 0xffff;
+
+	static inline constexpr const Uint8  STB_LOCAL        = 0;
+	static inline constexpr const Uint8  STB_GLOBAL       = 1;
+	static inline constexpr const Uint8  STB_WEAK         = 2;
+	static inline constexpr const Uint8  STT_TLS          = 6;
+
+	static inline constexpr const Uint32 PT_LOAD          = 1;
+	static inline constexpr const Uint32 PT_DYNAMIC       = 2;
+	static inline constexpr const Uint32 PT_PHDR          = 6;
+	static inline constexpr const Uint32 PF_X             = 0x1;
+	static inline constexpr const Uint32 PF_W             = 0x2;
+	static inline constexpr const Uint32 PF_R             = 0x4;
+
+	static inline constexpr const Sint64 DT_NULL          = 0;
+	static inline constexpr const Sint64 DT_RELA          = 7;
+	static inline constexpr const Sint64 DT_RELASZ        = 8;
+	static inline constexpr const Sint64 DT_RELAENT       = 9;
+	static inline constexpr const Sint64 DT_RELACOUNT     = 0x6ffffff9;
+	static inline constexpr const Sint64 DT_FLAGS_1       = 0x6ffffffb;
+	static inline constexpr const Uint64 DF_1_PIE         = 0x08000000;
+
+	static inline constexpr const Uint32 R_X86_64_NONE          = 0;
+	static inline constexpr const Uint32 R_X86_64_64            = 1;
+	static inline constexpr const Uint32 R_X86_64_PC32          = 2;
+	static inline constexpr const Uint32 R_X86_64_PLT32         = 4;
+	static inline constexpr const Uint32 R_X86_64_RELATIVE      = 8;
+	static inline constexpr const Uint32 R_X86_64_GOTPCREL      = 9;
+	static inline constexpr const Uint32 R_X86_64_32            = 10;
+	static inline constexpr const Uint32 R_X86_64_32S           = 11;
+	static inline constexpr const Uint32 R_X86_64_PC64          = 24;
+	static inline constexpr const Uint32 R_X86_64_GOTPCRELX     = 41;
+	static inline constexpr const Uint32 R_X86_64_REX_GOTPCRELX = 42;
+} // namespace Elf
+
+// Number of program headers and .dynamic entries we write.
+static inline constexpr const Ulen PHDRS = 5;
+static inline constexpr const Ulen DYNS = 6;
+
+// Output section indices in the section header table.
+enum : Uint16 {
+	SEC_NULL,
+	SEC_TEXT,
+	SEC_RODATA,
+	SEC_RELA_DYN,
+	SEC_DATA,
+	SEC_GOT,
+	SEC_DYNAMIC,
+	SEC_BSS,
+	SEC_SYMTAB,
+	SEC_STRTAB,
+	SEC_SHSTRTAB,
+	SEC_COUNT,
+};
+
+// Objects are not necessarily aligned for their contents so everything is read
+// and written a byte at a time.
+template<typename T>
+static Bool read(const Array<Uint8>& data, Uint64 offset, T& value) noexcept {
+	if (offset > data.length() || data.length() - offset < sizeof(T)) {
+		return false;
+	}
+	auto src = data.data() + offset;
+	auto dst = reinterpret_cast<Uint8*>(&value);
+	for (Ulen i = 0; i < sizeof(T); i++) {
+		dst[i] = src[i];
+	}
+	return true;
+}
+
+template<typename T>
+static void write(Array<Uint8>& data, Uint64 offset, const T& value) noexcept {
+	BIRON_ASSERT(offset + sizeof(T) <= data.length());
+	auto src = reinterpret_cast<const Uint8*>(&value);
+	auto dst = data.data() + offset;
+	for (Ulen i = 0; i < sizeof(T); i++) {
+		dst[i] = src[i];
+	}
+}
+
+static Bool append(Array<Uint8>& data, const void* src, Ulen length) noexcept {
+	const auto offset = data.length();
+	if (!data.resize(offset + length)) {
+		return false;
+	}
+	auto bytes = reinterpret_cast<const Uint8*>(src);
+	for (Ulen i = 0; i < length; i++) {
+		data[offset + i] = bytes[i];
+	}
+	return true;
+}
+
+// Appends a NUL terminated string to a string table and returns the offset.
+static Maybe<Uint32> append(Array<Uint8>& strtab, StringView string) noexcept {
+	const auto offset = strtab.length();
+	if (!append(strtab, string.data(), string.length()) || !strtab.push_back(0)) {
+		return None{};
+	}
+	return Uint32(offset);
+}
+
+static Maybe<StringView> string(const Array<Uint8>& data, const Elf::Shdr& strtab, Uint32 offset) noexcept {
+	if (offset >= strtab.size) {
+		return None{};
+	}
+	auto beg = reinterpret_cast<const char*>(data.data() + strtab.offset + offset);
+	auto end = reinterpret_cast<const char*>(data.data() + strtab.offset + strtab.size);
+	for (auto ch = beg; ch < end; ch++) {
+		if (*ch == '\0') {
+			return StringView { beg, Ulen(ch - beg) };
+		}
+	}
+	return None{};
+}
+
+static constexpr Uint64 align(Uint64 value, Uint64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Matches "name" as well as "name.*"
+static Bool matches(StringView name, StringView prefix) noexcept {
+	return name.starts_with(prefix)
+		&& (name.length() == prefix.length() || name[prefix.length()] == '.');
+}
+
+template<typename... Ts>
+Bool Linker::error(StringView fmt, Ts&&... args) noexcept {
+	m_terminal.err("Linker: ");
+	m_terminal.err(fmt, forward<Ts>(args)...);
+	m_terminal.err("\n");
+	return false;
+}
+
+Bool Linker::add(StringView name, const Array<Uint8>& object) noexcept {
+	return m_objects.emplace_back(name, object, m_allocator);
+}
+
+Bool Linker::parse(Ulen index) noexcept {
+	auto& object = m_objects[index];
+	const auto& data = object.data;
+
+	Elf::Ehdr ehdr;
+	if (!read(data, 0, ehdr) || ehdr.ident[0] != 0x7f || ehdr.ident[1] != 'E'
+	                         || ehdr.ident[2] != 'L'  || ehdr.ident[3] != 'F')
+	{
+		return error("%S: Not an ELF file", object.name);
+	}
+	if (ehdr.ident[4] != Elf::ELFCLASS64 || ehdr.ident[5] != Elf::ELFDATA2LSB || ehdr.machine != Elf::EM_X86_64) {
+		return error("%S: Not an x86-64 ELF file", object.name);
+	}
+	if (ehdr.type != Elf::ET_REL) {
+		return error("%S: Not a relocatable object", object.name);
+	}
+	if (ehdr.shentsize != sizeof(Elf::Shdr)) {
+		return error("%S: Malformed section header table", object.name);
+	}
+
+	// Large section counts and the index of the section name table are stored in
+	// the first section header instead.
+	Ulen shnum = ehdr.shnum;
+	Ulen shstrndx = ehdr.shstrndx;
+	if (ehdr.shoff && (shnum == 0 || shstrndx == Elf::SHN_XINDEX)) {
+		Elf::Shdr shdr;
+		if (!read(data, ehdr.shoff, shdr)) {
+			return error("%S: Malformed section header table", object.name);
+		}
+		if (shnum == 0) shnum = shdr.size;
+		if (shstrndx == Elf::SHN_XINDEX) shstrndx = shdr.link;
+	}
+
+	Array<Elf::Shdr> shdrs{m_allocator};
+	if (!shdrs.resize(shnum) || !object.sections.resize(shnum) || !object.inputs.resize(shnum)) {
+		return error("Out of memory");
+	}
+	for (Ulen i = 0; i < shnum; i++) {
+		auto& shdr = shdrs[i];
+		if (!read(data, ehdr.shoff + i * sizeof(Elf::Shdr), shdr)) {
+			return error("%S: Malformed section header table", object.name);
+		}
+		if (shdr.type != Elf::SHT_NOBITS && (shdr.offset > data.length() || data.length() - shdr.offset < shdr.size)) {
+			return error("%S: Section %zu is out of bounds", object.name, i);
+		}
+		if (shdr.addralign & (shdr.addralign - 1)) {
+			return error("%S: Section %zu has invalid alignment", object.name, i);
+		}
+	}
+	if (shstrndx >= shnum) {
+		return error("%S: Malformed section name table", object.name);
+	}
+
+	for (Ulen i = 0; i < shnum; i++) {
+		const auto& shdr = shdrs[i];
+		auto name = string(data, shdrs[shstrndx], shdr.name);
+		if (!name) {
+			return error("%S: Malformed section name", object.name);
+		}
+		object.sections[i] = Section {
+			*name,
+			shdr.type,
+			shdr.flags,
+			shdr.offset,
+			shdr.size,
+			shdr.link,
+			shdr.info,
+			shdr.addralign ? shdr.addralign : 1,
+			shdr.entsize
+		};
+		object.inputs[i] = NONE;
+		if (i == 0 || !(shdr.flags & Elf::SHF_ALLOC)) {
+			continue;
+		}
+		if (shdr.flags & Elf::SHF_TLS) {
+			return error("%S: Thread local section '%S' is not supported", object.name, *name);
+		}
+		// Place sections the same way as titan/link.ld does. Anything it does not
+		// mention is placed by its flags.
+		Out out;
+		if (matches(*name, ".eh_frame") || matches(*name, ".note") || *name == ".interp") {
+			out = Out::DISCARD;
+		} else if (*name == ".requests_beg_marker") {
+			out = Out::REQUESTS_BEG;
+		} else if (*name == ".requests_end_marker") {
+			out = Out::REQUESTS_END;
+		} else if (*name == ".requests") {
+			out = Out::REQUESTS;
+		} else if (matches(*name, ".text")) {
+			out = Out::TEXT;
+		} else if (matches(*name, ".rodata")) {
+			out = Out::RODATA;
+		} else if (matches(*name, ".data")) {
+			out = Out::DATA;
+		} else if (matches(*name, ".bss") || shdr.type == Elf::SHT_NOBITS) {
+			out = Out::BSS;
+		} else if (shdr.flags & Elf::SHF_EXECINSTR) {
+			out = Out::TEXT;
+		} else if (shdr.flags & Elf::SHF_WRITE) {
+			out = Out::DATA;
+		} else {
+			out = Out::RODATA;
+		}
+		if (out == Out::DISCARD) {
+			continue;
+		}
+		object.inputs[i] = m_inputs.length();
+		if (!m_inputs.emplace_back(index, i, out, shdr.size, object.sections[i].align, 0_u64)) {
+			return error("Out of memory");
+		}
+	}
+
+	// Read the symbol table.
+	for (Ulen i = 0; i < shnum; i++) {
+		const auto& shdr = shdrs[i];
+		if (shdr.type != Elf::SHT_SYMTAB) {
+			continue;
+		}
+		if (shdr.entsize != sizeof(Elf::Sym) || shdr.link >= shnum) {
+			return error("%S: Malformed symbol table", object.name);
+		}
+		const auto count = shdr.size / sizeof(Elf::Sym);
+		if (!object.symbols.resize(count) || !object.globals.resize(count)) {
+			return error("Out of memory");
+		}
+		for (Ulen j = 0; j < count; j++) {
+			Elf::Sym sym;
+			if (!read(data, shdr.offset + j * sizeof(Elf::Sym), sym)) {
+				return error("%S: Malformed symbol table", object.name);
+			}
+			auto name = string(data, shdrs[shdr.link], sym.name);
+			if (!name) {
+				return error("%S: Malformed symbol name", object.name);
+			}
+			if (sym.shndx == Elf::SHN_XINDEX) {
+				return error("%S: Extended section indices are not supported", object.name);
+			}
+			if (sym.shndx >= shnum && sym.shndx != Elf::SHN_ABS && sym.shndx != Elf::SHN_COMMON) {
+				return error("%S: Symbol '%S' has invalid section index", object.name, *name);
+			}
+			object.symbols[j] = Symbol { *name, sym.info, sym.shndx, sym.value, sym.size };
+			object.globals[j] = NONE;
+		}
+		break;
+	}
+
+	return true;
+}
+
+Bool Linker::resolve(Ulen index) noexcept {
+	auto& object = m_objects[index];
+	for (Ulen i = 1; i < object.symbols.length(); i++) {
+		const auto& symbol = object.symbols[i];
+		const auto bind = symbol.info >> 4;
+		if (bind == Elf::STB_LOCAL) {
+			continue;
+		}
+		if (bind != Elf::STB_GLOBAL && bind != Elf::STB_WEAK) {
+			return error("%S: Symbol '%S' has unsupported binding", object.name, symbol.name);
+		}
+		if ((symbol.info & 0xf) == Elf::STT_TLS) {
+			return error("%S: Thread local symbol '%S' is not supported", object.name, symbol.name);
+		}
+		const Bool weak = bind == Elf::STB_WEAK;
+
+		Ulen g = m_globals.length();
+		if (auto find = m_global_names.find(symbol.name)) {
+			g = *find;
+		} else {
+			if (!m_globals.emplace_back(symbol.name, NONE, 0_ulen, weak, false, false, 0_u64)) {
+				return error("Out of memory");
+			}
+			if (!m_global_names.insert(symbol.name, g)) {
+				return error("Out of memory");
+			}
+		}
+		object.globals[i] = g;
+
+		auto& global = m_globals[g];
+		auto take = [&](Bool common) {
+			global.object = index;
+			global.symbol = i;
+			global.weak = weak;
+			global.common = common;
+		};
+		if (symbol.shndx == Elf::SHN_UNDEF) {
+			if (global.object == NONE && !weak) {
+				// A single strong reference makes the symbol required.
+				global.weak = false;
+			}
+		} else if (symbol.shndx == Elf::SHN_COMMON) {
+			if (global.object == NONE) {
+				take(true);
+			} else if (global.common) {
+				const auto& other = m_objects[global.object].symbols[global.symbol];
+				if (symbol.size > other.size) {
+					take(true);
+				}
+			}
+		} else if (global.object == NONE || global.common || (global.weak && !weak)) {
+			take(false);
+		} else if (!global.weak && !weak) {
+			return error("Duplicate symbol '%S' defined in '%S' and '%S'",
+			             symbol.name,
+			             m_objects[global.object].name,
+			             object.name);
+		}
+	}
+	return true;
+}
+
+Linker::Kind Linker::symbol(Ulen object, Ulen symbol, Uint64& value) const noexcept {
+	value = 0;
+	if (const auto g = m_objects[object].globals[symbol]; g != NONE) {
+		const auto& global = m_globals[g];
+		if (global.linker) {
+			value = global.addr;
+			return Kind::LINKER;
+		}
+		if (global.object == NONE) {
+			return global.weak ? Kind::UNDEF_WEAK : Kind::UNDEF;
+		}
+		if (global.common) {
+			value = global.addr;
+			return Kind::COMMON;
+		}
+		object = global.object;
+		symbol = global.symbol;
+	}
+	const auto& sym = m_objects[object].symbols[symbol];
+	if (sym.shndx == Elf::SHN_UNDEF) {
+		// Only the null symbol is local and undefined.
+		return Kind::ABSOLUTE;
+	}
+	if (sym.shndx == Elf::SHN_ABS) {
+		value = sym.value;
+		return Kind::ABSOLUTE;
+	}
+	const auto input = m_objects[object].inputs[sym.shndx];
+	if (input == NONE) {
+		return Kind::DISCARDED;
+	}
+	value = m_inputs[input].addr + sym.value;
+	return Kind::SECTION;
+}
+
+Uint64 Linker::got_key(Ulen object, Ulen symbol) const noexcept {
+	// Globals share an entry, locals get one per object.
+	if (const auto g = m_objects[object].globals[symbol]; g != NONE) {
+		return g;
+	}
+	return (1_u64 << 63) | (Uint64(object) << 32) | symbol;
+}
+
+Maybe<Ulen> Linker::got_index(Ulen object, Ulen symbol) const noexcept {
+	if (auto find = m_got_keys.find(got_key(object, symbol))) {
+		return *find;
+	}
+	return None{};
+}
+
+static Bool is_got(Uint32 type) noexcept {
+	return type == Elf::R_X86_64_GOTPCREL
+	    || type == Elf::R_X86_64_GOTPCRELX
+	    || type == Elf::R_X86_64_REX_GOTPCRELX;
+}
+
+Bool Linker::scan(Ulen& relative) noexcept {
+	relative = 0;
+	for (Ulen o = 0; o < m_objects.length(); o++) {
+		const auto& object = m_objects[o];
+		for (const auto& section : object.sections) {
+			if (section.type == Elf::SHT_REL) {
+				return error("%S: REL relocations are not supported", object.name);
+			}
+			if (section.type != Elf::SHT_RELA) {
+				continue;
+			}
+			if (section.info >= object.sections.length() || section.entsize != sizeof(Elf::Rela)) {
+				return error("%S: Malformed relocation section '%S'", object.name, section.name);
+			}
+			if (object.inputs[section.info] == NONE) {
+				continue;
+			}
+			for (Ulen i = 0; i < section.size / sizeof(Elf::Rela); i++) {
+				Elf::Rela rela;
+				if (!read(object.data, section.offset + i * sizeof(Elf::Rela), rela)) {
+					return error("%S: Malformed relocation section '%S'", object.name, section.name);
+				}
+				const Ulen sym = rela.info >> 32;
+				const Uint32 type = rela.info & 0xffffffff;
+				if (sym >= object.symbols.length()) {
+					return error("%S: Relocation with invalid symbol index", object.name);
+				}
+				if (type == Elf::R_X86_64_64) {
+					relative++;
+				} else if (is_got(type) && !got_index(o, sym)) {
+					const auto key = got_key(o, sym);
+					if (!m_got_keys.insert(key, m_got.length())) {
+						return error("Out of memory");
+					}
+					if (!m_got.emplace_back(key, o, sym)) {
+						return error("Out of memory");
+					}
+				}
+			}
+		}
+	}
+	// Every entry in the GOT may need a relocation too.
+	relative += m_got.length();
+	return true;
+}
+
+Bool Linker::relocate(Array<Uint8>& image, Array<Uint8>& rela_dyn, Uint64 got) noexcept {
+	auto relative = [&](Uint64 where, Uint64 value) {
+		const Elf::Rela rela{where, Elf::R_X86_64_RELATIVE, Sint64(value)};
+		return append(rela_dyn, &rela, sizeof rela);
+	};
+	auto fits = [](Sint64 value) {
+		return value >= -0x80000000_s64 && value <= 0x7fffffff_s64;
+	};
+
+	for (Ulen o = 0; o < m_objects.length(); o++) {
+		const auto& object = m_objects[o];
+		for (const auto& section : object.sections) {
+			if (section.type != Elf::SHT_RELA || object.inputs[section.info] == NONE) {
+				continue;
+			}
+			const auto& input = m_inputs[object.inputs[section.info]];
+			if (input.out == Out::BSS) {
+				return error("%S: Relocations against '%S' are not supported", object.name, object.sections[section.info].name);
+			}
+			for (Ulen i = 0; i < section.size / sizeof(Elf::Rela); i++) {
+				Elf::Rela rela;
+				(void)read(object.data, section.offset + i * sizeof(Elf::Rela), rela);
+				const Ulen sym = rela.info >> 32;
+				const Uint32 type = rela.info & 0xffffffff;
+				const auto& name = object.symbols[sym].name;
+				const Ulen width = type == Elf::R_X86_64_64 || type == Elf::R_X86_64_PC64 ? 8 : 4;
+				if (rela.offset > input.size || input.size - rela.offset < width) {
+					return error("%S: Relocation out of bounds in '%S'", object.name, section.name);
+				}
+				Uint64 S = 0;
+				const auto kind = symbol(o, sym, S);
+				if (kind == Kind::UNDEF) {
+					return error("%S: Undefined symbol '%S'", object.name, name);
+				} else if (kind == Kind::DISCARDED) {
+					return error("%S: Reference to '%S' in a discarded section", object.name, name);
+				}
+				const Sint64 A = rela.addend;
+				const Uint64 P = input.addr + rela.offset;
+				const Uint64 offset = P - BASE;
+				switch (type) {
+				case Elf::R_X86_64_NONE:
+					break;
+				case Elf::R_X86_64_64:
+					write(image, offset, Uint64(S + A));
+					if (kind != Kind::ABSOLUTE && kind != Kind::UNDEF_WEAK && !relative(P, S + A)) {
+						return error("Out of memory");
+					}
+					break;
+				case Elf::R_X86_64_PC64:
+					write(image, offset, Uint64(S + A - P));
+					break;
+				case Elf::R_X86_64_PC32:
+				case Elf::R_X86_64_PLT32:
+					if (const auto value = Sint64(S + A - P); fits(value)) {
+						write(image, offset, Sint32(value));
+					} else {
+						return error("%S: Relocation against '%S' out of range", object.name, name);
+					}
+					break;
+				case Elf::R_X86_64_GOTPCREL:
+				case Elf::R_X86_64_GOTPCRELX:
+				case Elf::R_X86_64_REX_GOTPCRELX:
+					if (const auto value = Sint64(got + *got_index(o, sym) * 8 + A - P); fits(value)) {
+						write(image, offset, Sint32(value));
+					} else {
+						return error("%S: Relocation against '%S' out of range", object.name, name);
+					}
+					break;
+				case Elf::R_X86_64_32:
+				case Elf::R_X86_64_32S:
+					return error("%S: Absolute 32-bit relocation against '%S' cannot be used when making a PIE", object.name, name);
+				default:
+					return error("%S: Unsupported relocation type %u against '%S'", object.name, type, name);
+				}
+			}
+		}
+	}
+
+	// Fill in the GOT.
+	for (Ulen i = 0; i < m_got.length(); i++) {
+		Uint64 S = 0;
+		const auto& entry = m_got[i];
+		const auto kind = symbol(entry.object, entry.symbol, S);
+		const auto where = got + i * 8;
+		write(image, where - BASE, S);
+		if (kind != Kind::ABSOLUTE && kind != Kind::UNDEF_WEAK && !relative(where, S)) {
+			return error("Out of memory");
+		}
+	}
+
+	return true;
+}
+
+Bool Linker::link(StringView output, StringView entry) noexcept {
+	for (Ulen i = 0; i < m_objects.length(); i++) {
+		if (!parse(i)) {
+			return false;
+		}
+	}
+	for (Ulen i = 0; i < m_objects.length(); i++) {
+		if (!resolve(i)) {
+			return false;
+		}
+	}
+	for (auto& global : m_globals) {
+		if (global.object != NONE) {
+			continue;
+		}
+		if (global.name == "_GLOBAL_OFFSET_TABLE_" || global.name == "_DYNAMIC") {
+			global.linker = true;
+		} else if (!global.weak) {
+			return error("Undefined symbol '%S'", global.name);
+		}
+	}
+	Ulen relative = 0;
+	if (!scan(relative)) {
+		return false;
+	}
+
+	// Layout
+	Uint64 addr = BASE + sizeof(Elf::Ehdr) + PHDRS * sizeof(Elf::Phdr);
+	auto place = [&](Out out) {
+		for (auto& input : m_inputs) {
+			if (input.out == out) {
+				addr = align(addr, input.align);
+				input.addr = addr;
+				addr += input.size;
+			}
+		}
+	};
+
+	const auto text_beg = addr;
+	place(Out::TEXT);
+	const auto text_end = addr;
+
+	addr = align(addr, PAGE);
+	const auto rodata_beg = addr;
+	place(Out::RODATA);
+	addr = align(addr, 8);
+	const auto rela_beg = addr;
+	addr += relative * sizeof(Elf::Rela);
+	const auto rodata_end = addr;
+
+	addr = align(addr, PAGE);
+	const auto data_beg = addr;
+	place(Out::DATA);
+	place(Out::REQUESTS_BEG);
+	place(Out::REQUESTS);
+	place(Out::REQUESTS_END);
+	addr = align(addr, 8);
+	const auto got_beg = addr;
+	addr += m_got.length() * 8;
+	const auto dynamic_beg = addr;
+	addr += DYNS * sizeof(Elf::Dyn);
+	const auto data_end = addr;
+
+	place(Out::BSS);
+	for (auto& global : m_globals) {
+		if (global.common) {
+			// The value of a common symbol is its alignment.
+			const auto& sym = m_objects[global.object].symbols[global.symbol];
+			addr = align(addr, sym.value ? sym.value : 1);
+			global.addr = addr;
+			addr += sym.size;
+		}
+	}
+	const auto bss_end = addr;
+
+	for (auto& global : m_globals) {
+		if (global.linker) {
+			global.addr = global.name == "_DYNAMIC" ? dynamic_beg : got_beg;
+		}
+	}
+
+	// Contents
+	Array<Uint8> image{m_allocator};
+	Array<Uint8> rela_dyn{m_allocator};
+	if (!image.resize(data_end - BASE)) {
+		return error("Out of memory");
+	}
+	for (const auto& input : m_inputs) {
+		const auto& section = m_objects[input.object].sections[input.section];
+		if (input.out == Out::BSS || section.type == Elf::SHT_NOBITS) {
+			continue;
+		}
+		const auto src = m_objects[input.object].data.data() + section.offset;
+		const auto dst = image.data() + (input.addr - BASE);
+		for (Ulen i = 0; i < section.size; i++) {
+			dst[i] = src[i];
+		}
+	}
+	if (!relocate(image, rela_dyn, got_beg)) {
+		return false;
+	}
+	for (Ulen i = 0; i < rela_dyn.length(); i++) {
+		image[rela_beg - BASE + i] = rela_dyn[i];
+	}
+	const auto relas = rela_dyn.length() / sizeof(Elf::Rela);
+
+	const Elf::Dyn dyns[DYNS] = {
+		{ Elf::DT_RELA,      rela_beg },
+		{ Elf::DT_RELASZ,    relas * sizeof(Elf::Rela) },
+		{ Elf::DT_RELAENT,   sizeof(Elf::Rela) },
+		{ Elf::DT_RELACOUNT, relas },
+		{ Elf::DT_FLAGS_1,   Elf::DF_1_PIE },
+		{ Elf::DT_NULL,      0 },
+	};
+	for (Ulen i = 0; i < DYNS; i++) {
+		write(image, dynamic_beg - BASE + i * sizeof(Elf::Dyn), dyns[i]);
+	}
+
+	// Find the entry point.
+	Uint64 entry_addr = 0;
+	const auto g = m_global_names.find(entry);
+	if (!g || m_globals[*g].object == NONE || symbol(m_globals[*g].object, m_globals[*g].symbol, entry_addr) != Kind::SECTION) {
+		return error("Undefined entry point '%S'", entry);
+	}
+
+	// Symbol table of all defined globals.
+	Array<Uint8> symtab{m_allocator};
+	Array<Uint8> strtab{m_allocator};
+	if (!symtab.resize(sizeof(Elf::Sym)) || !strtab.push_back(0)) {
+		return error("Out of memory");
+	}
+	for (const auto& global : m_globals) {
+		if (global.object == NONE) {
+			continue;
+		}
+		const auto& sym = m_objects[global.object].symbols[global.symbol];
+		Uint64 value = 0;
+		Uint16 shndx = Elf::SHN_ABS;
+		switch (symbol(global.object, global.symbol, value)) {
+		case Kind::COMMON:
+			shndx = SEC_BSS;
+			break;
+		case Kind::SECTION:
+			switch (m_inputs[m_objects[global.object].inputs[sym.shndx]].out) {
+			case Out::TEXT:   shndx = SEC_TEXT;   break;
+			case Out::RODATA: shndx = SEC_RODATA; break;
+			case Out::BSS:    shndx = SEC_BSS;    break;
+			default:          shndx = SEC_DATA;   break;
+			}
+			break;
+		case Kind::DISCARDED:
+			continue;
+		default:
+			break;
+		}
+		auto name = append(strtab, global.name);
+		if (!name) {
+			return error("Out of memory");
+		}
+		const Elf::Sym out{*name, sym.info, 0, shndx, value, sym.size};
+		if (!append(symtab, &out, sizeof out)) {
+			return error("Out of memory");
+		}
+	}
+
+	// Section names are written in the same order as the SEC_ enumerators.
+	static constexpr const StringView NAMES[] = {
+		"", ".text", ".rodata", ".rela.dyn", ".data", ".got", ".dynamic", ".bss",
+		".symtab", ".strtab", ".shstrtab"
+	};
+	static_assert(countof(NAMES) == SEC_COUNT);
+	Array<Uint8> shstrtab{m_allocator};
+	Uint32 names[SEC_COUNT];
+	for (Ulen i = 0; i < SEC_COUNT; i++) {
+		auto name = append(shstrtab, NAMES[i]);
+		if (!name) {
+			return error("Out of memory");
+		}
+		names[i] = *name;
+	}
+
+	const auto symtab_offset = align(image.length(), 8);
+	const auto strtab_offset = symtab_offset + symtab.length();
+	const auto shstrtab_offset = strtab_offset + strtab.length();
+	const auto shdrs_offset = align(shstrtab_offset + shstrtab.length(), 8);
+
+	const Elf::Shdr shdrs[SEC_COUNT] = {
+		{},
+		{ names[SEC_TEXT],     Elf::SHT_PROGBITS, Elf::SHF_ALLOC | Elf::SHF_EXECINSTR, text_beg,    text_beg - BASE,    text_end - text_beg,            0, 0, 16, 0 },
+		{ names[SEC_RODATA],   Elf::SHT_PROGBITS, Elf::SHF_ALLOC,                      rodata_beg,  rodata_beg - BASE,  rela_beg - rodata_beg,          0, 0, 16, 0 },
+		{ names[SEC_RELA_DYN], Elf::SHT_RELA,     Elf::SHF_ALLOC,                      rela_beg,    rela_beg - BASE,    rela_dyn.length(),              0, 0, 8,  sizeof(Elf::Rela) },
+		{ names[SEC_DATA],     Elf::SHT_PROGBITS, Elf::SHF_ALLOC | Elf::SHF_WRITE,     data_beg,    data_beg - BASE,    got_beg - data_beg,             0, 0, 16, 0 },
+		{ names[SEC_GOT],      Elf::SHT_PROGBITS, Elf::SHF_ALLOC | Elf::SHF_WRITE,     got_beg,     got_beg - BASE,     dynamic_beg - got_beg,          0, 0, 8,  8 },
+		{ names[SEC_DYNAMIC],  Elf::SHT_DYNAMIC,  Elf::SHF_ALLOC | Elf::SHF_WRITE,     dynamic_beg, dynamic_beg - BASE, data_end - dynamic_beg,         SEC_STRTAB, 0, 8, sizeof(Elf::Dyn) },
+		{ names[SEC_BSS],      Elf::SHT_NOBITS,   Elf::SHF_ALLOC | Elf::SHF_WRITE,     data_end,    data_end - BASE,    bss_end - data_end,             0, 0, 16, 0 },
+		{ names[SEC_SYMTAB],   Elf::SHT_SYMTAB,   0,                                   0,           symtab_offset,      symtab.length(),                SEC_STRTAB, 1, 8, sizeof(Elf::Sym) },
+		{ names[SEC_STRTAB],   Elf::SHT_STRTAB,   0,                                   0,           strtab_offset,      strtab.length(),                0, 0, 1,  0 },
+		{ names[SEC_SHSTRTAB], Elf::SHT_STRTAB,   0,                                   0,           shstrtab_offset,    shstrtab.length(),              0, 0, 1,  0 },
+	};
+
+	const Elf::Phdr phdrs[PHDRS] = {
+		{ Elf::PT_PHDR,    Elf::PF_R,             sizeof(Elf::Ehdr),  BASE + sizeof(Elf::Ehdr), BASE + sizeof(Elf::Ehdr), PHDRS * sizeof(Elf::Phdr), PHDRS * sizeof(Elf::Phdr), 8 },
+		{ Elf::PT_LOAD,    Elf::PF_R | Elf::PF_X, 0,                  BASE,        BASE,        text_end - BASE,           text_end - BASE,           PAGE },
+		{ Elf::PT_LOAD,    Elf::PF_R,             rodata_beg - BASE,  rodata_beg,  rodata_beg,  rodata_end - rodata_beg,   rodata_end - rodata_beg,   PAGE },
+		{ Elf::PT_LOAD,    Elf::PF_R | Elf::PF_W, data_beg - BASE,    data_beg,    data_beg,    data_end - data_beg,       bss_end - data_beg,        PAGE },
+		{ Elf::PT_DYNAMIC, Elf::PF_R | Elf::PF_W, dynamic_beg - BASE, dynamic_beg, dynamic_beg, data_end - dynamic_beg,    data_end - dynamic_beg,    8 },
+	};
+
+	Elf::Ehdr ehdr{};
+	ehdr.ident[0] = 0x7f;
+	ehdr.ident[1] = 'E';
+	ehdr.ident[2] = 'L';
+	ehdr.ident[3] = 'F';
+	ehdr.ident[4] = Elf::ELFCLASS64;
+	ehdr.ident[5] = Elf::ELFDATA2LSB;
+	ehdr.ident[6] = Elf::EV_CURRENT;
+	ehdr.type      = Elf::ET_DYN;
+	ehdr.machine   = Elf::EM_X86_64;
+	ehdr.version   = Elf::EV_CURRENT;
+	ehdr.entry     = entry_addr;
+	ehdr.phoff     = sizeof(Elf::Ehdr);
+	ehdr.shoff     = shdrs_offset;
+	ehdr.ehsize    = sizeof(Elf::Ehdr);
+	ehdr.phentsize = sizeof(Elf::Phdr);
+	ehdr.phnum     = PHDRS;
+	ehdr.shentsize = sizeof(Elf::Shdr);
+	ehdr.shnum     = SEC_COUNT;
+	ehdr.shstrndx  = SEC_SHSTRTAB;
+
+	write(image, 0, ehdr);
+	for (Ulen i = 0; i < PHDRS; i++) {
+		write(image, sizeof(Elf::Ehdr) + i * sizeof(Elf::Phdr), phdrs[i]);
+	}
+	if (!image.resize(symtab_offset)
+	 || !append(image, symtab.data(), symtab.length())
+	 || !append(image, strtab.data(), strtab.length())
+	 || !append(image, shstrtab.data(), shstrtab.length())
+	 || !image.resize(shdrs_offset)
+	 || !append(image, shdrs, sizeof shdrs))
+	{
+		return error("Out of memory");
+	}
+
+	auto file = File::open(m_system, output, FileAccess::EX);
+	if (!file) {
+		return error("Could not open '%S' for writing", output);
+	}
+	if (file->write(0, image.data(), image.length()) != image.length()) {
+		return error("Could not write '%S'", output);
+	}
+	return true;
+}
+
+} // namespace Biron
@@ -0,0 +1,161 @@
+#ifndef BIRON_LINKER_H
+#define BIRON_LINKER_H
+#include <biron/util/map.inl>
+#include <biron/util/string.h>
+
+namespace Biron {
+
+struct System;
+struct Terminal;
+
+// A minimal static linker for x86-64 ELF relocatable objects as produced by
+// Cg::emit. The output is a position independent executable laid out the same
+// way titan/link.ld lays out the kernel:
+//
+//	text    PT_LOAD  headers, .text
+//	rodata  PT_LOAD  .rodata, .rela.dyn
+//	data    PT_LOAD  .data, .requests_beg_marker, .requests, .requests_end_marker,
+//	                 .got, .dynamic, .bss
+//	dynamic PT_DYNAMIC
+//
+// Absolute relocations are turned into R_X86_64_RELATIVE entries in .rela.dyn
+// so the loader can place the image anywhere.
+struct Linker {
+	static inline constexpr const Uint64 BASE = 0xffffffff80000000_u64;
+	static inline constexpr const Uint64 PAGE = 0x1000;
+
+	constexpr Linker(const System& system, Terminal& terminal, Allocator& allocator) noexcept
+		: m_system{system}
+		, m_terminal{terminal}
+		, m_allocator{allocator}
+		, m_objects{allocator}
+		, m_inputs{allocator}
+		, m_globals{allocator}
+		, m_global_names{allocator}
+		, m_got{allocator}
+		, m_got_keys{allocator}
+	{
+	}
+
+	// Adds a relocatable object. The object must outlive the linker.
+	[[nodiscard]] Bool add(StringView name, const Array<Uint8>& object) noexcept;
+
+	// Links all added objects into the executable |output| with the entry point
+	// given by the symbol |entry|.
+	[[nodiscard]] Bool link(StringView output, StringView entry) noexcept;
+
+private:
+	static inline constexpr const Ulen NONE = ~Ulen(0);
+
+	enum class Out : Uint8 {
+		TEXT,
+		RODATA,
+		DATA,
+		REQUESTS_BEG,
+		REQUESTS,
+		REQUESTS_END,
+		BSS,
+		DISCARD,
+	};
+
+	struct Section {
+		StringView name;
+		Uint32     type;
+		Uint64     flags;
+		Uint64     offset;
+		Uint64     size;
+		Uint32     link;
+		Uint32     info;
+		Uint64     align;
+		Uint64     entsize;
+	};
+
+	struct Symbol {
+		StringView name;
+		Uint8      info;
+		Uint16     shndx;
+		Uint64     value;
+		Uint64     size;
+	};
+
+	struct Object {
+		Object(StringView name, const Array<Uint8>& data, Allocator& allocator) noexcept
+			: name{name}
+			, data{data}
+			, sections{allocator}
+			, inputs{allocator}
+			, symbols{allocator}
+			, globals{allocator}
+		{
+		}
+		StringView          name;
+		const Array<Uint8>& data;
+		Array<Section>      sections;
+		Array<Ulen>         inputs;  // Section index -> input index or NONE
+		Array<Symbol>       symbols;
+		Array<Ulen>         globals; // Symbol index -> global index or NONE
+	};
+
+	// An input section which is part of the output.
+	struct Input {
+		Ulen   object;
+		Ulen   section;
+		Out    out;
+		Uint64 size;
+		Uint64 align;
+		Uint64 addr;
+	};
+
+	struct Global {
+		StringView name;
+		Ulen       object; // Defining object or NONE when undefined
+		Ulen       symbol;
+		Bool       weak;
+		Bool       common;
+		Bool       linker; // Defined by the linker, like _DYNAMIC
+		Uint64     addr;
+	};
+
+	// What a symbol referenced by a relocation resolves to.
+	enum class Kind : Uint8 {
+		SECTION,    // Relative to an input section
+		ABSOLUTE,   // Absolute value
+		COMMON,     // Allocated in .bss by the linker
+		LINKER,     // Defined by the linker
+		UNDEF_WEAK, // Undefined weak, resolves to zero
+		UNDEF,      // Undefined
+		DISCARDED,  // Defined in a discarded section
+	};
+
+	// A symbol which needs an entry in .got
+	struct Got {
+		Uint64 key;
+		Ulen   object;
+		Ulen   symbol;
+	};
+
+	[[nodiscard]] Bool parse(Ulen index) noexcept;
+	[[nodiscard]] Bool resolve(Ulen index) noexcept;
+	[[nodiscard]] Bool scan(Ulen& relative) noexcept;
+	[[nodiscard]] Bool relocate(Array<Uint8>& image, Array<Uint8>& rela, Uint64 got) noexcept;
+	[[nodiscard]] Kind symbol(Ulen object, Ulen symbol, Uint64& value) const noexcept;
+	[[nodiscard]] Uint64 got_key(Ulen object, Ulen symbol) const noexcept;
+	[[nodiscard]] Maybe<Ulen> got_index(Ulen object, Ulen symbol) const noexcept;
+
+	template<typename... Ts>
+	Bool error(StringView fmt, Ts&&... args) noexcept;
+
+	const System&             m_system;
+	Terminal&                 m_terminal;
+	Allocator&                m_allocator;
+	Array<Object>             m_objects;
+	Array<Input>              m_inputs;
+	Array<Global>             m_globals;
+	HashMap<StringView, Ulen> m_global_names; // Index into m_globals
+	Array<Got>                m_got;
+	HashMap<Uint64, Ulen>     m_got_keys;     // Index into m_got
+};
+
+} // namespace Biron
+
+#endif // BIRON_LINKER_H
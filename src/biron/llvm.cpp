@@ -1,6 +1,7 @@
 #include <biron/llvm.h>
 #include <biron/util/system.inl>
 #include <biron/util/terminal.inl>
+#include <biron/util/traits/is_same.inl>
 
 namespace Biron {
 
@@ -63,4 +64,40 @@ Maybe<LLVM> LLVM::load(const System& system) noexcept {
 	return llvm;
 }
 
+// Every opaque reference returned by the null table points here so that none
+// of them are mistaken for failure.
+static Uint64 s_null;
+
+template<typename T>
+struct NullFn;
+
+template<typename R, typename... Ts>
+struct NullFn<R (*)(Ts...)> {
+	static R fn(Ts...) noexcept {
+		if constexpr (is_same<R, void>) {
+			return;
+		} else if constexpr (requires { static_cast<R>(nullptr); }) {
+			return reinterpret_cast<R>(&s_null);
+		} else {
+			return R{};
+		}
+	}
+};
+
+LLVM LLVM::null(const System& system) noexcept {
+	LLVM llvm{system};
+	#define FN(RETURN, NAME, ...) \
+		llvm.NAME = &NullFn<decltype(llvm.NAME)>::fn;
+	#include "llvm.inl"
+	#undef FN
+
+	// Code generation only emits a branch when a block is not yet terminated and
+	// only creates named types which do not exist yet. Every intrinsic exists.
+	llvm.GetBasicBlockTerminator = [](BasicBlockRef) -> ValueRef { return nullptr; };
+	llvm.GetTypeByName2 = [](ContextRef, const char*) -> TypeRef { return nullptr; };
+	llvm.LookupIntrinsicID = [](const char*, Ulen) -> unsigned { return 1; };
+
+	return llvm;
+}
+
 } // namespace Biron
@@ -24,6 +24,7 @@ struct LLVM {
 	struct OpaquePassBuilderOptions;
 	struct OpaqueError;
 	struct OpaqueAttribute;
+	struct OpaqueMemoryBuffer;
 
 	using ContextRef              = OpaqueContext*;
 	using ModuleRef               = OpaqueModule*;
@@ -37,6 +38,7 @@ struct LLVM {
 	using PassBuilderOptionsRef   = OpaquePassBuilderOptions*;
 	using ErrorRef                = OpaqueError*;
 	using AttributeRef            = OpaqueAttribute*;
+	using MemoryBufferRef         = OpaqueMemoryBuffer*;
 	using Bool                    = int;
 	using Ulen                    = decltype(sizeof 0);
 	using Opcode                  = int;
@@ -49,6 +51,8 @@ struct LLVM {
 	enum class VerifierFailureAction : int { AbortProcess, PrintMessage, ReturnStatus };
 	enum class IntPredicate          : int { EQ = 32, NE, UGT, UGE, ULT, ULE, SGT, SGE, SLT, SLE };
 	enum class RealPredicate         : int { False, OEQ, OGT, OGE, OLT, OLE, ONE, ORD, UNO, UEQ, UGT, UGE, ULT, ULE, UNE, True };
+	enum class AtomicOrdering        : int { NotAtomic, Unordered, Monotonic, Acquire = 4, Release, AcquireRelease, SequentiallyConsistent };
+	enum class AtomicRMWBinOp        : int { Xchg, Add, Sub, And, Nand, Or, Xor, Max, Min, UMax, UMin };
 
 	enum class Linkage : int {
 		External,
@@ -70,6 +74,12 @@ struct LLVM {
 		LinkerPrivateWeak,
 	};
 
+	enum class Visibility : int {
+		Default,
+		Hidden,
+		Protected,
+	};
+
 	#define FN(RETURN, NAME, ...) \
 		RETURN (*NAME)(__VA_ARGS__) = nullptr;
 	#include <biron/llvm.inl>
@@ -77,6 +87,11 @@ struct LLVM {
 
 	static Maybe<LLVM> load(const System& system) noexcept;
 
+	// A table of functions which do nothing and never load libLLVM. Running Cg
+	// on top of this performs all the checking code generation does without
+	// producing any code, which is what -fsyntax-only uses.
+	static LLVM null(const System& system) noexcept;
+
 private:
 	constexpr LLVM(const System& system) noexcept 
 		: m_system{system}
@@ -35,6 +35,7 @@ FN(AttributeRef,          CreateEnumAttribute,           ContextRef, unsigned, U
 FN(ModuleRef,             ModuleCreateWithNameInContext, const char*, ContextRef)
 FN(void,                  DisposeModule,                 ModuleRef)
 FN(void,                  DumpModule,                    ModuleRef)
+FN(char*,                 PrintModuleToString,           ModuleRef)
 FN(ValueRef,              AddFunction,                   ModuleRef, const char*, TypeRef)
 // Types
 /// Integer Types
@@ -55,6 +56,7 @@ FN(void,                  StructSetBody,                 TypeRef, TypeRef*, unsi
 FN(Bool,                  IsLiteralStruct,               TypeRef)
 /// Sequential Types
 FN(TypeRef,               ArrayType2,                    TypeRef, Uint64)
+FN(TypeRef,               VectorType,                    TypeRef, unsigned)
 /// Other Types
 FN(TypeRef,               PointerTypeInContext,          ContextRef, unsigned)
 FN(TypeRef,               VoidTypeInContext,             ContextRef)
@@ -64,6 +66,7 @@ FN(void,                  SetValueName2,                 ValueRef, const char*,
 /// Constants
 FN(ValueRef,              ConstNull,                     TypeRef)
 FN(ValueRef,              ConstPointerNull,              TypeRef)
+FN(ValueRef,              GetUndef,                      TypeRef)
 //// Scalar Constants
 FN(ValueRef,              ConstInt,                      TypeRef, unsigned long long, Bool)
 FN(ValueRef,              ConstReal,                     TypeRef, double)
@@ -72,8 +75,10 @@ FN(ValueRef,              ConstReal,                     TypeRef, double)
 FN(ValueRef,              ConstStructInContext,          ContextRef, ValueRef*, unsigned, Bool)
 FN(ValueRef,              ConstArray2,                   TypeRef, ValueRef*, Uint64)
 FN(ValueRef,              ConstNamedStruct,              TypeRef, ValueRef*, unsigned)
+FN(ValueRef,              ConstVector,                   ValueRef*, unsigned)
 /// Global Values
 FN(void,                  SetLinkage,                    ValueRef, Linkage)
+FN(void,                  SetVisibility,                 ValueRef, Visibility)
 FN(void,                  SetSection,                    ValueRef, const char*)
 FN(void,                  SetAlignment,                  ValueRef, unsigned)
 /// Global Variables
@@ -81,6 +86,9 @@ FN(ValueRef,              AddGlobal,                     ModuleRef, TypeRef, con
 FN(void,                  SetInitializer,                ValueRef, ValueRef)
 /// Function Values
 FN(void,                  AddAttributeAtIndex,           ValueRef, AttributeIndex, AttributeRef)
+FN(unsigned,              LookupIntrinsicID,             const char*, Ulen)
+FN(ValueRef,              GetIntrinsicDeclaration,       ModuleRef, unsigned, TypeRef*, Ulen)
+FN(TypeRef,               IntrinsicGetType,              ContextRef, unsigned, TypeRef*, Ulen)
 /// Function Parameters
 FN(ValueRef,              GetParam,                      ValueRef, unsigned)
 // Basic Block
@@ -100,6 +108,8 @@ FN(ValueRef,              BuildRetVoid,                  BuilderRef)
 FN(ValueRef,              BuildRet,                      BuilderRef, ValueRef)
 FN(ValueRef,              BuildBr,                       BuilderRef, BasicBlockRef)
 FN(ValueRef,              BuildCondBr,                   BuilderRef, ValueRef, BasicBlockRef, BasicBlockRef)
+FN(ValueRef,              BuildSwitch,                   BuilderRef, ValueRef, BasicBlockRef, unsigned)
+FN(void,                  AddCase,                       ValueRef, ValueRef, BasicBlockRef)
 /// Arithmetic
 FN(ValueRef,              BuildAdd,                      BuilderRef, ValueRef, ValueRef, const char*)
 FN(ValueRef,              BuildFAdd,                     BuilderRef, ValueRef, ValueRef, const char*)
@@ -128,6 +138,7 @@ FN(ValueRef,              BuildMemSet,                   BuilderRef, ValueRef, V
 FN(ValueRef,              BuildAlloca,                   BuilderRef, TypeRef, const char*)
 FN(ValueRef,              BuildLoad2,                    BuilderRef, TypeRef, ValueRef, const char*)
 FN(ValueRef,              BuildStore,                    BuilderRef, ValueRef, ValueRef)
+FN(void,                  SetOrdering,                   ValueRef, AtomicOrdering)
 FN(ValueRef,              BuildInBoundsGEP2,             BuilderRef, TypeRef, ValueRef, ValueRef*, unsigned, const char*)
 FN(ValueRef,              BuildGlobalString,             BuilderRef, const char*, const char*)
 /// Casts
@@ -140,7 +151,18 @@ FN(ValueRef,              BuildFCmp,                     BuilderRef, RealPredica
 FN(ValueRef,              BuildPhi,                      BuilderRef, TypeRef, const char*)
 FN(ValueRef,              BuildCall2,                    BuilderRef, TypeRef, ValueRef, ValueRef*, unsigned, const char*)
 FN(ValueRef,              BuildSelect,                   BuilderRef, ValueRef, ValueRef, ValueRef, const char*)
+FN(ValueRef,              BuildExtractElement,           BuilderRef, ValueRef, ValueRef, const char*)
+FN(ValueRef,              BuildInsertElement,            BuilderRef, ValueRef, ValueRef, ValueRef, const char*)
+FN(ValueRef,              BuildShuffleVector,            BuilderRef, ValueRef, ValueRef, ValueRef, const char*)
 FN(ValueRef,              BuildExtractValue,             BuilderRef, ValueRef, unsigned, const char*)
+FN(ValueRef,              BuildInsertValue,              BuilderRef, ValueRef, ValueRef, unsigned, const char*)
+FN(ValueRef,              BuildFence,                    BuilderRef, AtomicOrdering, Bool, const char*)
+FN(ValueRef,              BuildAtomicRMW,                BuilderRef, AtomicRMWBinOp, ValueRef, ValueRef, AtomicOrdering, Bool)
+FN(ValueRef,              BuildAtomicCmpXchg,            BuilderRef, ValueRef, ValueRef, ValueRef, AtomicOrdering, AtomicOrdering, Bool)
+// Memory Buffers
+FN(const char*,           GetBufferStart,                MemoryBufferRef)
+FN(Ulen,                  GetBufferSize,                 MemoryBufferRef)
+FN(void,                  DisposeMemoryBuffer,           MemoryBufferRef)
 
 //
 // Error.h
@@ -163,6 +185,7 @@ FN(Bool,                  GetTargetFromTriple,           const char*, TargetRef*
 FN(TargetMachineRef,      CreateTargetMachine,           TargetRef, const char*, const char*, const char*, CodeGenOptLevel, RelocMode, CodeModel)
 FN(void,                  DisposeTargetMachine,          TargetMachineRef)
 FN(Bool,                  TargetMachineEmitToFile,       TargetMachineRef, ModuleRef, const char*, CodeGenFileType, char**)
+FN(Bool,                  TargetMachineEmitToMemoryBuffer, TargetMachineRef, ModuleRef, CodeGenFileType, char**, MemoryBufferRef*)
 
 //
 // PassBuilder.h
@@ -1,13 +1,18 @@
-#include <string.h> // strlen, memcpy
+#include <string.h> // strlen
 #include <stdlib.h> // system
 
 #include <biron/util/allocator.h>
 #include <biron/util/file.h>
 #include <biron/util/terminal.inl>
+#include <biron/util/thread.h>
+#include <biron/util/hash.inl>
+#include <biron/util/pool.h>
+#include <biron/util/trace.h>
+#include <biron/util/socket.h>
 
-#include <biron/parser.h>
-#include <biron/llvm.h>
-#include <biron/cg.h>
+#include <biron/compiler.h>
+#include <biron/object_cache.h>
+#include <biron/linker.h>
 
 using namespace Biron;
 
@@ -16,23 +21,706 @@ namespace Biron {
 	extern const System SYSTEM;
 }
 
-int main(int argc, char **argv) {
-	const System& sys = SYSTEM;
+struct Source {
+	StringView name;
+	FileMap    data;
+};
 
-	SystemAllocator allocator{sys};
-	Terminal terminal{sys};
+struct Machines;
 
-	argc--;
-	argv++;
+struct Options {
+	StringView   triple     = "x86_64-unknown-none";
+	Ulen         opt        = 0;
+	Bool         dump_ir    = false;
+	Bool         dump_ast   = false;
+	Bool         time_trace = false;
+	Bool         check      = false; // Only report diagnostics, -fsyntax-only
+	Ulen         partitions = 1;     // Threads generating the functions of a unit
+	ObjectCache* cache      = nullptr;
+	Machines*    machines   = nullptr; // Kept by the compile server
+};
+
+// The target machines of the compile server, kept from one request to the next.
+// A target machine must not be used by two threads at once and units are
+// generated on many with -j, so a machine is taken out while it is in use and
+// given back after. Another is only made when every one for the triple is taken.
+struct Machines {
+	Machines(Allocator& allocator, Mutex&& mutex) noexcept
+		: m_allocator{allocator}
+		, m_entries{allocator}
+		, m_mutex{move(mutex)}
+	{
+	}
+	~Machines() noexcept {
+		for (const auto& entry : m_entries) {
+			drop(entry);
+		}
+	}
+	CgMachine* acquire(Terminal& terminal, LLVM& llvm, StringView triple) noexcept {
+		m_mutex.lock();
+		for (Ulen i = 0; i < m_entries.length(); i++) {
+			if (const auto entry = m_entries[i]; entry.triple == triple) {
+				m_entries[i] = m_entries.last();
+				m_entries.pop_back();
+				m_mutex.unlock();
+				m_allocator.deallocate(const_cast<char*>(entry.triple.data()), entry.triple.length() + 1);
+				return entry.machine;
+			}
+		}
+		m_mutex.unlock();
+		auto machine = CgMachine::make(terminal, llvm, triple);
+		if (!machine) {
+			return nullptr;
+		}
+		return m_allocator.make<CgMachine>(move(*machine));
+	}
+	void release(StringView triple, CgMachine* machine) noexcept {
+		const Entry entry{{triple.terminated(m_allocator), triple.length()}, machine};
+		if (!entry.triple.data()) {
+			drop(entry);
+			return;
+		}
+		m_mutex.lock();
+		const auto ok = m_entries.push_back(entry);
+		m_mutex.unlock();
+		if (!ok) {
+			drop(entry);
+		}
+	}
+private:
+	struct Entry {
+		StringView triple; // NUL terminated copy
+		CgMachine* machine;
+	};
+	void drop(const Entry& entry) noexcept {
+		if (entry.triple.data()) {
+			m_allocator.deallocate(const_cast<char*>(entry.triple.data()), entry.triple.length() + 1);
+		}
+		entry.machine->~CgMachine();
+		m_allocator.deallocate_object(entry.machine);
+	}
+	Allocator&   m_allocator;
+	Array<Entry> m_entries;
+	Mutex        m_mutex;
+};
+
+// Identifies the compiler build by hashing the executable itself so that any
+// change to the compiler invalidates previously cached objects.
+static Maybe<Uint64> build_id(const System& sys, Allocator& allocator, StringView exe) noexcept {
+	auto file = File::open(sys, "/proc/self/exe");
+	if (!file) {
+		file = File::open(sys, exe);
+	}
+	if (!file) {
+		return None{};
+	}
+	auto data = file->map(allocator);
+	if (!data) {
+		return None{};
+	}
+	return Hash{}.string(data->view()).result();
+}
+
+// Object code kept in memory for the linker, one per compiled unit or one per
+// partition when the functions of a unit are generated in partitions.
+using Objects = Array<Maybe<Array<Uint8>>>;
+
+// Optimizes the module of |cg| and emits it into the object file |obj|, or into
+// |mem| when given.
+static Bool lower(Cg& cg,
+                  CgMachine& machine,
+                  StringView obj,
+                  Maybe<Array<Uint8>>* mem,
+                  const Options& options,
+                  Terminal& terminal,
+                  Allocator& allocator,
+                  Trace* trace) noexcept
+{
+	{
+		TraceScope scope{trace, "Optimize"};
+		if (!cg.optimize(machine, options.opt)) {
+			return false;
+		}
+	}
+
+	if (options.dump_ir && !cg.dump()) {
+		return false;
+	}
+
+	{
+		TraceScope scope{trace, "Emit"};
+		if (mem) {
+			auto object = cg.emit(machine, allocator);
+			if (!object) {
+				return false;
+			}
+			mem->emplace(move(*object));
+		} else if (!cg.emit(machine, obj)) {
+			terminal.err("Could not write object file: '%S'\n", obj);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Generates the sources in |range| into the object file |obj|, or into |mem| when
+// given. Only the functions of |partition| are generated. Everything this touches
+// is local to the call except for the LLVM function table and the allocator,
+// both of which are safe to share between threads, and the target machines of
+// the compile server which are handed to one thread at a time.
+static Bool generate(const System& sys,
+                     const Array<Source>& sources,
+                     Range range,
+                     CgPartition partition,
+                     StringView obj,
+                     Maybe<Array<Uint8>>* mem,
+                     const Options& options,
+                     LLVM& llvm,
+                     Terminal& terminal,
+                     Allocator& allocator,
+                     Trace* trace) noexcept
+{
+	Symbols symbols{allocator};
+	if (!symbols.init()) {
+		terminal.err("Out of memory\n");
+		return false;
+	}
+
+	Units units{allocator, symbols};
+	for (Ulen i = 0; i < range.length; i++) {
+		const auto& source = sources[range.offset + i];
+		auto unit = units.add(source.name, source.data.view(), terminal);
+		if (!unit) {
+			terminal.err("Out of memory\n");
+			return false;
+		}
+		TraceScope scope{trace, "Parse", source.name};
+		if (!unit->parse(&sys)) {
+			terminal.err("Could not parse\n");
+			return false;
+		}
+		if (options.dump_ast) {
+			StringBuilder builder{allocator};
+			unit->ast->dump(builder);
+			terminal.err(builder.view());
+		}
+	}
+
+	auto cg = Cg::make(terminal, allocator, llvm, symbols, (*units.begin())->diagnostic);
+	if (!cg) {
+		terminal.err("Could not initialize code generator\n");
+		return false;
+	}
+	cg->partition = partition;
+	cg->trace = trace;
+
+	{
+		// Run each pass over every unit before the next pass so that units can
+		// refer to the functions, globals and types of one another.
+		TraceScope scope{trace, "Codegen"};
+		if (!Ast::prelude(*cg)) {
+			return false;
+		}
+		for (auto pass : Ast::PASSES) {
+			for (auto unit : units) {
+				cg->use(unit->diagnostic);
+				if (!unit->ast->codegen(*cg, pass)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	// Everything has been checked by now and there is no code to emit.
+	if (options.check) {
+		return true;
+	}
+
+	CgMachine* machine = nullptr;
+	auto own = options.machines ? None{} : CgMachine::make(terminal, llvm, options.triple);
+	if (options.machines) {
+		machine = options.machines->acquire(terminal, llvm, options.triple);
+	} else if (own) {
+		machine = &*own;
+	}
+	if (!machine) {
+		return false;
+	}
+
+	const auto ok = lower(*cg, *machine, obj, mem, options, terminal, allocator, trace);
+	if (options.machines) {
+		options.machines->release(options.triple, machine);
+	}
+	return ok;
+}
+
+// One partition of the functions of a unit. Each is generated on its own thread
+// with its own LLVM context and a buffered terminal.
+struct Partition {
+	const System&        sys;
+	const Array<Source>& sources;
+	Range                range;
+	CgPartition          partition;
+	const Options&       options;
+	LLVM&                llvm;
+	Allocator&           allocator;
+	Terminal*            terminal;
+	Trace*               trace; // Optional
+	Maybe<Array<Uint8>>  object;
+	Bool                 ok;
+};
+
+static void generate_partition(void* data) noexcept {
+	auto& part = *static_cast<Partition*>(data);
+	part.ok = generate(part.sys,
+	                   part.sources,
+	                   part.range,
+	                   part.partition,
+	                   StringView{},
+	                   &part.object,
+	                   part.options,
+	                   part.llvm,
+	                   *part.terminal,
+	                   part.allocator,
+	                   part.trace);
+}
+
+// Builds "name.o", or "name.i.o" for the partial object of partition |i|.
+static Bool object_path(StringBuilder& builder, StringView name, Maybe<Ulen> partition) noexcept {
+	builder.append(name);
+	if (partition) {
+		builder.append('.');
+		builder.append(Uint64(*partition));
+	}
+	builder.append(".o");
+	return builder.valid();
+}
+
+// Writes out the partial objects of |parts| as "name.i.o", these are linked in
+// place of "name.o". Nothing is left behind when one cannot be written.
+static Bool write_partials(const System& sys,
+                           const Array<Partition>& parts,
+                           StringView name,
+                           Terminal& terminal,
+                           Allocator& allocator) noexcept
+{
+	for (Ulen l = parts.length(), i = 0; i < l; i++) {
+		StringBuilder path{allocator};
+		if (!object_path(path, name, i)) {
+			terminal.err("Out of memory\n");
+			return false;
+		}
+		auto out = File::open(sys, path.view(), FileAccess::WR);
+		const auto& object = *parts[i].object;
+		if (!out || out->write(0, object.data(), object.length()) != object.length()) {
+			terminal.err("Could not write object file: '%S'\n", path.view());
+			out.reset();
+			for (Ulen j = 0; j <= i; j++) {
+				StringBuilder written{allocator};
+				if (object_path(written, name, j)) {
+					sys.file_remove(sys, written.view());
+				}
+			}
+			return false;
+		}
+	}
+	return true;
+}
+
+// Generates the unit in |range| in Options::partitions partitions at once. Every
+// partition parses the unit and runs the passes which declare things itself so
+// that nothing is shared between the threads. The partial objects are either
+// all put in |mem|, which has a slot for each, or written out for the final link
+// as "name.i.o".
+static Bool generate_partitions(const System& sys,
+                                const Array<Source>& sources,
+                                Range range,
+                                StringView name,
+                                Maybe<Array<Uint8>>* mem,
+                                const Options& options,
+                                LLVM& llvm,
+                                Terminal& terminal,
+                                Allocator& allocator,
+                                Trace* trace) noexcept
+{
+	const auto count = options.partitions;
+
+	Array<Partition> parts{allocator};
+	if (!parts.reserve(count)) {
+		terminal.err("Out of memory\n");
+		return false;
+	}
+
+	Bool ok = true;
+	for (Ulen i = 0; i < count; i++) {
+		auto buffered = allocator.make<Terminal>(sys, true);
+		if (!buffered) {
+			ok = false;
+			break;
+		}
+		// Only this thread may write to the trace. The reserve makes this succeed.
+		(void)parts.emplace_back(sys, sources, range, CgPartition { i, count }, options, llvm, allocator, buffered, i == 0 ? trace : nullptr, None{}, false);
+	}
+
+	if (ok) {
+		TraceScope scope{trace, "Partitions"};
+		Array<Thread> threads{allocator};
+		for (Ulen i = 1; i < count; i++) {
+			auto thread = Thread::make(sys, generate_partition, &parts[i]);
+			if (!thread || !threads.push_back(move(*thread))) {
+				// Generate the partitions without a thread on this one.
+				generate_partition(&parts[i]);
+			}
+		}
+		generate_partition(&parts[0]);
+		// The threads are joined here.
+	}
+
+	// Every partition declares the same things so an error in those is reported
+	// by all of them. Only the diagnostics up to the first failure are kept, which
+	// is what generating the unit serially reports.
+	for (auto& part : parts) {
+		part.terminal->drain([&](StringView out, StringView err) {
+			terminal.out(out);
+			terminal.err(err);
+		});
+		if (!part.ok) {
+			ok = false;
+			break;
+		}
+	}
+
+	if (ok && !options.check) {
+		TraceScope scope{trace, "Combine"};
+		if (mem) {
+			for (Ulen i = 0; i < count; i++) {
+				mem[i] = move(parts[i].object);
+			}
+		} else {
+			ok = write_partials(sys, parts, name, terminal, allocator);
+		}
+	}
+
+	for (auto& part : parts) {
+		part.terminal->~Terminal();
+		allocator.deallocate_object(part.terminal);
+	}
+
+	return ok;
+}
+
+// Compiles the sources in |range| into the object file "name.o", or into |mem|
+// when given. This is one source except with -whole-program where it is all of
+// them. With partitions there are partial objects instead, see
+// generate_partitions.
+static Bool compile_unit(const System& sys,
+                         const Array<Source>& sources,
+                         Range range,
+                         StringView name,
+                         Maybe<Array<Uint8>>* mem,
+                         const Options& options,
+                         LLVM& llvm,
+                         Terminal& terminal,
+                         Allocator& allocator,
+                         Trace* trace) noexcept
+{
+	TraceScope scope{trace, "Compile", sources[range.offset].name};
+
+	StringBuilder obj{allocator};
+	if (!object_path(obj, name, None{})) {
+		terminal.err("Out of memory\n");
+		return false;
+	}
+
+	// A unit found in the cache is a single object. That can be linked in memory
+	// in place of the partial objects but not written out in place of them.
+	const Bool single = options.partitions == 1;
+	Maybe<ObjectCache::Key> key;
+	if (options.cache && (mem || single)) {
+		TraceScope scope{trace, "Cache"};
+		key.emplace(options.cache->key());
+		for (Ulen i = 0; i < range.length; i++) {
+			key->string(sources[range.offset + i].data.view());
+		}
+		if (mem) {
+			if (auto object = options.cache->load(*key, allocator)) {
+				mem->emplace(move(*object));
+				return true;
+			}
+		} else if (options.cache->load(*key, obj.view())) {
+			return true;
+		}
+	}
+
+	const auto ok = single
+		? generate(sys, sources, range, CgPartition{}, obj.view(), mem, options, llvm, terminal, allocator, trace)
+		: generate_partitions(sys, sources, range, name, mem, options, llvm, terminal, allocator, trace);
+	if (!ok || options.check) {
+		return ok;
+	}
+
+	// Failing to populate the cache is not an error. Partitions are many objects
+	// so those are not cached.
+	if (key && single) {
+		if (mem) {
+			options.cache->store(*key, **mem);
+		} else {
+			options.cache->store(*key, obj.view());
+		}
+	}
+
+	return true;
+}
+
+static Bool compile(const System& sys,
+                    const Array<Source>& sources,
+                    Range range,
+                    Maybe<Array<Uint8>>* mem,
+                    const Options& options,
+                    LLVM& llvm,
+                    Terminal& terminal,
+                    Allocator& allocator) noexcept
+{
+	// Strip everything up to including '.'
+	const auto& source = sources[range.offset];
+	auto dot = source.name.find_last_of('.');
+	auto name = source.name.slice(0, *dot);
+
+	if (!options.time_trace) {
+		return compile_unit(sys, sources, range, name, mem, options, llvm, terminal, allocator, nullptr);
+	}
+
+	Trace trace{sys, allocator};
+	auto result = compile_unit(sys, sources, range, name, mem, options, llvm, terminal, allocator, &trace);
+
+	// Build "name.json"
+	StringBuilder json{allocator};
+	json.append(name);
+	json.append(".json");
+	if (!json.valid() || !trace.write(json.view(), allocator)) {
+		terminal.err("Could not write time trace: '%S'\n", json.view());
+		return false;
+	}
+
+	return result;
+}
+
+// State shared between the main thread and the workers of compile_parallel.
+// Everything except the per-unit terminals is guarded by the mutex.
+struct Work {
+	struct Unit {
+		Terminal* terminal = nullptr;
+		Bool      done     = false;
+		Bool      ok       = false;
+	};
+	const System&        sys;
+	const Array<Source>& sources;
+	const Options&       options;
+	LLVM&                llvm;
+	Allocator&           allocator;
+	Objects*             objects; // When linking in memory
+	Array<Unit>&         units;
+	Mutex&               mutex;
+	Cond&                cond;
+	Ulen                 next   = 0;
+	Bool                 cancel = false;
+};
+
+static void worker(void* data) noexcept {
+	auto& work = *static_cast<Work*>(data);
+	for (;;) {
+		work.mutex.lock();
+		// Sources are handed out in order so a failure can only ever cancel units
+		// which come after it.
+		if (work.cancel || work.next == work.sources.length()) {
+			work.mutex.unlock();
+			return;
+		}
+		auto index = work.next++;
+		work.mutex.unlock();
+
+		auto& unit = work.units[index];
+		auto ok = compile(work.sys,
+		                  work.sources,
+		                  Range{index, 1},
+		                  work.objects ? &(*work.objects)[index] : nullptr,
+		                  work.options,
+		                  work.llvm,
+		                  *unit.terminal,
+		                  work.allocator);
+
+		work.mutex.lock();
+		unit.done = true;
+		unit.ok = ok;
+		if (!ok) {
+			work.cancel = true;
+		}
+		work.cond.broadcast();
+		work.mutex.unlock();
+	}
+}
+
+// Compiles the sources on a pool of worker threads. The output of each unit is
+// buffered and written out by the main thread in source order so diagnostics
+// are whole and identical to what a serial compile would produce.
+static Bool compile_parallel(const System& sys,
+                             const Array<Source>& sources,
+                             Objects* objects,
+                             const Options& options,
+                             LLVM& llvm,
+                             Allocator& allocator,
+                             Ulen jobs) noexcept
+{
+	auto mutex = Mutex::make(sys);
+	auto cond = Cond::make(sys);
+	if (!mutex || !cond) {
+		return false;
+	}
+
+	Array<Work::Unit> units{allocator};
+	if (!units.resize(sources.length())) {
+		return false;
+	}
+
+	Bool ok = true;
+	for (auto& unit : units) {
+		if (!(unit.terminal = allocator.make<Terminal>(sys, true))) {
+			ok = false;
+			break;
+		}
+	}
+
+	Work work{sys, sources, options, llvm, allocator, objects, units, *mutex, *cond};
+
+	if (ok) {
+		Array<Thread> threads{allocator};
+		if (jobs > sources.length()) {
+			jobs = sources.length();
+		}
+		for (Ulen i = 0; i < jobs; i++) {
+			auto thread = Thread::make(sys, worker, &work);
+			if (!thread || !threads.push_back(move(*thread))) {
+				break;
+			}
+		}
+
+		// Could not create a single thread, compile on this one instead.
+		if (threads.empty()) {
+			worker(&work);
+		}
+
+		for (auto& unit : units) {
+			mutex->lock();
+			while (!unit.done) {
+				cond->wait(*mutex);
+			}
+			mutex->unlock();
+			unit.terminal->flush();
+			if (!unit.ok) {
+				ok = false;
+				break;
+			}
+		}
+
+		// The threads are joined here.
+	}
+
+	for (auto& unit : units) {
+		if (unit.terminal) {
+			unit.terminal->~Terminal();
+			allocator.deallocate_object(unit.terminal);
+		}
+	}
+
+	return ok;
+}
+
+// Lexes every source over and over with and without the SIMD fast paths of the
+// lexer and reports the throughput of each. Both must produce the same tokens.
+static int bench_lexer(const System& sys, Terminal& terminal, const Array<Source>& sources) noexcept {
+	// Each measurement lexes at least this many bytes.
+	static constexpr const Ulen BYTES = 256 * 1024 * 1024;
+	for (const auto& source : sources) {
+		const auto data = source.data.view();
+		const auto iterations = data.length() ? (BYTES + data.length() - 1) / data.length() : 1;
+		Uint64 hashes[2] = {};
+		Uint64 rates[2] = {};
+		for (Ulen simd = 0; simd < 2; simd++) {
+			Hash hash;
+			const auto beg = sys.clock_now(sys);
+			for (Ulen i = 0; i < iterations; i++) {
+				Lexer lexer{source.name, data, simd == 1};
+				for (;;) {
+					const auto token = lexer.next();
+					hash.value(token.kind).value(token.range.offset).value(token.range.length);
+					if (token.eof()) {
+						break;
+					}
+				}
+			}
+			const auto ns = sys.clock_now(sys) - beg;
+			hashes[simd] = hash.result();
+			rates[simd] = ns ? (Uint64(data.length()) * iterations * 1000) / ns : 0;
+		}
+		terminal.out("%S: scalar %zu MB/s, simd %zu MB/s\n", source.name, Ulen(rates[0]), Ulen(rates[1]));
+		if (hashes[0] != hashes[1]) {
+			terminal.err("%S: scalar and simd tokens differ\n", source.name);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Allocates millions of Ast sized objects from a Cache the same way the parser
+// does and reports the throughput of every million. It should stay flat.
+static int bench_cache(const System& sys, Terminal& terminal, Allocator& allocator) noexcept {
+	static constexpr const Ulen BATCH = 1024 * 1024;
+	static constexpr const Ulen BATCHES = 8;
+	ArenaAllocator arena{allocator};
+	Cache cache{arena, 64, 1024};
+	for (Ulen batch = 0; batch < BATCHES; batch++) {
+		const auto beg = sys.clock_now(sys);
+		for (Ulen i = 0; i < BATCH; i++) {
+			if (!cache.allocate()) {
+				terminal.err("Out of memory\n");
+				return 1;
+			}
+		}
+		const auto ns = sys.clock_now(sys) - beg;
+		const auto rate = ns ? (Uint64(BATCH) * 1000) / ns : 0;
+		terminal.out("%zu objects: %zu M/s\n", cache.length(), Ulen(rate));
+	}
+	return 0;
+}
+
+// Runs the compiler for the arguments |argv|, which exclude the executable name.
+// The compile server calls this once per request with the same |llvm| so that
+// libLLVM is only loaded the first time, and its |machines|.
+static int run(const System& sys,
+               Terminal& terminal,
+               Allocator& allocator,
+               Maybe<LLVM>& llvm,
+               Machines* machines,
+               StringView exe,
+               int argc,
+               char** argv) noexcept
+{
 	if (argc == 0) {
-		terminal.err("Usage: %s file.biron\n", argv[-1]);
+		terminal.err("Usage: %S file.biron\n", exe);
 		return 1;
 	}
 
 	Bool bm = false;
-	Ulen opt = 0;
-	Bool dump_ir = false;
-	Bool dump_ast = false;
+	Bool whole_program = false;
+	Bool bench = false;
+	Bool bench_alloc = false;
+	Ulen jobs = 1;
+	Options options;
+	options.machines = machines;
+	Maybe<StringView> cache_dir;
+	Maybe<StringView> output;
+	StringView entry = "kmain";
 
 	Array<StringView> filenames{allocator};
 	for (int i = 0; i < argc; i++) {
@@ -42,44 +730,77 @@ int main(int argc, char **argv) {
 				return 1;
 			}
 		} else if (argv[i][0] == '-') {
-			if (argv[i][1] == 'b' && argv[i][2] == 'm') {
+			if (StringView{argv[i]} == "--cache-dir") {
+				if (i + 1 == argc) {
+					terminal.err("Missing directory for --cache-dir\n");
+					return 1;
+				}
+				i++;
+				cache_dir.emplace(argv[i], strlen(argv[i]));
+			} else if (StringView{argv[i]} == "-o" || StringView{argv[i]} == "-e") {
+				if (i + 1 == argc) {
+					terminal.err("Missing argument for %s\n", argv[i]);
+					return 1;
+				}
+				if (argv[i][1] == 'o') {
+					output.emplace(argv[i + 1], strlen(argv[i + 1]));
+				} else {
+					entry = StringView{argv[i + 1], strlen(argv[i + 1])};
+				}
+				i++;
+			} else if (StringView{argv[i]} == "-fsyntax-only" || StringView{argv[i]} == "-check") {
+				options.check = true;
+			} else if (StringView{argv[i]} == "-bench-lexer") {
+				bench = true;
+			} else if (StringView{argv[i]} == "-bench-cache") {
+				bench_alloc = true;
+			} else if (StringView{argv[i]} == "-whole-program") {
+				whole_program = true;
+			} else if (StringView{argv[i]} == "-ftime-trace") {
+				options.time_trace = true;
+			} else if (argv[i][1] == 'b' && argv[i][2] == 'm') {
 				bm = true;
 			} else if (argv[i][1] == 'O') {
 				switch (argv[i][2]) {
-				case '0': opt = 0; break;
-				case '1': opt = 1; break;
-				case '2': opt = 2; break;
-				case '3': opt = 3; break;
+				case '0': options.opt = 0; break;
+				case '1': options.opt = 1; break;
+				case '2': options.opt = 2; break;
+				case '3': options.opt = 3; break;
 				default:
 					terminal.err("Unknown option %s\n", argv[i]);
 					return 1;
 				}
 			} else if (argv[i][1] == 'd') {
 				if (argv[i][2] == 'a') {
-					dump_ast = true;
+					options.dump_ast = true;
 				} else if (argv[i][2] == 'i') {
-					dump_ir = true;
+					options.dump_ir = true;
+				}
+			} else if (argv[i][1] == 'j') {
+				// Accept both "-jN" and "-j N"
+				const char* count = argv[i][2] ? &argv[i][2] : (i + 1 < argc ? argv[++i] : "");
+				jobs = 0;
+				for (; *count >= '0' && *count <= '9'; count++) {
+					jobs = jobs * 10 + (*count - '0');
+				}
+				if (*count || jobs == 0) {
+					terminal.err("Invalid job count for -j\n");
+					return 1;
 				}
 			}
 		}
 	}
 
-	if (filenames.empty()) {
-		terminal.err("Missing files\n");
-		return 1;
+	if (bench_alloc) {
+		return bench_cache(sys, terminal, allocator);
 	}
 
-	auto llvm = LLVM::load(sys);
-	if (!llvm) {
-		terminal.err("Could not load libLLVM. Ensure a dynamic libLLVM library is installed on your system or in the current working directory\n");
+	if (filenames.empty()) {
+		terminal.err("Missing files\n");
 		return 1;
 	}
 
 	// Read in source code of all files
-	struct Source {
-		StringView  name;
-		Array<char> data;
-	};
 	Array<Source> sources{allocator};
 	for (auto filename : filenames) {
 		auto dot = filename.find_last_of('.');
@@ -92,100 +813,138 @@ int main(int argc, char **argv) {
 			terminal.err("Could not open file: '%S'\n", filename);
 			return 1;
 		}
-		Array<char> data{allocator};
-		for (;;) {
-			char buffer[4096];
-			auto length = file->read(data.length(), buffer, sizeof buffer);
-			if (length) {
-				auto offset = data.length();
-				if (!data.resize(offset + length)) {
-					return 1;
-				}
-				memcpy(data.data() + offset, buffer, length);
-			} else {
-				break;
-			}
-		}
-		if (!sources.emplace_back(filename, move(data))) {
+		auto data = file->map(allocator);
+		if (!data) {
+			terminal.err("Could not read file: '%S'\n", filename);
 			return 1;
 		}
-	}
-
-	// TODO(dweiler): Thread this part
-	for (const auto& source : sources) {
-		StringView code{source.data.data(), source.data.length()};
-		Lexer lexer{source.name, code};
-		Diagnostic diagnostic{lexer, terminal, allocator};
-		Parser parser{lexer, diagnostic, allocator};
-		auto ast = parser.parse();
-		if (!ast) {
-			terminal.err("Could not parse\n");
+		if (!sources.emplace_back(filename, move(*data))) {
 			return 1;
 		}
+	}
 
-		auto cg = Cg::make(terminal, allocator, *llvm, diagnostic);
-		if (!cg) {
-			terminal.err("Could not initialize code generator\n");
-			return 1;
-		}
+	if (bench) {
+		return bench_lexer(sys, terminal, sources);
+	}
 
-		if (dump_ast) {
-			StringBuilder builder{allocator};
-			ast->dump(builder);
-			terminal.err(builder.view());
-		}
+	// Checking runs code generation against the null LLVM so libLLVM is never
+	// loaded.
+	Maybe<LLVM> null;
+	if (options.check) {
+		null.emplace(LLVM::null(sys));
+	} else if (!llvm) {
+		llvm = LLVM::load(sys);
+	}
+	if (!options.check && !llvm) {
+		terminal.err("Could not load libLLVM. Ensure a dynamic libLLVM library is installed on your system or in the current working directory\n");
+		return 1;
+	}
+	auto& backend = options.check ? *null : *llvm;
 
-		if (!ast->codegen(*cg)) {
+	// The dumps are a side effect of compiling so caching is disabled for them.
+	Maybe<ObjectCache> cache;
+	if (cache_dir && !options.dump_ast && !options.dump_ir && !options.check) {
+		auto id = build_id(sys, allocator, exe);
+		if (!id) {
+			terminal.err("Could not identify compiler build for --cache-dir\n");
 			return 1;
 		}
-
-		auto machine = CgMachine::make(terminal, *llvm, "x86_64-unknown-none");
-		if (!machine) {
+		unsigned major = 0, minor = 0, patch = 0;
+		llvm->GetVersion(&major, &minor, &patch);
+		auto seed = Hash{}.value(*id)
+		                  .value(major)
+		                  .value(minor)
+		                  .value(patch)
+		                  .string(options.triple)
+		                  .value(options.opt)
+		                  .result();
+		cache.emplace(sys, *cache_dir, seed);
+		if (!cache->init()) {
+			terminal.err("Could not create cache directory: '%S'\n", *cache_dir);
 			return 1;
 		}
+		options.cache = &*cache;
+	}
 
-		if (!cg->optimize(*machine, opt)) {
-			return 1;
-		}
+	// A single unit has its functions generated on all the jobs instead. The
+	// dumps are written straight from each partition so they are not split. The
+	// partial objects are only of use to a link so a bare metal build without an
+	// output is never partitioned.
+	const Bool links = !bm || output;
+	if (jobs > 1 && (whole_program || sources.length() == 1) && links && !options.check && !options.dump_ast && !options.dump_ir) {
+		options.partitions = jobs;
+	}
+
+	// Bare metal builds with an output are linked in-process so the objects are
+	// never written out.
+	Objects objects{allocator};
+	const Bool in_process = bm && output && !options.check;
+	const Bool single = whole_program || options.partitions > 1;
+	if (in_process && !objects.resize(single ? options.partitions : sources.length())) {
+		terminal.err("Out of memory\n");
+		return 1;
+	}
+	auto mem = [&](Ulen i) { return in_process ? &objects[i] : nullptr; };
 
-		if (dump_ir && !cg->dump()) {
+	if (whole_program) {
+		// Everything goes into the object file of the first source.
+		if (!compile(sys, sources, Range{0, sources.length()}, mem(0), options, backend, terminal, allocator)) {
 			return 1;
 		}
+	} else if (jobs <= 1 || sources.length() == 1) {
+		for (Ulen l = sources.length(), i = 0; i < l; i++) {
+			if (!compile(sys, sources, Range{i, 1}, mem(i), options, backend, terminal, allocator)) {
+				return 1;
+			}
+		}
+	} else if (!compile_parallel(sys, sources, in_process ? &objects : nullptr, options, backend, allocator, jobs)) {
+		return 1;
+	}
 
-		// Strip everything up to including '.'
-		auto dot = source.name.find_last_of('.');
-		auto name = source.name.slice(0, *dot);
+	if (cache) {
+		terminal.err("Cache: %zu hits, %zu misses\n", cache->hits(), cache->misses());
+	}
 
-		// Build "name.o"
-		StringBuilder obj{allocator};
-		obj.append(name);
-		obj.append('.');
-		obj.append('o');
-		if (!obj.valid()) {
-			terminal.err("Out of memory\n");
-			return 1;
+	if (in_process) {
+		Linker linker{sys, terminal, allocator};
+		for (Ulen l = objects.length(), i = 0; i < l; i++) {
+			// A unit found in the cache has a single object even with partitions.
+			if (!objects[i]) {
+				continue;
+			}
+			if (!linker.add(sources[single ? 0 : i].name, *objects[i])) {
+				terminal.err("Out of memory\n");
+				return 1;
+			}
 		}
-
-		if (auto name = obj.view(); !cg->emit(*machine, name)) {
-			terminal.err("Could not write object file: '%S'\n", name);
+		if (!linker.link(*output, entry)) {
+			terminal.err("Could not link executable: '%S'\n", *output);
 			return 1;
 		}
-	}
-
-	if (!bm) {
-		// Build "gcc name.o -o name"
+	} else if (!bm && !options.check) {
+		// Build "gcc name.o -o name", a partitioned unit is linked from its partial
+		// objects "name.i.o" instead.
 		StringBuilder link{allocator};
 		link.append("gcc");
 		link.append(' ');
 		for (const auto& source : sources) {
+			if (whole_program && &source != &sources[0]) {
+				break;
+			}
 			auto dot = source.name.find_last_of('.');
 			auto name = source.name.slice(0, *dot);
-			link.append(name);
-			link.append('.');
-			link.append('o');
-			link.append(' ');
+			if (options.partitions > 1) {
+				for (Ulen i = 0; i < options.partitions; i++) {
+					object_path(link, name, i);
+					link.append(' ');
+				}
+			} else {
+				object_path(link, name, None{});
+				link.append(' ');
+			}
 		}
-		link.append("-o a.out");
+		link.append("-o ");
+		link.append(output ? *output : StringView{"a.out"});
 		link.append('\0');
 		if (!link.valid()) {
 			terminal.err("Out of memory\n");
@@ -201,3 +960,202 @@ int main(int argc, char **argv) {
 
 	return 0;
 }
+
+// Handles a single request of the compile server. A request is the length of
+// the payload followed by the payload itself: the working directory of the
+// client and then its arguments, each NUL terminated. The response is the
+// buffered output, the buffered errors and the exit status.
+static void serve_one(const System& sys,
+                      Allocator& allocator,
+                      Maybe<LLVM>& llvm,
+                      Machines& machines,
+                      StringView exe,
+                      const Socket& client) noexcept
+{
+	Uint32 length = 0;
+	if (!client.read(&length, sizeof length) || length == 0 || length > 1024 * 1024) {
+		return;
+	}
+	Array<char> request{allocator};
+	if (!request.resize(length + 1) || !client.read(request.data(), length)) {
+		return;
+	}
+	request[length] = '\0';
+
+	Array<char*> args{allocator};
+	for (Ulen i = 0; i < length; i += strlen(&request[i]) + 1) {
+		if (!args.push_back(&request[i])) {
+			return;
+		}
+	}
+
+	Terminal terminal{sys, true};
+	Sint32 status = 1;
+	if (!sys.dir_change(sys, StringView{args[0]})) {
+		terminal.err("Could not change directory to '%s'\n", args[0]);
+	} else {
+		status = run(sys, terminal, allocator, llvm, &machines, exe, args.length() - 1, args.data() + 1);
+	}
+
+	terminal.drain([&](StringView out, StringView err) {
+		const Uint32 out_length = out.length();
+		const Uint32 err_length = err.length();
+		(void)(client.write(&out_length, sizeof out_length)
+		    && client.write(out.data(), out_length)
+		    && client.write(&err_length, sizeof err_length)
+		    && client.write(err.data(), err_length)
+		    && client.write(&status, sizeof status));
+	});
+}
+
+// Everything a request of the compile server allocates comes from an arena which
+// is rewound after it, so memory is not returned to the system and taken back for
+// every request. A request can generate on threads with -j so allocations are
+// made under a lock.
+struct ServerArena : Allocator {
+	ServerArena(Allocator& allocator, Mutex&& mutex) noexcept
+		: m_arena{allocator}
+		, m_mutex{move(mutex)}
+	{
+	}
+	virtual void* allocate(Ulen size) noexcept override {
+		m_mutex.lock();
+		auto addr = m_arena.allocate(size);
+		m_mutex.unlock();
+		return addr;
+	}
+	virtual void deallocate(void* old, Ulen size) noexcept override {
+		m_mutex.lock();
+		m_arena.deallocate(old, size);
+		m_mutex.unlock();
+	}
+	void rewind() noexcept {
+		m_arena.rewind();
+	}
+private:
+	ArenaAllocator m_arena;
+	Mutex          m_mutex;
+};
+
+// Keeps libLLVM loaded and serves compile requests on the socket |path| one at a
+// time. The working directory is changed for every request so they cannot run
+// concurrently, a request can still make use of -j though.
+static int serve(const System& sys,
+                 Terminal& terminal,
+                 Allocator& allocator,
+                 Maybe<LLVM>& llvm,
+                 StringView exe,
+                 StringView path) noexcept
+{
+	if (!(llvm = LLVM::load(sys))) {
+		terminal.err("Could not load libLLVM. Ensure a dynamic libLLVM library is installed on your system or in the current working directory\n");
+		return 1;
+	}
+	auto server = Socket::listen(sys, path);
+	if (!server) {
+		terminal.err("Could not listen on '%S'\n", path);
+		return 1;
+	}
+	auto machines_mutex = Mutex::make(sys);
+	auto arena_mutex = Mutex::make(sys);
+	if (!machines_mutex || !arena_mutex) {
+		terminal.err("Out of memory\n");
+		return 1;
+	}
+	// Both outlive the requests. The machines are made from |allocator| since the
+	// arena is rewound after every request.
+	Machines machines{allocator, move(*machines_mutex)};
+	ServerArena arena{allocator, move(*arena_mutex)};
+	terminal.out("Listening on '%S'\n", path);
+	for (;;) {
+		if (auto client = server->accept()) {
+			serve_one(sys, arena, llvm, machines, exe, *client);
+		}
+		arena.rewind();
+	}
+	return 0;
+}
+
+// Forwards the arguments to the compile server on the socket |path| and writes
+// out the response. Returns None when there is no server to talk to.
+static Maybe<int> forward(const System& sys,
+                          Terminal& terminal,
+                          Allocator& allocator,
+                          StringView path,
+                          int argc,
+                          char** argv) noexcept
+{
+	auto server = Socket::connect(sys, path);
+	if (!server) {
+		return None{};
+	}
+
+	StringBuilder request{allocator};
+	if (!sys.dir_current(sys, request)) {
+		return None{};
+	}
+	request.append('\0');
+	for (int i = 0; i < argc; i++) {
+		request.append(StringView{argv[i], strlen(argv[i])});
+		request.append('\0');
+	}
+	if (!request.valid()) {
+		return None{};
+	}
+
+	const Uint32 length = request.length();
+	if (!server->write(&length, sizeof length) || !server->write(request.data(), length)) {
+		return None{};
+	}
+
+	Array<char> out{allocator};
+	Array<char> err{allocator};
+	auto read = [&](Array<char>& dst) {
+		Uint32 length = 0;
+		return server->read(&length, sizeof length)
+		    && dst.resize(length)
+		    && server->read(dst.data(), length);
+	};
+	Sint32 status = 1;
+	if (!read(out) || !read(err) || !server->read(&status, sizeof status)) {
+		return None{};
+	}
+	if (!out.empty()) {
+		terminal.out(StringView{out.data(), out.length()});
+	}
+	if (!err.empty()) {
+		terminal.err(StringView{err.data(), err.length()});
+	}
+	return status;
+}
+
+int main(int argc, char **argv) {
+	const System& sys = SYSTEM;
+
+	SystemAllocator allocator{sys};
+	Terminal terminal{sys};
+
+	const StringView exe{argv[0], strlen(argv[0])};
+	argc--;
+	argv++;
+
+	Maybe<LLVM> llvm;
+	if (argc >= 1 && (StringView{argv[0]} == "--server" || StringView{argv[0]} == "--connect")) {
+		if (argc == 1) {
+			terminal.err("Missing socket for %s\n", argv[0]);
+			return 1;
+		}
+		const StringView path{argv[1], strlen(argv[1])};
+		if (StringView{argv[0]} == "--server") {
+			return serve(sys, terminal, allocator, llvm, exe, path);
+		}
+		if (auto status = forward(sys, terminal, allocator, path, argc - 2, argv + 2)) {
+			return *status;
+		}
+		// There is no server so compile in this process instead.
+		argc -= 2;
+		argv += 2;
+	}
+
+	return run(sys, terminal, allocator, llvm, nullptr, exe, argc, argv);
+}
@@ -0,0 +1,98 @@
+#include <biron/object_cache.h>
+
+#include <biron/util/system.inl>
+#include <biron/util/file.h>
+
+namespace Biron {
+
+Bool ObjectCache::init() noexcept {
+	return m_system.dir_create(m_system, m_dir);
+}
+
+Bool ObjectCache::path(StringBuilder& builder, const Key& key) const noexcept {
+	// Build "dir/0123456789abcdef0123456789abcdef.o"
+	builder.append(m_dir);
+	builder.append('/');
+	const Uint64 halves[] = { key.hi(), key.lo() };
+	for (const auto half : halves) {
+		for (Ulen i = 0; i < 16; i++) {
+			builder.append("0123456789abcdef"[(half >> (60 - i * 4)) & 0xf]);
+		}
+	}
+	builder.append('.');
+	builder.append('o');
+	return builder.valid();
+}
+
+Bool ObjectCache::load(const Key& key, StringView dst) noexcept {
+	SystemAllocator allocator{m_system};
+	StringBuilder src{allocator};
+	if (path(src, key) && m_system.file_copy(m_system, src.view(), dst)) {
+		m_hits++;
+		return true;
+	}
+	m_misses++;
+	return false;
+}
+
+Maybe<Array<Uint8>> ObjectCache::load(const Key& key, Allocator& allocator) noexcept {
+	SystemAllocator scratch{m_system};
+	StringBuilder src{scratch};
+	if (path(src, key)) {
+		if (auto file = File::open(m_system, src.view())) {
+			Array<Uint8> object{allocator};
+			const auto length = file->size();
+			if (length && object.resize(length) && file->read(0, object.data(), length) == length) {
+				m_hits++;
+				return object;
+			}
+		}
+	}
+	m_misses++;
+	return None{};
+}
+
+Bool ObjectCache::store(const Key& key, StringView src) noexcept {
+	SystemAllocator allocator{m_system};
+	StringBuilder dst{allocator};
+	if (!path(dst, key)) {
+		return false;
+	}
+	return m_system.file_copy(m_system, src, dst.view());
+}
+
+Bool ObjectCache::store(const Key& key, const Array<Uint8>& src) noexcept {
+	SystemAllocator allocator{m_system};
+	StringBuilder dst{allocator};
+	StringBuilder tmp{allocator};
+	if (!path(dst, key)) {
+		return false;
+	}
+	// Write to a temporary file unique to this process and thread then rename it
+	// into place so a concurrent load never sees a partial object.
+	const auto nonce = Hash{}.value(m_system.clock_now(m_system))
+	                         .value(reinterpret_cast<Uint64>(&tmp))
+	                         .result();
+	tmp.append(dst.view());
+	tmp.append('.');
+	tmp.append(nonce);
+	if (!tmp.valid()) {
+		return false;
+	}
+	Bool ok = false;
+	{
+		auto file = File::open(m_system, tmp.view(), FileAccess::WR);
+		if (!file) {
+			return false;
+		}
+		ok = file->write(0, src.data(), src.length()) == src.length();
+	}
+	// Do not leave a partial or orphaned temporary behind in the cache.
+	if (!ok || !m_system.file_rename(m_system, tmp.view(), dst.view())) {
+		m_system.file_remove(m_system, tmp.view());
+		return false;
+	}
+	return true;
+}
+
+} // namespace Biron
@@ -0,0 +1,90 @@
+#ifndef BIRON_OBJECT_CACHE_H
+#define BIRON_OBJECT_CACHE_H
+#include <biron/util/allocator.h> // Atomic
+#include <biron/util/array.inl>
+#include <biron/util/string.h>
+#include <biron/util/hash.inl>
+
+namespace Biron {
+
+struct System;
+
+// Content addressed cache of object files. Entries are named by a key which is
+// the hash of the source code combined with a seed capturing everything else
+// which influences code generation: the compiler build, LLVM version, target
+// triple and optimization level.
+struct ObjectCache {
+	// The key is 128-bit, two 64-bit hashes of the same input seeded differently.
+	// An entry is never verified against the source so a single 64-bit hash makes
+	// serving the object of another source on a collision too likely for a cache
+	// shared by many builds.
+	struct Key {
+		constexpr Key(Uint64 seed) noexcept
+			: m_lo{seed}
+			, m_hi{seed ^ 0x9e3779b97f4a7c15_u64}
+		{
+		}
+		constexpr Key& string(StringView view) noexcept {
+			m_lo.string(view);
+			m_hi.string(view);
+			return *this;
+		}
+		[[nodiscard]] constexpr Uint64 lo() const noexcept { return m_lo.result(); }
+		[[nodiscard]] constexpr Uint64 hi() const noexcept { return m_hi.result(); }
+	private:
+		Hash m_lo;
+		Hash m_hi;
+	};
+
+	constexpr ObjectCache(const System& system, StringView dir, Uint64 seed) noexcept
+		: m_system{system}
+		, m_dir{dir}
+		, m_seed{seed}
+		, m_hits{0}
+		, m_misses{0}
+	{
+	}
+
+	ObjectCache(ObjectCache&& other) noexcept
+		: m_system{other.m_system}
+		, m_dir{other.m_dir}
+		, m_seed{other.m_seed}
+		, m_hits{other.m_hits.load()}
+		, m_misses{other.m_misses.load()}
+	{
+	}
+
+	// Creates the cache directory if it does not exist.
+	[[nodiscard]] Bool init() noexcept;
+
+	// The key is built by hashing the source code into this.
+	[[nodiscard]] Key key() const noexcept { return Key{m_seed}; }
+
+	// Copies the cached object for |key| to |dst|. Returns false on a miss.
+	[[nodiscard]] Bool load(const Key& key, StringView dst) noexcept;
+
+	// Reads the cached object for |key| into memory. Returns None on a miss.
+	[[nodiscard]] Maybe<Array<Uint8>> load(const Key& key, Allocator& allocator) noexcept;
+
+	// Copies the object |src| into the cache under |key|.
+	Bool store(const Key& key, StringView src) noexcept;
+
+	// Writes the in-memory object |src| into the cache under |key|.
+	Bool store(const Key& key, const Array<Uint8>& src) noexcept;
+
+	[[nodiscard]] Ulen hits() const noexcept { return m_hits.load(); }
+	[[nodiscard]] Ulen misses() const noexcept { return m_misses.load(); }
+
+private:
+	Bool path(StringBuilder& builder, const Key& key) const noexcept;
+
+	const System& m_system;
+	StringView    m_dir;
+	Uint64        m_seed;
+	Atomic<Ulen>  m_hits;
+	Atomic<Ulen>  m_misses;
+};
+
+} // namespace Biron
+
+#endif // BIRON_OBJECT_CACHE_H
@@ -21,6 +21,7 @@ namespace Biron {
 //	  | PtrType
 //	  | AtomType
 //	  | ArrayType
+//	  | VectorType
 //	  | SliceType
 //	  | FnType
 //	  | ArgsType
@@ -60,6 +61,9 @@ AstType* Parser::parse_type() noexcept {
 		case Token::Kind::LBRACKET:
 			type = parse_bracket_type(move(attrs));
 			break;
+		case Token::Kind::HASH:
+			type = parse_vector_type(move(attrs));
+			break;
 		case Token::Kind::KW_FN:
 			type = parse_fn_type(move(attrs));
 			break;
@@ -103,8 +107,11 @@ AstIdentType* Parser::parse_ident_type(Array<AstAttr*>&& attrs) noexcept {
 		return ERROR("Expected identifier");
 	}
 	auto token = next(); // consume Ident
-	auto name = m_lexer.string(token.range);
-	return new_node<AstIdentType>(name, move(attrs), token.range);
+	auto name = intern(token.range);
+	if (!name) {
+		return oom();
+	}
+	return new_node<AstIdentType>(*name, move(attrs), token.range);
 }
 
 // TupleType
@@ -129,7 +136,7 @@ AstTupleType* Parser::parse_tuple_type(Maybe<Array<AstAttr*>>&& attrs) noexcept
 				if (!type) {
 					return nullptr;
 				}
-				if (!elems.emplace_back(ident->name(), type)) {
+				if (!elems.emplace_back(ident->name().string(), type)) {
 					return oom();
 				}
 			} else {
@@ -178,6 +185,33 @@ AstAtomType* Parser::parse_atom_type(Array<AstAttr*>&& attrs) noexcept {
 	return new_node<AstAtomType>(type, move(attrs), type->range());
 }
 
+// VectorType
+//	::= '#' '[' <Expr> ']' <Type>
+AstVectorType* Parser::parse_vector_type(Array<AstAttr*>&& attrs) noexcept {
+	if (peek().kind != Token::Kind::HASH) {
+		return ERROR("Expected '#'");
+	}
+	auto beg_token = next(); // Consume '#'
+	if (peek().kind != Token::Kind::LBRACKET) {
+		return ERROR("Expected '['");
+	}
+	next(); // Consume '['
+	auto expr = parse_expr(0);
+	if (!expr) {
+		return nullptr;
+	}
+	if (peek().kind != Token::Kind::RBRACKET) {
+		return ERROR("Expected ']'");
+	}
+	next(); // Consume ']'
+	auto type = parse_type();
+	if (!type) {
+		return nullptr;
+	}
+	auto range = beg_token.range.include(type->range());
+	return new_node<AstVectorType>(type, expr, move(attrs), range);
+}
+
 // BracketType
 //	::= EnumType
 //	  | ArrayType
@@ -281,7 +315,7 @@ AstFnType* Parser::parse_fn_type(Array<AstAttr*>&& attrs) noexcept {
 		}
 	} else {
 		// When there are no objs we use an empty args.
-		objs = new_node<AstArgsType>(m_arena, Range{0, 0});
+		objs = new_node<AstArgsType>(AstList<AstArgsType::Elem>{}, Range{0, 0});
 		if (!objs) {
 			return nullptr;
 		}
@@ -320,7 +354,7 @@ AstFnType* Parser::parse_fn_type(Array<AstAttr*>&& attrs) noexcept {
 		}
 	} else {
 		// When there are no return types we return the "empty tuple"
-		ret = new_node<AstTupleType>(m_arena, m_arena, Range{0, 0});
+		ret = new_node<AstTupleType>(AstList<AstTupleType::Elem>{}, AstList<AstAttr*>{}, Range{0, 0});
 		if (!ret) {
 			return oom();
 		}
@@ -353,7 +387,7 @@ AstArgsType* Parser::parse_args_type() noexcept {
 				if (!type) {
 					return nullptr;
 				}
-				if (!elems.emplace_back(ident->name(), type)) {
+				if (!elems.emplace_back(ident->name().string(), type)) {
 					return oom();
 				}
 			} else {
@@ -650,8 +684,11 @@ AstExpr* Parser::parse_var_expr() noexcept {
 		return ERROR("Expected identifier");
 	}
 	auto token = next(); // Consume ident
-	auto name = m_lexer.string(token.range);
-	return new_node<AstVarExpr>(name, token.range);
+	auto name = intern(token.range);
+	if (!name) {
+		return oom();
+	}
+	return new_node<AstVarExpr>(*name, token.range);
 }
 
 // BoolExpr
@@ -944,7 +981,7 @@ AstExpr* Parser::parse_call_expr(Ulen call_depth, AstExpr* operand) noexcept {
 	auto range = operand->range().include(args->range());
 	Bool is_c = false;
 	if (operand->is_expr<AstVarExpr>()) {
-		is_c = static_cast<const AstVarExpr*>(operand)->name() == "printf";
+		is_c = static_cast<const AstVarExpr*>(operand)->name() == KnownSymbol::PRINTF;
 	}
 	return new_node<AstCallExpr>(operand, args, is_c, range);
 }
@@ -1159,7 +1196,10 @@ AstStmt* Parser::parse_let_stmt(Maybe<Array<AstAttr*>>&& attrs, Bool global) noe
 		return ERROR("Expected identifier after 'let'");
 	}
 	auto token = next(); // Consume Ident
-	auto name = m_lexer.string(token.range);
+	auto name = intern(token.range);
+	if (!name) {
+		return oom();
+	}
 	if (peek().kind != Token::Kind::EQ) {
 		return ERROR("Expected expression");
 	}
@@ -1174,12 +1214,12 @@ AstStmt* Parser::parse_let_stmt(Maybe<Array<AstAttr*>>&& attrs, Bool global) noe
 	next(); // Consume ';'
 	auto range = beg_token.range.include(init->range());
 	if (global) {
-		return new_node<AstGLetStmt>(name,
+		return new_node<AstGLetStmt>(*name,
 		                             init,
 		                             attrs ? move(*attrs) : AttrArray{m_arena},
 		                             range);
 	} else {
-		return new_node<AstLLetStmt>(name,
+		return new_node<AstLLetStmt>(*name,
 		                             init,
 		                             attrs ? move(*attrs) : AttrArray{m_arena},
 		                             range);
@@ -1198,7 +1238,10 @@ AstUsingStmt* Parser::parse_using_stmt() noexcept {
 		return ERROR("Expected identifier after 'using'");
 	}
 	auto token = next(); // Consume Ident
-	auto name = m_lexer.string(token.range);
+	auto name = intern(token.range);
+	if (!name) {
+		return oom();
+	}
 	if (peek().kind != Token::Kind::EQ) {
 		return ERROR("Expected expression");
 	}
@@ -1212,7 +1255,7 @@ AstUsingStmt* Parser::parse_using_stmt() noexcept {
 	}
 	next(); // Consume ';'
 	auto range = using_token.range.include(init->range());
-	return new_node<AstUsingStmt>(name, init, range);
+	return new_node<AstUsingStmt>(*name, init, range);
 }
 
 // ForStmt
@@ -1328,7 +1371,7 @@ AstFn* Parser::parse_fn(Array<AstAttr*>&& attrs) noexcept {
 		objs = parse_args_type();
 	} else {
 		// When there are no objs we use an "empty" argument list type.
-		objs = new_node<AstArgsType>(m_arena, Range{0, 0});
+		objs = new_node<AstArgsType>(AstList<AstArgsType::Elem>{}, Range{0, 0});
 	}
 	if (!objs) {
 		return ERROR("Could not parse recievers");
@@ -1337,7 +1380,10 @@ AstFn* Parser::parse_fn(Array<AstAttr*>&& attrs) noexcept {
 		return ERROR("Expected name for 'fn'");
 	}
 	auto token = next();
-	auto name = m_lexer.string(token.range); // Consume Ident
+	auto name = intern(token.range);
+	if (!name) {
+		return oom();
+	}
 
 	auto args = parse_args_type();
 	if (!args) {
@@ -1373,7 +1419,7 @@ AstFn* Parser::parse_fn(Array<AstAttr*>&& attrs) noexcept {
 		ret = parse_type();
 	} else {
 		// When there are no return types we return the "empty tuple"
-		ret = new_node<AstTupleType>(m_arena, m_arena, Range{0, 0});
+		ret = new_node<AstTupleType>(AstList<AstTupleType::Elem>{}, AstList<AstAttr*>{}, Range{0, 0});
 	}
 	if (!ret) {
 		return ERROR("Could not parse returns");
@@ -1384,7 +1430,7 @@ AstFn* Parser::parse_fn(Array<AstAttr*>&& attrs) noexcept {
 		return nullptr;
 	}
 	auto range = beg_token.range.include(body->range());
-	auto node = new_node<AstFn>(name, objs, args, move(effects), ret, body, move(attrs), range);
+	auto node = new_node<AstFn>(*name, objs, args, move(effects), ret, body, move(attrs), range);
 	if (!node) {
 		return oom();
 	}
@@ -1403,7 +1449,10 @@ AstTypedef* Parser::parse_typedef(Array<AstAttr*>&& attrs) noexcept {
 		return ERROR("Expected identifier");
 	}
 	auto ident = next();
-	auto name = m_lexer.string(ident.range);
+	auto name = intern(ident.range);
+	if (!name) {
+		return oom();
+	}
 	if (peek().kind != Token::Kind::EQ) {
 		return ERROR("Expected '='");
 	}
@@ -1417,7 +1466,7 @@ AstTypedef* Parser::parse_typedef(Array<AstAttr*>&& attrs) noexcept {
 	}
 	auto end_token = next(); // Consume ';'
 	auto range = beg_token.range.include(end_token.range);
-	return new_node<AstTypedef>(name, type, move(attrs), range);
+	return new_node<AstTypedef>(*name, type, move(attrs), range);
 }
 
 // Module
@@ -1455,9 +1504,12 @@ AstImport* Parser::parse_import() noexcept {
 		return ERROR("Expected ';'");
 	}
 	next(); // Consume ';'
-	auto ident_string = m_lexer.string(ident_token.range);
+	auto ident = intern(ident_token.range);
+	if (!ident) {
+		return oom();
+	}
 	auto range = import_token.range.include(ident_token.range);
-	return new_node<AstImport>(ident_string, range);
+	return new_node<AstImport>(*ident, range);
 }
 
 // Effect
@@ -1486,8 +1538,11 @@ AstEffect* Parser::parse_effect() noexcept {
 		return ERROR("Expected ';'");
 	}
 	next(); // Consume ';'
-	auto ident_string = m_lexer.string(ident_token.range);
-	return new_node<AstEffect>(ident_string, type, range);
+	auto ident = intern(ident_token.range);
+	if (!ident) {
+		return oom();
+	}
+	return new_node<AstEffect>(*ident, type, range);
 }
 
 // AttrList
@@ -1507,24 +1562,27 @@ Maybe<Array<AstAttr*>> Parser::parse_attrs() noexcept {
 			return ERROR("Expected identifier");
 		}
 		auto token = next(); // Consume IDENT
-		auto name = m_lexer.string(token.range);
-		/****/ if (name == "section") {
-		} else if (name == "align") {
-		} else if (name == "used") {
-		} else if (name == "inline") {
-		} else if (name == "aliasable") {
-		} else if (name == "redzone") {
-		} else if (name == "alignstack") {
-		} else if (name == "export") {
+		auto name = intern(token.range);
+		if (!name) {
+			return oom();
+		}
+		/****/ if (*name == KnownSymbol::SECTION) {
+		} else if (*name == KnownSymbol::ALIGN) {
+		} else if (*name == KnownSymbol::USED) {
+		} else if (*name == KnownSymbol::INLINE) {
+		} else if (*name == KnownSymbol::ALIASABLE) {
+		} else if (*name == KnownSymbol::REDZONE) {
+		} else if (*name == KnownSymbol::ALIGNSTACK) {
+		} else if (*name == KnownSymbol::EXPORT) {
 		} else {
-			return ERROR("Unknown attribute: '%S'", name);
+			return ERROR("Unknown attribute: '%S'", name->string());
 		}
 		auto args = parse_tuple_expr(0);
 		if (!args || args->length() != 1) {
 			return None{};
 		}
 		auto range = token.range.include(args->range());
-		auto attr = new_node<AstAttr>(name, args->at(0), range);
+		auto attr = new_node<AstAttr>(*name, args->at(0), range);
 		if (!attr) {
 			return None{};
 		}
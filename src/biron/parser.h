@@ -3,6 +3,7 @@
 #include <biron/lexer.h>
 #include <biron/ast_unit.h>
 #include <biron/diagnostic.h>
+#include <biron/symbol.h>
 #include <biron/util/pool.h>
 #include <biron/cg.h>
 
@@ -28,6 +29,7 @@ struct AstIdentType;
 struct AstVarArgsType;
 struct AstPtrType;
 struct AstAtomType;
+struct AstVectorType;
 struct AstFnType;
 
 struct AstStmt;
@@ -43,9 +45,10 @@ struct AstExprStmt;
 struct AstAssignStmt;
 
 struct Parser {
-	constexpr Parser(Lexer& lexer, Diagnostic& diagnostic, Allocator& allocator) noexcept
+	constexpr Parser(Lexer& lexer, Diagnostic& diagnostic, Symbols& symbols, Allocator& allocator) noexcept
 		: m_arena{allocator}
 		, m_lexer{lexer}
+		, m_symbols{symbols}
 		, m_in_defer{false}
 		, m_ast{m_arena}
 		, m_diagnostic{diagnostic}
@@ -56,6 +59,12 @@ struct Parser {
 
 	Maybe<Ast> parse() noexcept;
 
+	// Parse from tokens lexed up front rather than pulling them from the lexer.
+	void use(const Tokens& tokens) noexcept {
+		m_tokens = &tokens;
+		m_index = 0;
+	}
+
 private:
 	template<typename... Ts>
 	Error error(Range range, StringView message, Ts&&... args) const noexcept {
@@ -80,6 +89,11 @@ private:
 		return fatal("Out of memory while parsing");
 	}
 
+	// Interns the source text of |range|.
+	[[nodiscard]] Maybe<Symbol> intern(Range range) noexcept {
+		return m_symbols.intern(m_lexer.string(range));
+	}
+
 	// Types
 	[[nodiscard]] AstType*                parse_type() noexcept;
 	[[nodiscard]] AstIdentType*           parse_ident_type(Array<AstAttr*>&& attrs) noexcept;
@@ -87,6 +101,7 @@ private:
 	[[nodiscard]] AstPtrType*             parse_ptr_type(Array<AstAttr*>&& attrs) noexcept;
 	[[nodiscard]] AstAtomType*            parse_atom_type(Array<AstAttr*>&& attrs) noexcept;
 	[[nodiscard]] AstType*                parse_bracket_type(Array<AstAttr*>&& attrs) noexcept;
+	[[nodiscard]] AstVectorType*          parse_vector_type(Array<AstAttr*>&& attrs) noexcept;
 	[[nodiscard]] AstFnType*              parse_fn_type(Array<AstAttr*>&& attrs) noexcept;
 	[[nodiscard]] AstArgsType*            parse_args_type() noexcept; // meta type
 	[[nodiscard]] AstGroupType*           parse_group_type() noexcept; // meta t
@@ -140,16 +155,37 @@ private:
 			auto token = *m_peek_token;
 			m_peek_token.reset();
 			m_this_token = token;
+		} else if (m_tokens) {
+			m_this_token = (*m_tokens)[m_index];
+			// Stay on the END token
+			if (m_index + 1 < m_tokens->length()) {
+				m_index++;
+			}
 		} else {
 			m_this_token = m_lexer.next();
 		}
 		return m_this_token;
 	}
 	Token peek() noexcept {
-		// We can only peek LR(1)
 		m_peek_token = next();
 		return *m_peek_token;
 	}
+	// The token |n| ahead without consuming any, so peek(1) is peek(). Only the
+	// next token is kept, those after it are indexed from the token buffer or
+	// lexed again when there is none.
+	Token peek(Ulen n) noexcept {
+		const auto token = peek();
+		if (n <= 1) {
+			return token;
+		}
+		if (m_tokens) {
+			// next() has moved m_index past the peeked token unless it is the END.
+			const auto index = m_index + n - 2;
+			const auto last = m_tokens->length() - 1;
+			return (*m_tokens)[index < last ? index : last];
+		}
+		return m_lexer.ahead(n - 1);
+	}
 
 	template<typename T, typename... Ts>
 	[[nodiscard]] T* new_node(Ts&&... args) noexcept {
@@ -158,9 +194,12 @@ private:
 
 	ArenaAllocator m_arena;
 	Lexer& m_lexer;
+	Symbols& m_symbols;
 	Token m_this_token;
 	Token m_last_token;
 	Maybe<Token> m_peek_token;
+	const Tokens* m_tokens = nullptr;
+	Ulen m_index = 0;
 	Bool m_in_defer;
 	Ast m_ast;
 	Diagnostic& m_diagnostic;
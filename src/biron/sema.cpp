@@ -0,0 +1,490 @@
+#include <biron/sema.h>
+#include <biron/ast_expr.h>
+#include <biron/ast_stmt.h>
+#include <biron/ast_type.h>
+#include <biron/ast_unit.h>
+
+#include <biron/util/traits/is_same.inl>
+
+namespace Biron {
+
+Bool Sema::infer(const AstExpr* expr, CgType* want) noexcept {
+	return expr->gen_type(cg, want) != nullptr;
+}
+
+Maybe<CgBinding> Sema::lookup_let(Symbol name) const noexcept {
+	// A test hides the lets bound before it but not those bound after it.
+	if (auto test = tests.find(name)) {
+		auto let = lets.position(name);
+		if (!let || *let < test->lets) {
+			return test->binding;
+		}
+	}
+	if (auto find = lets.find(name)) {
+		return *find;
+	}
+	return None{};
+}
+
+Maybe<CgBinding> Sema::lookup_using(Symbol name) const noexcept {
+	if (auto find = usings.find(name)) {
+		return *find;
+	}
+	return None{};
+}
+
+Maybe<CgBinding> Sema::resolve(Symbol name) const noexcept {
+	if (auto let = lookup_let(name)) {
+		return let;
+	}
+	if (auto fn = cg.fns.find(name)) {
+		return CgBinding { CgBinding::Kind::FN, CgNode { nullptr }, fn->addr().type() };
+	}
+	if (auto global = cg.globals.find(name)) {
+		return CgBinding { CgBinding::Kind::GLOBAL, CgNode { nullptr }, global->var().addr().type() };
+	}
+	return None{};
+}
+
+Bool AstFn::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+
+	// When starting a new function we expect sema.scopes is empty
+	BIRON_ASSERT(sema.scopes.empty());
+
+	auto addr = cg.fn_addrs.find(this);
+	if (!addr) {
+		return false;
+	}
+
+	cg.fn = this;
+
+	// The annotations are only of the function lowered next.
+	cg.bindings.reset();
+	cg.constants.reset();
+	cg.inferred.reset();
+
+	if (!sema.enter_scope()) {
+		return false;
+	}
+
+	// The objs, args and effects are the locals of the function in that order,
+	// lowering numbers them the same way.
+	Ulen n = 0;
+	const AstArgsType* lists[] = { m_objs, m_args };
+	for (auto list : lists) {
+		for (const auto& elem : list->elems()) {
+			const auto local = CgNode { this, n++ };
+			auto name = elem.name();
+			if (!name) {
+				continue;
+			}
+			auto type = elem.type()->codegen(cg, None{});
+			if (!type) {
+				return false;
+			}
+			auto symbol = cg.symbols.intern(*name);
+			if (!symbol || !sema.bind(*symbol, local, type)) {
+				return cg.oom();
+			}
+		}
+	}
+
+	auto effects = addr->type()->deref()->at(2);
+	if (effects != cg.types.unit()) {
+		Ulen i = 0;
+		for (const auto& field : effects->fields()) {
+			const auto local = CgNode { this, n++ };
+			if (field.name) {
+				auto name = cg.symbols.intern(*field.name);
+				if (!name || !sema.bind_using(*name, local, effects->at(i))) {
+					return cg.oom();
+				}
+			}
+			i++;
+		}
+	}
+
+	if (!m_body->analyze(sema)) {
+		return false;
+	}
+
+	return sema.leave_scope();
+}
+
+Bool AstStmt::analyze(Sema& sema) const noexcept {
+	// Atomics are ordered by the MemoryOrder effect in scope at their statement,
+	// see Cg::memory_order.
+	auto& cg = sema.cg;
+	if (auto order = sema.lookup_using(cg.symbols[KnownSymbol::MEMORY_ORDER])) {
+		if (!sema.use(CgNode { this }, *order)) {
+			return cg.oom();
+		}
+	}
+	return visit([&]<typename T>(const T* stmt) -> Bool {
+		if constexpr (!is_same<decltype(&T::analyze), decltype(&AstStmt::analyze)>) {
+			return stmt->analyze(sema);
+		} else {
+			return true;
+		}
+	});
+}
+
+Bool AstBlockStmt::analyze(Sema& sema) const noexcept {
+	if (!sema.enter_scope()) {
+		return false;
+	}
+	for (auto stmt : m_stmts) {
+		if (!stmt->analyze(sema)) {
+			return false;
+		}
+	}
+	// The defers are lowered at the end of the scope so they see all of it.
+	const auto& defers = sema.scopes.last().defers;
+	for (Ulen l = defers.length(), i = l - 1; i < l; i--) {
+		if (!defers[i]->analyze(sema)) {
+			return false;
+		}
+	}
+	return sema.leave_scope();
+}
+
+Bool AstReturnStmt::analyze(Sema& sema) const noexcept {
+	if (!m_expr) {
+		return true;
+	}
+	auto& cg = sema.cg;
+	if (!m_expr->analyze(sema)) {
+		return false;
+	}
+	if (auto addr = cg.fn_addrs.find(cg.fn)) {
+		return sema.infer(m_expr, addr->type()->deref()->at(3));
+	}
+	return cg.error(range(), "Could not infer return type");
+}
+
+Bool AstDeferStmt::analyze(Sema& sema) const noexcept {
+	return sema.scopes.last().defers.push_back(m_stmt);
+}
+
+Bool AstBreakStmt::analyze(Sema& sema) const noexcept {
+	if (sema.loop()) {
+		return true;
+	}
+	return sema.cg.error(range(), "Cannot 'break' from outside a loop");
+}
+
+Bool AstContinueStmt::analyze(Sema& sema) const noexcept {
+	if (sema.loop()) {
+		return true;
+	}
+	return sema.cg.error(range(), "Cannot 'continue' from outside a loop");
+}
+
+Bool AstIfStmt::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	if (m_init && (!sema.enter_scope() || !m_init->analyze(sema))) {
+		return false;
+	}
+	if (!m_expr->analyze(sema) || !sema.infer(m_expr, cg.types.b32())) {
+		return false;
+	}
+	if (!m_then->analyze(sema)) {
+		return false;
+	}
+	// The flow-sensitive aliases of the condition only hold in the 'then' block.
+	sema.clear_tests();
+	if (m_elif && !m_elif->analyze(sema)) {
+		return false;
+	}
+	if (m_init) {
+		sema.leave_scope();
+	}
+	return true;
+}
+
+Bool AstLLetStmt::analyze(Sema& sema) const noexcept {
+	if (!m_init->analyze(sema)) {
+		return false;
+	}
+	auto type = m_init->gen_type(sema.cg, nullptr);
+	if (!type) {
+		return false;
+	}
+	return sema.bind(m_name, CgNode { this }, type);
+}
+
+Bool AstUsingStmt::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	auto effect = cg.effects.find(m_name);
+	if (!effect) {
+		return cg.error(range(), "Undeclared effect '%S'", m_name.string());
+	}
+	if (!m_init->analyze(sema) || !sema.infer(m_init, *effect)) {
+		return false;
+	}
+	return sema.bind_using(m_name, CgNode { this }, *effect);
+}
+
+Bool AstForStmt::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	if (!sema.enter_scope()) {
+		return false;
+	}
+	sema.scopes.last().loop = true;
+	if (m_init && !m_init->analyze(sema)) {
+		return false;
+	}
+	if (m_expr && (!m_expr->analyze(sema) || !sema.infer(m_expr, cg.types.b32()))) {
+		return false;
+	}
+	if (!m_body->analyze(sema)) {
+		return false;
+	}
+	if (m_post && !m_post->analyze(sema)) {
+		return false;
+	}
+	if (m_else && !m_else->analyze(sema)) {
+		return false;
+	}
+	return sema.leave_scope();
+}
+
+Bool AstExprStmt::analyze(Sema& sema) const noexcept {
+	if (auto expr = m_expr->to_expr<const AstTupleExpr>()) {
+		if (expr->length() == 0) {
+			return true;
+		}
+	}
+	return m_expr->analyze(sema) && sema.infer(m_expr, nullptr);
+}
+
+Bool AstAssignStmt::analyze(Sema& sema) const noexcept {
+	if (!m_dst->analyze(sema) || !m_src->analyze(sema)) {
+		return false;
+	}
+	auto dst = m_dst->gen_type(sema.cg, nullptr);
+	if (!dst) {
+		return false;
+	}
+	// An atomic is assigned a value of its base type.
+	return sema.infer(m_src, dst->is_atomic() ? dst->deref() : dst);
+}
+
+Bool AstExpr::analyze(Sema& sema) const noexcept {
+	auto analyzed = visit([&]<typename T>(const T* expr) -> Bool {
+		if constexpr (!is_same<decltype(&T::analyze), decltype(&AstExpr::analyze)>) {
+			return expr->analyze(sema);
+		} else {
+			return true;
+		}
+	});
+	if (!analyzed) {
+		return false;
+	}
+	// The operands are folded first so folding this only looks them up.
+	auto& cg = sema.cg;
+	if (auto value = eval_value(cg)) {
+		if (!cg.constants.insert(CgNode { this }, move(*value))) {
+			return cg.oom();
+		}
+	}
+	return true;
+}
+
+Bool AstTupleExpr::analyze(Sema& sema) const noexcept {
+	for (auto expr : m_exprs) {
+		if (!expr->analyze(sema)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Bool AstCallExpr::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	// A function or variable hides the free builtin of the same name so that is
+	// resolved first, see AstCallExpr::builtin.
+	if (auto callee = m_callee->to_expr<const AstVarExpr>()) {
+		auto binding = sema.resolve(callee->name());
+		if (binding && binding->kind != CgBinding::Kind::GLOBAL && !sema.use(CgNode { callee }, *binding)) {
+			return cg.oom();
+		}
+	}
+	// The builtins are not functions so there is no callee to resolve, only the
+	// receiver of an atomic method.
+	if (builtin(cg)) {
+		if (auto access = m_callee->to_expr<const AstAccessExpr>()) {
+			return access->lhs()->analyze(sema) && m_args->analyze(sema);
+		}
+		return m_args->analyze(sema);
+	}
+	if (!m_callee->analyze(sema) || !m_args->analyze(sema)) {
+		return false;
+	}
+
+	// The callee is typed the same way AstCallExpr::gen_type does it.
+	auto type = m_callee->gen_type(cg, nullptr);
+	if (!type) {
+		return false;
+	}
+	type = type->deref();
+	if (type->is_tuple()) {
+		type = type->at(0)->deref();
+	} else if (type->is_pointer()) {
+		type = type->deref();
+	}
+	if (!type->is_fn()) {
+		return true;
+	}
+
+	// Every effect of the callee must be in scope at the call, which passes them.
+	auto effects = type->at(2);
+	if (effects == cg.types.unit()) {
+		return true;
+	}
+	Ulen i = 0;
+	for (const auto& field : effects->fields()) {
+		const auto use = CgNode { this, i++ };
+		if (!field.name) {
+			continue;
+		}
+		auto name = cg.symbols.intern(*field.name);
+		if (!name) {
+			return cg.oom();
+		}
+		auto binding = sema.lookup_using(*name);
+		if (!binding) {
+			return cg.error(m_callee->range(), "This function requires the '%S' effect", *field.name);
+		}
+		if (!sema.use(use, *binding)) {
+			return cg.oom();
+		}
+	}
+	return true;
+}
+
+Bool AstVarExpr::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	auto binding = sema.resolve(m_name);
+	if (!binding) {
+		return cg.error(range(), "Could not find symbol '%S'", m_name.string());
+	}
+	if (!sema.use(CgNode { this }, *binding)) {
+		return cg.oom();
+	}
+	return true;
+}
+
+Bool AstAggExpr::analyze(Sema& sema) const noexcept {
+	for (auto expr : m_exprs) {
+		if (!expr->analyze(sema)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Bool AstBinExpr::analyze(Sema& sema) const noexcept {
+	return m_lhs->analyze(sema) && m_rhs->analyze(sema);
+}
+
+Bool AstLBinExpr::analyze(Sema& sema) const noexcept {
+	return m_lhs->analyze(sema) && m_rhs->analyze(sema);
+}
+
+Bool AstUnaryExpr::analyze(Sema& sema) const noexcept {
+	return m_operand->analyze(sema);
+}
+
+Bool AstIndexExpr::analyze(Sema& sema) const noexcept {
+	return m_operand->analyze(sema) && m_index->analyze(sema);
+}
+
+Bool AstExplodeExpr::analyze(Sema& sema) const noexcept {
+	return m_operand->analyze(sema);
+}
+
+Bool AstEffExpr::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	auto expr = expression();
+	if (!expr) {
+		return cg.error(m_operand->range(), "Expected expression for effect");
+	}
+	auto binding = sema.lookup_using(expr->name());
+	if (!binding) {
+		return cg.error(m_operand->range(), "Could not find effect '%S'", expr->name().string());
+	}
+	if (!sema.use(CgNode { this }, *binding)) {
+		return cg.oom();
+	}
+	return true;
+}
+
+Bool AstAccessExpr::analyze(Sema& sema) const noexcept {
+	if (!m_lhs->analyze(sema)) {
+		return false;
+	}
+	// The right-hand side names a field unless it is a method call.
+	if (m_rhs->is_expr<AstCallExpr>()) {
+		return m_rhs->analyze(sema);
+	}
+	return true;
+}
+
+Bool AstCastExpr::analyze(Sema& sema) const noexcept {
+	return m_operand->analyze(sema);
+}
+
+Bool AstTestExpr::analyze(Sema& sema) const noexcept {
+	auto& cg = sema.cg;
+	auto expr = m_type->to_expr<const AstTypeExpr>();
+	if (!expr) {
+		return cg.error(m_type->range(), "Expected type on left-hand side of 'is' operator");
+	}
+	auto type = expr->type()->codegen(cg, None{});
+	if (!type) {
+		return false;
+	}
+	auto operand = m_operand;
+	if (auto tuple = operand->to_expr<AstTupleExpr>(); tuple && tuple->length() == 1) {
+		operand = tuple->at(0);
+	}
+	if (!operand->analyze(sema)) {
+		return false;
+	}
+	auto operand_type = operand->gen_type(cg, nullptr);
+	if (!operand_type) {
+		return false;
+	}
+	if (!operand_type->is_union()) {
+		auto type_string = operand_type->to_string(*cg.scratch);
+		return cg.error(m_operand->range(), "Expected expression of union type on left-hand side of 'is' operator, got '%S' instead", type_string);
+	}
+	for (auto variant : operand_type->types()) {
+		if (*type != *variant) {
+			continue;
+		}
+		// An AstVarExpr is aliased as the variant, lowering gives it the storage of
+		// the variant.
+		if (auto var = operand->to_expr<AstVarExpr>()) {
+			if (!sema.add_test(var->name(), CgNode { this }, type)) {
+				return cg.oom();
+			}
+		}
+		return true;
+	}
+	auto want_type = type->to_string(*cg.scratch);
+	auto union_type = operand_type->to_string(*cg.scratch);
+	return cg.error(m_type->range(), "The type '%S' is not a variant of '%S'", want_type, union_type);
+}
+
+Bool AstPropExpr::analyze(Sema& sema) const noexcept {
+	// A name on the right-hand side may name a type rather than a value.
+	if (m_expr->is_expr<AstVarExpr>()) {
+		return true;
+	}
+	return m_expr->analyze(sema);
+}
+
+} // namespace Biron
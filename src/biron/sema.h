@@ -0,0 +1,108 @@
+#ifndef BIRON_SEMA_H
+#define BIRON_SEMA_H
+#include <biron/cg.h>
+
+namespace Biron {
+
+// The names of a scope live in Sema::lets, Sema::usings and Sema::tests, the
+// scope only remembers where they begin so leaving it can rewind them.
+struct SemaScope {
+	constexpr SemaScope(Allocator& allocator, Ulen lets, Ulen usings, Ulen tests) noexcept
+		: defers{allocator}, lets{lets}, usings{usings}, tests{tests}
+	{
+	}
+
+	Array<AstStmt*> defers;
+	Bool            loop = false;
+	Ulen            lets;   // Mark of Sema::lets when entered
+	Ulen            usings; // Mark of Sema::usings when entered
+	Ulen            tests;  // Mark of Sema::tests when entered
+};
+
+// A flow-sensitive type alias introduced by an 'is' test. It shadows the lets
+// bound before it, which are those before the mark of Sema::lets it was made at.
+struct SemaTest {
+	CgBinding binding;
+	Ulen      lets;
+};
+
+// Semantic analysis of a function ahead of lowering it to LLVM IR.
+//
+// Sema is the only place names are resolved. Every name a function uses is
+// bound to a local, a function or a global in Cg::bindings, every constant
+// expression is folded into Cg::constants and every expression is typed into
+// Cg::inferred. Lowering reads those and gives the locals their storage.
+struct Sema {
+	Sema(Cg& cg) noexcept
+		: cg{cg}
+		, scopes{cg.allocator}
+		, lets{cg.allocator}
+		, usings{cg.allocator}
+		, tests{cg.allocator}
+	{
+	}
+
+	[[nodiscard]] Bool enter_scope() noexcept {
+		return scopes.emplace_back(cg.allocator, lets.mark(), usings.mark(), tests.mark());
+	}
+	Bool leave_scope() noexcept {
+		const auto& scope = scopes.last();
+		lets.rewind(scope.lets);
+		usings.rewind(scope.usings);
+		tests.rewind(scope.tests);
+		return scopes.pop_back();
+	}
+
+	// Searches for the lexically closest loop
+	Bool loop() const noexcept {
+		for (Ulen l = scopes.length(), i = l - 1; i < l; i--) {
+			if (scopes[i].loop) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	[[nodiscard]] Bool bind(Symbol name, CgNode local, CgType* type) noexcept {
+		return lets.insert(name, CgBinding::Kind::LOCAL, local, type->addrof(cg));
+	}
+	[[nodiscard]] Bool bind_using(Symbol name, CgNode local, CgType* type) noexcept {
+		return usings.insert(name, CgBinding::Kind::LOCAL, local, type->addrof(cg));
+	}
+
+	// Flow-sensitive type aliases shadow the variables bound before them until
+	// they are cleared. They are kept apart from the lets so clearing them leaves
+	// the lets bound since in place.
+	[[nodiscard]] Bool add_test(Symbol name, CgNode local, CgType* type) noexcept {
+		auto binding = CgBinding { CgBinding::Kind::LOCAL, local, type->addrof(cg) };
+		return tests.insert(name, binding, lets.mark());
+	}
+	void clear_tests() noexcept {
+		tests.rewind(scopes.last().tests);
+	}
+
+	// Records that |use| names what |binding| is bound to.
+	[[nodiscard]] Bool use(CgNode use, const CgBinding& binding) noexcept {
+		return cg.bindings.insert(use, binding);
+	}
+
+	Maybe<CgBinding> lookup_let(Symbol name) const noexcept;
+	Maybe<CgBinding> lookup_using(Symbol name) const noexcept;
+
+	// Resolves |name| the way a variable is: the lets, then the functions and
+	// then the globals of the unit.
+	Maybe<CgBinding> resolve(Symbol name) const noexcept;
+
+	// Types |expr| where |want| is wanted, as lowering will ask for it.
+	[[nodiscard]] Bool infer(const AstExpr* expr, CgType* want) noexcept;
+
+	Cg&                          cg;
+	Array<SemaScope>             scopes;
+	ScopedMap<Symbol, CgBinding> lets;
+	ScopedMap<Symbol, CgBinding> usings;
+	ScopedMap<Symbol, SemaTest>  tests;
+};
+
+} // namespace Biron
+
+#endif // BIRON_SEMA_H
@@ -0,0 +1,73 @@
+#include <biron/symbol.h>
+#include <biron/util/hash.inl>
+
+namespace Biron {
+
+Bool Symbols::init() noexcept {
+	static constexpr const StringView KNOWN[] = {
+		#define SYMBOL(NAME, STRING) STRING,
+		#include <biron/symbol.inl>
+		#undef SYMBOL
+	};
+	for (const auto& known : KNOWN) {
+		if (!intern(known)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Maybe<Symbol> Symbols::intern(StringView string) noexcept {
+	// Keep the load factor at or below a half.
+	if ((m_entries.length() + 1) * 2 > m_slots.length() && !grow()) {
+		return None{};
+	}
+
+	const auto hash = Hash{}.string(string).result();
+	const auto mask = m_slots.length() - 1;
+	auto index = hash & mask;
+	for (;;) {
+		const auto entry = m_slots[index];
+		if (!entry) {
+			break;
+		}
+		if (entry->hash == hash && entry->string == string) {
+			return Symbol { entry };
+		}
+		index = (index + 1) & mask;
+	}
+
+	auto data = static_cast<char*>(m_arena.allocate(string.length()));
+	auto entry = m_arena.allocate_object<Symbol::Entry>();
+	if ((!data && string.length()) || !entry) {
+		return None{};
+	}
+	for (Ulen i = 0; i < string.length(); i++) {
+		data[i] = string[i];
+	}
+	new (entry, Nat{}) Symbol::Entry{StringView{data, string.length()}, hash, Uint32(m_entries.length())};
+	if (!m_entries.push_back(entry)) {
+		return None{};
+	}
+	m_slots[index] = entry;
+	return Symbol { entry };
+}
+
+Bool Symbols::grow() noexcept {
+	Array<const Symbol::Entry*> slots{m_slots.allocator()};
+	if (!slots.resize(m_slots.length() ? m_slots.length() * 2 : 64)) {
+		return false;
+	}
+	const auto mask = slots.length() - 1;
+	for (const auto entry : m_entries) {
+		auto index = entry->hash & mask;
+		while (slots[index]) {
+			index = (index + 1) & mask;
+		}
+		slots[index] = entry;
+	}
+	m_slots = move(slots);
+	return true;
+}
+
+} // namespace Biron
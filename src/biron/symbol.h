@@ -0,0 +1,75 @@
+#ifndef BIRON_SYMBOL_H
+#define BIRON_SYMBOL_H
+#include <biron/util/allocator.h>
+#include <biron/util/string.h>
+
+namespace Biron {
+
+// The symbols of symbol.inl, usable without a Symbols since their ids are fixed.
+enum class KnownSymbol : Uint32 {
+	#define SYMBOL(NAME, STRING) NAME,
+	#include <biron/symbol.inl>
+	#undef SYMBOL
+};
+
+// An interned string. Two symbols of the same Symbols are the same string if,
+// and only if, they are the same symbol so comparing them is a single compare.
+struct Symbol {
+	[[nodiscard]] constexpr Uint32 id() const noexcept { return m_entry->id; }
+	[[nodiscard]] constexpr StringView string() const noexcept { return m_entry->string; }
+	[[nodiscard]] constexpr Uint64 hash() const noexcept { return m_entry->hash; }
+	[[nodiscard]] friend constexpr Bool operator==(Symbol lhs, Symbol rhs) noexcept {
+		return lhs.m_entry == rhs.m_entry;
+	}
+	[[nodiscard]] friend constexpr Bool operator==(Symbol lhs, KnownSymbol rhs) noexcept {
+		return lhs.id() == Uint32(rhs);
+	}
+private:
+	friend struct Symbols;
+	struct Entry {
+		StringView string;
+		Uint64     hash;
+		Uint32     id;
+	};
+	constexpr Symbol(const Entry* entry) noexcept
+		: m_entry{entry}
+	{
+	}
+	const Entry* m_entry;
+};
+
+// Maps every distinct string to a Symbol with a dense id. The strings are
+// copied in so they need not outlive the Symbols. A Symbols is not thread safe,
+// every compilation has its own.
+struct Symbols {
+	constexpr Symbols(Allocator& allocator) noexcept
+		: m_arena{allocator}
+		, m_slots{allocator}
+		, m_entries{allocator}
+	{
+	}
+
+	// Interns the known symbols.
+	[[nodiscard]] Bool init() noexcept;
+
+	// Returns the symbol for |string|, interning it the first time. Returns None
+	// when out of memory.
+	[[nodiscard]] Maybe<Symbol> intern(StringView string) noexcept;
+
+	[[nodiscard]] Symbol operator[](KnownSymbol known) const noexcept {
+		return m_entries[Uint32(known)];
+	}
+
+	[[nodiscard]] Ulen length() const noexcept { return m_entries.length(); }
+
+private:
+	[[nodiscard]] Bool grow() noexcept;
+
+	ArenaAllocator              m_arena;   // Entries and their strings
+	Array<const Symbol::Entry*> m_slots;   // Open addressing, power of two
+	Array<const Symbol::Entry*> m_entries; // Indexed by id
+};
+
+} // namespace Biron
+
+#endif // BIRON_SYMBOL_H
@@ -0,0 +1,74 @@
+#ifndef SYMBOL
+#define SYMBOL(...)
+#endif
+
+// Names the compiler itself needs to recognize. These are interned first by
+// every Symbols so they always have the same ids.
+
+// Attributes
+SYMBOL(SECTION,    "section")
+SYMBOL(ALIGN,      "align")
+SYMBOL(USED,       "used")
+SYMBOL(INLINE,     "inline")
+SYMBOL(ALIASABLE,  "aliasable")
+SYMBOL(REDZONE,    "redzone")
+SYMBOL(ALIGNSTACK, "alignstack")
+SYMBOL(EXPORT,     "export")
+
+// Properties, 'align' is shared with the attribute
+SYMBOL(SIZE,       "size")
+SYMBOL(COUNT,      "count")
+SYMBOL(TYPE,       "type")
+
+// Builtin types
+SYMBOL(UINT8,      "Uint8")
+SYMBOL(UINT16,     "Uint16")
+SYMBOL(UINT32,     "Uint32")
+SYMBOL(UINT64,     "Uint64")
+SYMBOL(SINT8,      "Sint8")
+SYMBOL(SINT16,     "Sint16")
+SYMBOL(SINT32,     "Sint32")
+SYMBOL(SINT64,     "Sint64")
+SYMBOL(BOOL8,      "Bool8")
+SYMBOL(BOOL16,     "Bool16")
+SYMBOL(BOOL32,     "Bool32")
+SYMBOL(BOOL64,     "Bool64")
+SYMBOL(REAL32,     "Real32")
+SYMBOL(REAL64,     "Real64")
+SYMBOL(STRING,     "String")
+SYMBOL(ADDRESS,    "Address")
+SYMBOL(LENGTH,     "Length")
+
+// Builtin functions and intrinsics
+SYMBOL(PRINTF,     "printf")
+SYMBOL(MEMORY_EQ,  "memory_eq")
+SYMBOL(MEMORY_NE,  "memory_ne")
+
+// Builtin effects
+SYMBOL(MEMORY_ORDER, "MemoryOrder")
+
+// Builtins lowered by the call, these must stay together and in this order
+SYMBOL(SHUFFLE,    "shuffle")
+SYMBOL(SELECT,     "select")
+SYMBOL(REDUCE_ADD, "reduce_add")
+SYMBOL(REDUCE_MUL, "reduce_mul")
+SYMBOL(REDUCE_MIN, "reduce_min")
+SYMBOL(REDUCE_MAX, "reduce_max")
+SYMBOL(REDUCE_AND, "reduce_and")
+SYMBOL(REDUCE_OR,  "reduce_or")
+SYMBOL(REDUCE_XOR, "reduce_xor")
+SYMBOL(FENCE,      "fence")
+
+// Atomic methods, these follow the builtins
+SYMBOL(FETCH_ADD,        "fetch_add")
+SYMBOL(FETCH_SUB,        "fetch_sub")
+SYMBOL(FETCH_AND,        "fetch_and")
+SYMBOL(FETCH_OR,         "fetch_or")
+SYMBOL(FETCH_XOR,        "fetch_xor")
+SYMBOL(EXCHANGE,         "exchange")
+SYMBOL(COMPARE_EXCHANGE, "compare_exchange")
+
+// LLVM intrinsics, see intrinsic.inl
+#define INTRINSIC(NAME, STRING, ...) SYMBOL(NAME, STRING)
+#include <biron/intrinsic.inl>
+#undef INTRINSIC
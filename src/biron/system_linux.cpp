@@ -1,11 +1,22 @@
-#include <stdlib.h> // malloc, free
-#include <string.h> // memcpy
-#include <stdio.h> // fopen, FILE, fclose, fseek, fread
+#include <stdlib.h> // malloc, free, mkstemp
+#include <string.h> // memcpy, memset, strlen
+#include <stdio.h> // fopen, fdopen, FILE, fclose, fseek, fread, fwrite, rename
 
 #include <dlfcn.h> // dlopen, dlclose, dlsym, RTLD_NOW
 
+#include <sys/mman.h> // mmap, munmap, PROT_READ, MAP_PRIVATE, MAP_FAILED
+#include <sys/stat.h> // fstat, stat, mkdir, fchmod, struct stat
+#include <sys/sendfile.h> // sendfile
+#include <fcntl.h> // open, O_RDONLY, O_WRONLY, O_CREAT, O_TRUNC
+#include <unistd.h> // close, unlink, getcwd, chdir
+#include <errno.h> // errno, EEXIST, EINTR, EADDRINUSE, ESPIPE
+#include <time.h> // clock_gettime, CLOCK_MONOTONIC
+
 #include <pthread.h> // pthread_t, pthread_mutex_t, pthread_cond_t
 
+#include <sys/socket.h> // socket, bind, listen, accept, connect, send, recv
+#include <sys/un.h> // sockaddr_un
+
 #include <biron/util/system.inl>
 
 namespace Biron {
@@ -19,7 +30,8 @@ static void mem_deallocate(const System&, void* memory, Ulen) noexcept {
 }
 
 static SysFile* file_open(const System& system,
-                          StringView filename) noexcept
+                          StringView filename,
+                          FileAccess access) noexcept
 {
 	SystemAllocator allocator{system};
 	ScratchAllocator scratch{allocator};
@@ -27,7 +39,22 @@ static SysFile* file_open(const System& system,
 	if (!name) {
 		return nullptr;
 	}
-	FILE* fp = fopen(name, "rb");
+	FILE* fp = nullptr;
+	switch (access) {
+	case FileAccess::RD:
+		fp = fopen(name, "rb");
+		break;
+	case FileAccess::WR:
+		fp = fopen(name, "wb");
+		break;
+	case FileAccess::EX:
+		if (auto fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0755); fd != -1) {
+			if (!(fp = fdopen(fd, "wb"))) {
+				close(fd);
+			}
+		}
+		break;
+	}
 	scratch.deallocate(name, filename.length() + 1);
 	if (!fp) {
 		return nullptr;
@@ -49,11 +76,149 @@ static Uint64 file_read(const System&,
 	if (feof(fp) != 0) {
 		return 0;
 	}
+	// Pipes cannot seek and are only ever read in order.
+	if (fseek(fp, offset, SEEK_SET) != 0 && errno != ESPIPE) {
+		return 0;
+	}
+	return fread(data, 1, length, fp);
+}
+
+static Uint64 file_write(const System&,
+                         SysFile* file,
+                         Uint64 offset,
+                         const void* data,
+                         Uint64 length) noexcept
+{
+	auto fp = reinterpret_cast<FILE *>(file);
 	if (fseek(fp, offset, SEEK_SET) != 0) {
 		return 0;
 	}
-	fread(data, length, 1, fp);
-	return ftell(fp) - offset;
+	return fwrite(data, 1, length, fp);
+}
+
+static Uint64 file_size(const System&, SysFile* file) noexcept {
+	struct stat buf;
+	if (fstat(fileno(reinterpret_cast<FILE *>(file)), &buf) != 0) {
+		return 0;
+	}
+	return buf.st_size;
+}
+
+static void* file_map(const System&, SysFile* file, Uint64 length) noexcept {
+	auto fd = fileno(reinterpret_cast<FILE *>(file));
+	auto addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) {
+		return nullptr;
+	}
+	return addr;
+}
+
+static void file_unmap(const System&, void* addr, Uint64 length) noexcept {
+	munmap(addr, length);
+}
+
+// Copies through a temporary file which is then renamed over the destination so
+// that readers never observe a partially written file.
+static Bool file_copy(const System& system, StringView src, StringView dst) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto src_name = src.terminated(scratch);
+	StringBuilder tmp{scratch};
+	tmp.append(dst);
+	tmp.append(".XXXXXX");
+	tmp.append('\0');
+	auto dst_name = dst.terminated(scratch);
+	if (!src_name || !tmp.valid() || !dst_name) {
+		return false;
+	}
+	auto src_fd = open(src_name, O_RDONLY);
+	if (src_fd < 0) {
+		return false;
+	}
+	struct stat buf;
+	if (fstat(src_fd, &buf) != 0) {
+		close(src_fd);
+		return false;
+	}
+	auto dst_fd = mkstemp(tmp.data());
+	if (dst_fd < 0) {
+		close(src_fd);
+		return false;
+	}
+	Bool ok = fchmod(dst_fd, 0644) == 0;
+	for (off_t offset = 0; ok && offset < buf.st_size; ) {
+		if (sendfile(dst_fd, src_fd, &offset, buf.st_size - offset) <= 0) {
+			ok = false;
+		}
+	}
+	close(src_fd);
+	if (close(dst_fd) != 0) {
+		ok = false;
+	}
+	if (!ok || rename(tmp.data(), dst_name) != 0) {
+		unlink(tmp.data());
+		return false;
+	}
+	return true;
+}
+
+static Bool file_rename(const System& system, StringView src, StringView dst) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto src_name = src.terminated(scratch);
+	auto dst_name = dst.terminated(scratch);
+	if (!src_name || !dst_name) {
+		return false;
+	}
+	return rename(src_name, dst_name) == 0;
+}
+
+static Bool file_remove(const System& system, StringView name) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto path = name.terminated(scratch);
+	if (!path) {
+		return false;
+	}
+	return unlink(path) == 0;
+}
+
+static Bool dir_create(const System& system, StringView name) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto path = name.terminated(scratch);
+	if (!path) {
+		return false;
+	}
+	if (mkdir(path, 0755) == 0) {
+		return true;
+	}
+	struct stat buf;
+	return errno == EEXIST && stat(path, &buf) == 0 && S_ISDIR(buf.st_mode);
+}
+
+static Bool dir_current(const System&, StringBuilder& builder) noexcept {
+	char path[4096];
+	if (!getcwd(path, sizeof path)) {
+		return false;
+	}
+	return builder.append(StringView{path, strlen(path)});
+}
+
+static Bool dir_change(const System& system, StringView name) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto path = name.terminated(scratch);
+	if (!path) {
+		return false;
+	}
+	return chdir(path) == 0;
+}
+
+static Uint64 clock_now(const System&) noexcept {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return Uint64(ts.tv_sec) * 1000000000_u64 + Uint64(ts.tv_nsec);
 }
 
 static Bool term_out(const System&, StringView content) noexcept {
@@ -200,12 +365,135 @@ static void cond_broadcast(const System&, SysCond* opaque) noexcept {
 	pthread_cond_broadcast(cond);
 }
 
+// Sockets are file descriptors stored off by one so that descriptor zero is not
+// mistaken for failure.
+static SysSocket* sock_wrap(int fd) noexcept {
+	return reinterpret_cast<SysSocket*>(static_cast<Ulen>(fd) + 1);
+}
+
+static int sock_unwrap(SysSocket* socket) noexcept {
+	return static_cast<int>(reinterpret_cast<Ulen>(socket) - 1);
+}
+
+static Bool sock_address(StringView path, struct sockaddr_un& addr) noexcept {
+	if (path.length() >= sizeof addr.sun_path) {
+		return false;
+	}
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, path.data(), path.length());
+	return true;
+}
+
+static SysSocket* sock_connect(const System&, StringView path) noexcept {
+	struct sockaddr_un addr;
+	if (!sock_address(path, addr)) {
+		return nullptr;
+	}
+	auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return nullptr;
+	}
+	if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) != 0) {
+		close(fd);
+		return nullptr;
+	}
+	return sock_wrap(fd);
+}
+
+static SysSocket* sock_listen(const System& system, StringView path) noexcept {
+	struct sockaddr_un addr;
+	if (!sock_address(path, addr)) {
+		return nullptr;
+	}
+	auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return nullptr;
+	}
+	auto bound = bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) == 0;
+	if (!bound && errno == EADDRINUSE) {
+		// Replace the socket of a server which is no longer running but refuse to
+		// take over from one which is.
+		if (auto other = sock_connect(system, path)) {
+			close(sock_unwrap(other));
+		} else {
+			unlink(addr.sun_path);
+			bound = bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof addr) == 0;
+		}
+	}
+	if (!bound || listen(fd, 64) != 0) {
+		close(fd);
+		return nullptr;
+	}
+	return sock_wrap(fd);
+}
+
+static SysSocket* sock_accept(const System&, SysSocket* socket) noexcept {
+	for (;;) {
+		auto fd = accept4(sock_unwrap(socket), nullptr, nullptr, SOCK_CLOEXEC);
+		if (fd >= 0) {
+			return sock_wrap(fd);
+		}
+		if (errno != EINTR) {
+			return nullptr;
+		}
+	}
+}
+
+static void sock_close(const System&, SysSocket* socket) noexcept {
+	close(sock_unwrap(socket));
+}
+
+static Uint64 sock_read(const System&, SysSocket* socket, void* data, Uint64 length) noexcept {
+	auto dst = static_cast<char*>(data);
+	Uint64 n = 0;
+	while (n < length) {
+		auto r = recv(sock_unwrap(socket), dst + n, length - n, 0);
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
+		if (r <= 0) {
+			break;
+		}
+		n += r;
+	}
+	return n;
+}
+
+static Uint64 sock_write(const System&, SysSocket* socket, const void* data, Uint64 length) noexcept {
+	auto src = static_cast<const char*>(data);
+	Uint64 n = 0;
+	while (n < length) {
+		// Do not raise SIGPIPE when the other end has gone away.
+		auto r = send(sock_unwrap(socket), src + n, length - n, MSG_NOSIGNAL);
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
+		if (r <= 0) {
+			break;
+		}
+		n += r;
+	}
+	return n;
+}
+
 extern const System SYSTEM = {
 	mem_allocate,
 	mem_deallocate,
 	file_open,
 	file_close,
 	file_read,
+	file_write,
+	file_size,
+	file_map,
+	file_unmap,
+	file_copy,
+	file_rename,
+	file_remove,
+	dir_create,
+	dir_current,
+	dir_change,
+	clock_now,
 	term_out,
 	term_err,
 	lib_open,
@@ -222,6 +510,12 @@ extern const System SYSTEM = {
 	cond_wait,
 	cond_signal,
 	cond_broadcast,
+	sock_listen,
+	sock_accept,
+	sock_connect,
+	sock_close,
+	sock_read,
+	sock_write,
 };
 
 } // namespace Biron
\ No newline at end of file
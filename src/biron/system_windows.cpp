@@ -1,7 +1,10 @@
 #if defined(_WIN32)
 #include <stdlib.h> // malloc, free
-#include <string.h> // memcpy
-#include <stdio.h> // fopen, FILE, fclose, fseek, fread
+#include <string.h> // memcpy, strlen
+#include <stdio.h> // fopen, FILE, fclose, fseek, fread, fwrite
+#include <io.h> // _fileno, _filelengthi64, _get_osfhandle
+#include <direct.h> // _getcwd, _chdir
+#include <errno.h> // errno, ESPIPE
 
 #include <biron/util/system.inl>
 
@@ -24,7 +27,8 @@ static void mem_deallocate(const System&, void* memory, Ulen) noexcept {
 }
 
 static SysFile* file_open(const System& system,
-                          StringView filename) noexcept
+                          StringView filename,
+                          FileAccess access) noexcept
 {
 	SystemAllocator allocator{system};
 	ScratchAllocator scratch{allocator};
@@ -32,7 +36,7 @@ static SysFile* file_open(const System& system,
 	if (!name) {
 			return nullptr;
 	}
-	FILE* fp = fopen(name, "rb");
+	FILE* fp = fopen(name, access == FileAccess::RD ? "rb" : "wb");
 	scratch.deallocate(name, filename.length() + 1);
 	if (!fp) {
 			return nullptr;
@@ -54,11 +58,136 @@ static Uint64 file_read(const System&,
 	if (feof(fp) != 0) {
 			return 0;
 	}
-	if (fseek(fp, offset, SEEK_SET) != 0) {
+	// Pipes cannot seek and are only ever read in order.
+	if (fseek(fp, offset, SEEK_SET) != 0 && errno != ESPIPE) {
 			return 0;
 	}
-	fread(data, length, 1, fp);
-	return ftell(fp) - offset;
+	return fread(data, 1, length, fp);
+}
+
+static Uint64 file_write(const System&,
+                         SysFile* file,
+                         Uint64 offset,
+                         const void* data,
+                         Uint64 length) noexcept
+{
+	auto fp = reinterpret_cast<FILE *>(file);
+	if (fseek(fp, offset, SEEK_SET) != 0) {
+		return 0;
+	}
+	return fwrite(data, 1, length, fp);
+}
+
+static Uint64 file_size(const System&, SysFile* file) noexcept {
+	auto fp = reinterpret_cast<FILE *>(file);
+	auto length = _filelengthi64(_fileno(fp));
+	return length < 0 ? 0 : length;
+}
+
+static void* file_map(const System&, SysFile* file, Uint64 length) noexcept {
+	auto fp = reinterpret_cast<FILE *>(file);
+	auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+	auto mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		return nullptr;
+	}
+	auto addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, length);
+	// The view holds a reference to the mapping so this can be closed now.
+	CloseHandle(mapping);
+	return addr;
+}
+
+static void file_unmap(const System&, void* addr, Uint64) noexcept {
+	UnmapViewOfFile(addr);
+}
+
+static Bool file_copy(const System& system, StringView src, StringView dst) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto src_name = src.terminated(scratch);
+	auto dst_name = dst.terminated(scratch);
+	StringBuilder tmp{scratch};
+	tmp.append(dst);
+	tmp.append(".tmp");
+	tmp.append(Uint64(GetCurrentProcessId()));
+	tmp.append('.');
+	tmp.append(Uint64(GetCurrentThreadId()));
+	tmp.append('\0');
+	if (!src_name || !dst_name || !tmp.valid()) {
+		return false;
+	}
+	if (!CopyFileA(src_name, tmp.data(), FALSE)) {
+		return false;
+	}
+	if (!MoveFileExA(tmp.data(), dst_name, MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFileA(tmp.data());
+		return false;
+	}
+	return true;
+}
+
+static Bool file_rename(const System& system, StringView src, StringView dst) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto src_name = src.terminated(scratch);
+	auto dst_name = dst.terminated(scratch);
+	if (!src_name || !dst_name) {
+		return false;
+	}
+	return MoveFileExA(src_name, dst_name, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+static Bool file_remove(const System& system, StringView name) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto path = name.terminated(scratch);
+	if (!path) {
+		return false;
+	}
+	return DeleteFileA(path) != 0;
+}
+
+static Bool dir_create(const System& system, StringView name) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto path = name.terminated(scratch);
+	if (!path) {
+		return false;
+	}
+	if (CreateDirectoryA(path, nullptr)) {
+		return true;
+	}
+	auto attrs = GetFileAttributesA(path);
+	return attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+static Bool dir_current(const System&, StringBuilder& builder) noexcept {
+	char path[MAX_PATH];
+	if (!_getcwd(path, sizeof path)) {
+		return false;
+	}
+	return builder.append(StringView{path, strlen(path)});
+}
+
+static Bool dir_change(const System& system, StringView name) noexcept {
+	SystemAllocator allocator{system};
+	ScratchAllocator scratch{allocator};
+	auto path = name.terminated(scratch);
+	if (!path) {
+		return false;
+	}
+	return _chdir(path) == 0;
+}
+
+static Uint64 clock_now(const System&) noexcept {
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	// Split to avoid overflowing the multiplication.
+	const Uint64 ticks = counter.QuadPart;
+	const Uint64 hz = frequency.QuadPart;
+	return (ticks / hz) * 1000000000_u64 + (ticks % hz) * 1000000000_u64 / hz;
 }
 
 static Bool term_out(const System&, StringView content) noexcept {
@@ -104,17 +233,135 @@ static void* lib_symbol(const System& system, void* lib, StringView name) noexce
 	return addr;
 }
 
+struct ThreadClosure {
+	HANDLE handle;
+	void (*entry)(void*);
+	void* arg;
+};
+
+static DWORD WINAPI thread_wrap(void* data) {
+	auto thread = reinterpret_cast<ThreadClosure*>(data);
+	thread->entry(thread->arg);
+	return 0;
+}
+
+static SysThread* thread_create(const System& system, void (*fn)(void*), void* arg) noexcept {
+	SystemAllocator allocator{system};
+	auto thread = allocator.allocate_object<ThreadClosure>();
+	if (!thread) {
+		return nullptr;
+	}
+	thread->entry = fn;
+	thread->arg = arg;
+	thread->handle = CreateThread(nullptr, 0, thread_wrap, thread, 0, nullptr);
+	if (!thread->handle) {
+		allocator.deallocate_object(thread);
+		return nullptr;
+	}
+	return reinterpret_cast<SysThread*>(thread);
+}
+
+static void thread_join(const System& system, SysThread* opaque) noexcept {
+	SystemAllocator allocator{system};
+	auto thread = reinterpret_cast<ThreadClosure*>(opaque);
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+	allocator.deallocate_object(thread);
+}
+
+// Slim reader/writer locks and condition variables need no cleanup so destroying
+// them only frees the memory.
+static SysMutex* mutex_create(const System& system) noexcept {
+	SystemAllocator allocator{system};
+	auto mutex = allocator.allocate_object<SRWLOCK>();
+	if (!mutex) {
+		return nullptr;
+	}
+	InitializeSRWLock(mutex);
+	return reinterpret_cast<SysMutex*>(mutex);
+}
+
+static void mutex_destroy(const System& system, SysMutex* opaque) noexcept {
+	SystemAllocator allocator{system};
+	allocator.deallocate_object(reinterpret_cast<SRWLOCK*>(opaque));
+}
+
+static void mutex_lock(const System&, SysMutex* opaque) noexcept {
+	AcquireSRWLockExclusive(reinterpret_cast<SRWLOCK*>(opaque));
+}
+
+static void mutex_unlock(const System&, SysMutex* opaque) noexcept {
+	ReleaseSRWLockExclusive(reinterpret_cast<SRWLOCK*>(opaque));
+}
+
+static SysCond* cond_create(const System& system) noexcept {
+	SystemAllocator allocator{system};
+	auto cond = allocator.allocate_object<CONDITION_VARIABLE>();
+	if (!cond) {
+		return nullptr;
+	}
+	InitializeConditionVariable(cond);
+	return reinterpret_cast<SysCond*>(cond);
+}
+
+static void cond_destroy(const System& system, SysCond* opaque) noexcept {
+	SystemAllocator allocator{system};
+	allocator.deallocate_object(reinterpret_cast<CONDITION_VARIABLE*>(opaque));
+}
+
+static void cond_wait(const System&, SysCond* opaque_cond, SysMutex* opaque_mutex) noexcept {
+	auto cond = reinterpret_cast<CONDITION_VARIABLE*>(opaque_cond);
+	auto mutex = reinterpret_cast<SRWLOCK*>(opaque_mutex);
+	SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+static void cond_signal(const System&, SysCond* opaque) noexcept {
+	WakeConditionVariable(reinterpret_cast<CONDITION_VARIABLE*>(opaque));
+}
+
+static void cond_broadcast(const System&, SysCond* opaque) noexcept {
+	WakeAllConditionVariable(reinterpret_cast<CONDITION_VARIABLE*>(opaque));
+}
+
 extern const System SYSTEM = {
 	mem_allocate,
 	mem_deallocate,
 	file_open,
 	file_close,
 	file_read,
+	file_write,
+	file_size,
+	file_map,
+	file_unmap,
+	file_copy,
+	file_rename,
+	file_remove,
+	dir_create,
+	dir_current,
+	dir_change,
+	clock_now,
 	term_out,
 	term_err,
 	lib_open,
 	lib_close,
 	lib_symbol,
+	thread_create,
+	thread_join,
+	mutex_create,
+	mutex_destroy,
+	mutex_lock,
+	mutex_unlock,
+	cond_create,
+	cond_destroy,
+	cond_wait,
+	cond_signal,
+	cond_broadcast,
+	nullptr, // sock_listen
+	nullptr, // sock_accept
+	nullptr, // sock_connect
+	nullptr, // sock_close
+	nullptr, // sock_read
+	nullptr, // sock_write
 };
 
 } // namespace Biron
@@ -8,13 +8,17 @@
 #include <biron/util/file.cpp>
 #include <biron/util/format.cpp>
 #include <biron/util/pool.cpp>
+#include <biron/util/socket.cpp>
 #include <biron/util/string.cpp>
+#include <biron/util/thread.cpp>
+#include <biron/util/trace.cpp>
 #include <biron/ast_attr.cpp>
 #include <biron/ast_const.cpp>
 #include <biron/ast_expr.cpp>
 #include <biron/ast_stmt.cpp>
 #include <biron/ast_type.cpp>
 #include <biron/ast_unit.cpp>
+#include <biron/object_cache.cpp>
 #include <biron/cg_const.cpp>
 #include <biron/cg_expr.cpp>
 #include <biron/cg_stmt.cpp>
@@ -22,12 +26,16 @@
 #include <biron/cg_unit.cpp>
 #include <biron/cg_value.cpp>
 #include <biron/cg.cpp>
+#include <biron/compiler.cpp>
 #include <biron/cpprt.cpp>
 #include <biron/diagnostic.cpp>
 #include <biron/lexer.cpp>
+#include <biron/linker.cpp>
 #include <biron/llvm.cpp>
 #include <biron/main.cpp>
 #include <biron/parser.cpp>
+#include <biron/sema.cpp>
+#include <biron/symbol.cpp>
 #else
 #error C++20 compiler is required to build Biron
 #endif
@@ -30,7 +30,7 @@ void SystemAllocator::deallocate(void* old, Ulen size) noexcept {
 
 void* ArenaAllocator::allocate(Ulen size) noexcept {
 	const Ulen bytes = ((size + ALIGN - 1) / ALIGN) * ALIGN;
-	if (m_tail && m_tail->offset + bytes < m_tail->capacity) {
+	if (m_tail && m_tail->offset + bytes <= m_tail->capacity) {
 		void *const result = &m_tail->data[m_tail->offset];
 		m_tail->offset += bytes;
 		return result;
@@ -64,6 +64,20 @@ void ArenaAllocator::clear() noexcept {
 	m_tail = nullptr;
 }
 
+void ArenaAllocator::rewind() noexcept {
+	Chunk* chunk = m_tail;
+	while (chunk && chunk->prev) {
+		Chunk* prev = chunk->prev;
+		m_allocator.deallocate(chunk, sizeof(Chunk) + chunk->capacity);
+		chunk = prev;
+	}
+	if (chunk) {
+		chunk->offset = 0;
+		chunk->next = nullptr;
+	}
+	m_tail = chunk;
+}
+
 void* ScratchAllocator::allocate(Ulen size) noexcept {
 	if (auto result = m_inline.allocate(size)) {
 		return result;
@@ -110,6 +110,8 @@ struct ArenaAllocator : Allocator {
 	virtual void* allocate(Ulen size) noexcept override;
 	virtual void deallocate(void* old, Ulen size) noexcept override;
 	void clear() noexcept;
+	// Like clear but keeps the first chunk around to be reused.
+	void rewind() noexcept;
 private:
 	struct alignas(ALIGN) Chunk {
 		Ulen   capacity;
@@ -120,7 +120,7 @@ struct Array {
 	}
 
 	[[nodiscard]] Bool reserve(Ulen length) noexcept {
-		if (length < m_capacity) {
+		if (length <= m_capacity) {
 			return true;
 		}
 		Ulen capacity = 0;
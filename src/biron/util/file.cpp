@@ -3,6 +3,26 @@
 
 namespace Biron {
 
+FileMap::FileMap(FileMap&& other) noexcept
+	: m_system{other.m_system}
+	, m_allocator{exchange(other.m_allocator, nullptr)}
+	, m_data{exchange(other.m_data, nullptr)}
+	, m_length{exchange(other.m_length, 0)}
+	, m_capacity{exchange(other.m_capacity, 0)}
+{
+}
+
+FileMap::~FileMap() noexcept {
+	if (!m_data) {
+		return;
+	}
+	if (m_allocator) {
+		m_allocator->deallocate(const_cast<char*>(m_data), m_capacity);
+	} else if (m_length) {
+		m_system.file_unmap(m_system, const_cast<char*>(m_data), m_length);
+	}
+}
+
 File::File(File&& other) noexcept
 	: m_system{other.m_system}
 	, m_file{exchange(other.m_file, nullptr)}
@@ -15,16 +35,71 @@ File::~File() noexcept {
 	}
 }
 
-Maybe<File> File::open(const System& system, StringView name) noexcept {
-	auto file = system.file_open(system, name);
+Maybe<File> File::open(const System& system, StringView name, FileAccess access) noexcept {
+	auto file = system.file_open(system, name, access);
 	if (!file) {
 		return None{};
 	}
 	return File { system, file };
 }
 
+Maybe<File> File::open(const System& system, StringView name) noexcept {
+	return open(system, name, FileAccess::RD);
+}
+
 Uint64 File::read(Uint64 offset, void *data, Uint64 length) const noexcept {
 	return m_system.file_read(m_system, m_file, offset, data, length);
 }
 
+Uint64 File::write(Uint64 offset, const void *data, Uint64 length) const noexcept {
+	return m_system.file_write(m_system, m_file, offset, data, length);
+}
+
+Uint64 File::size() const noexcept {
+	return m_system.file_size(m_system, m_file);
+}
+
+Maybe<FileMap> File::map(Allocator& allocator) const noexcept {
+	// The size is zero when it cannot be known, as for a pipe, so only a file
+	// with a size is mapped.
+	const auto length = size();
+	if (length != 0 && m_system.file_map && m_system.file_unmap) {
+		if (auto addr = m_system.file_map(m_system, m_file, length)) {
+			return FileMap { m_system, nullptr, static_cast<const char*>(addr), length, 0 };
+		}
+	}
+	// Otherwise read the file until the end, growing the buffer as needed.
+	Ulen capacity = length ? length : 4096;
+	auto data = static_cast<char*>(allocator.allocate(capacity));
+	if (!data) {
+		return None{};
+	}
+	Ulen offset = 0;
+	for (;;) {
+		const auto n = read(offset, data + offset, capacity - offset);
+		offset += n;
+		if (n == 0 || offset == length) {
+			break;
+		}
+		if (offset == capacity) {
+			auto resize = static_cast<char*>(allocator.allocate(capacity * 2));
+			if (!resize) {
+				allocator.deallocate(data, capacity);
+				return None{};
+			}
+			for (Ulen i = 0; i < offset; i++) {
+				resize[i] = data[i];
+			}
+			allocator.deallocate(data, capacity);
+			data = resize;
+			capacity *= 2;
+		}
+	}
+	if (offset == 0) {
+		allocator.deallocate(data, capacity);
+		return FileMap { m_system, nullptr, "", 0, 0 };
+	}
+	return FileMap { m_system, &allocator, data, offset, capacity };
+}
+
 } // namespace Biron
\ No newline at end of file
@@ -7,12 +7,46 @@ namespace Biron {
 
 struct System;
 struct SysFile;
+struct Allocator;
+
+enum class FileAccess : Uint8;
+
+// A read-only view of the entire contents of a file. This is a mapping of the
+// file when the system supports it, otherwise the contents are read into memory
+// from the given allocator. Files of unknown size, like pipes, are read until
+// the end.
+struct FileMap {
+	FileMap(FileMap&& other) noexcept;
+	~FileMap() noexcept;
+	[[nodiscard]] constexpr const char* data() const noexcept { return m_data; }
+	[[nodiscard]] constexpr Ulen length() const noexcept { return m_length; }
+	[[nodiscard]] constexpr StringView view() const noexcept { return { m_data, m_length }; }
+private:
+	friend struct File;
+	constexpr FileMap(const System& system, Allocator* allocator, const char* data, Ulen length, Ulen capacity) noexcept
+		: m_system{system}
+		, m_allocator{allocator}
+		, m_data{data}
+		, m_length{length}
+		, m_capacity{capacity}
+	{
+	}
+	const System& m_system;
+	Allocator*    m_allocator; // Only when not mapped
+	const char*   m_data;
+	Ulen          m_length;
+	Ulen          m_capacity;  // Only when not mapped
+};
 
 struct File {
 	File(File&& other) noexcept;
 	~File() noexcept;
+	static Maybe<File> open(const System& system, StringView name, FileAccess access) noexcept;
 	static Maybe<File> open(const System& system, StringView name) noexcept;
 	Uint64 read(Uint64 offset, void *data, Uint64 length) const noexcept;
+	Uint64 write(Uint64 offset, const void *data, Uint64 length) const noexcept;
+	Uint64 size() const noexcept;
+	Maybe<FileMap> map(Allocator& allocator) const noexcept;
 private:
 	constexpr File(const System& system, SysFile* file) noexcept
 		: m_system{system}
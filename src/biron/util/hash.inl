@@ -0,0 +1,37 @@
+#ifndef BIRON_HASH_INL
+#define BIRON_HASH_INL
+#include <biron/util/string.h>
+
+namespace Biron {
+
+// Incremental 64-bit FNV-1a hash.
+struct Hash {
+	static inline constexpr const Uint64 OFFSET = 0xcbf29ce484222325_u64;
+	static inline constexpr const Uint64 PRIME = 0x100000001b3_u64;
+	constexpr Hash(Uint64 seed = OFFSET) noexcept
+		: m_value{seed}
+	{
+	}
+	constexpr Hash& bytes(const void* data, Ulen length) noexcept {
+		auto p = static_cast<const Uint8*>(data);
+		for (Ulen i = 0; i < length; i++) {
+			m_value = (m_value ^ p[i]) * PRIME;
+		}
+		return *this;
+	}
+	constexpr Hash& string(StringView view) noexcept {
+		// Include the length so that adjacent strings cannot alias.
+		return value(view.length()).bytes(view.data(), view.length());
+	}
+	template<typename T>
+	constexpr Hash& value(const T& value) noexcept {
+		return bytes(&value, sizeof value);
+	}
+	[[nodiscard]] constexpr Uint64 result() const noexcept { return m_value; }
+private:
+	Uint64 m_value;
+};
+
+} // namespace Biron
+
+#endif // BIRON_HASH_INL
@@ -0,0 +1,305 @@
+#ifndef BIRON_MAP_INL
+#define BIRON_MAP_INL
+#include <biron/util/array.inl>
+#include <biron/util/hash.inl>
+
+namespace Biron {
+
+// How a key of a HashMap is hashed. Keys either have a hash() member or this is
+// specialized for them.
+template<typename K>
+struct MapKey {
+	static constexpr Uint64 hash(const K& key) noexcept { return key.hash(); }
+};
+
+template<typename T>
+struct MapKey<T*> {
+	static Uint64 hash(T* key) noexcept {
+		// Fibonacci hashing, the low bits of a pointer are mostly zero.
+		return Uint64(reinterpret_cast<Ulen>(key)) * 0x9e3779b97f4a7c15_u64;
+	}
+};
+
+template<>
+struct MapKey<Uint64> {
+	static constexpr Uint64 hash(Uint64 key) noexcept {
+		return key * 0x9e3779b97f4a7c15_u64;
+	}
+};
+
+template<>
+struct MapKey<StringView> {
+	static constexpr Uint64 hash(StringView key) noexcept {
+		return Hash{}.string(key).result();
+	}
+};
+
+// Open addressing hash map with linear probing. The hash of every slot is kept
+// so that probing rarely needs to compare keys and growing never rehashes.
+template<typename K, typename V>
+struct HashMap {
+	constexpr HashMap(Allocator& allocator) noexcept
+		: m_hashes{nullptr}
+		, m_slots{nullptr}
+		, m_length{0}
+		, m_capacity{0}
+		, m_allocator{allocator}
+	{
+	}
+
+	constexpr HashMap(HashMap&& other) noexcept
+		: m_hashes{exchange(other.m_hashes, nullptr)}
+		, m_slots{exchange(other.m_slots, nullptr)}
+		, m_length{exchange(other.m_length, 0)}
+		, m_capacity{exchange(other.m_capacity, 0)}
+		, m_allocator{other.m_allocator}
+	{
+	}
+	HashMap& operator=(HashMap&& other) noexcept {
+		return *new (drop(), Nat{}) HashMap{move(other)};
+	}
+
+	HashMap& operator=(const HashMap&) noexcept = delete;
+	constexpr HashMap(const HashMap&) noexcept = delete;
+
+	~HashMap() noexcept { drop(); }
+
+	[[nodiscard]] V* find(const K& key) noexcept {
+		if (m_length == 0) {
+			return nullptr;
+		}
+		const auto hash = hash_of(key);
+		const auto mask = m_capacity - 1;
+		for (auto index = hash & mask; m_hashes[index]; index = (index + 1) & mask) {
+			if (m_hashes[index] == hash && m_slots[index].key == key) {
+				return &m_slots[index].value;
+			}
+		}
+		return nullptr;
+	}
+	[[nodiscard]] const V* find(const K& key) const noexcept {
+		return const_cast<HashMap*>(this)->find(key);
+	}
+
+	// Inserts |value| for |key|, replacing any value already there. Returns the
+	// value in the map or nullptr when out of memory.
+	template<typename... Ts>
+	[[nodiscard]] V* insert(const K& key, Ts&&... args) noexcept {
+		if ((m_length + 1) * 4 > m_capacity * 3 && !grow()) {
+			return nullptr;
+		}
+		const auto hash = hash_of(key);
+		const auto mask = m_capacity - 1;
+		auto index = hash & mask;
+		for (; m_hashes[index]; index = (index + 1) & mask) {
+			if (m_hashes[index] == hash && m_slots[index].key == key) {
+				auto value = &m_slots[index].value;
+				value->~V();
+				return new (value, Nat{}) V{forward<Ts>(args)...};
+			}
+		}
+		new (m_slots + index, Nat{}) Slot{key, V{forward<Ts>(args)...}};
+		m_hashes[index] = hash;
+		m_length++;
+		return &m_slots[index].value;
+	}
+
+	// Removes |key|. The slots which follow in the same run are shifted back so
+	// that no tombstones are needed.
+	Bool erase(const K& key) noexcept {
+		if (m_length == 0) {
+			return false;
+		}
+		const auto hash = hash_of(key);
+		const auto mask = m_capacity - 1;
+		auto index = hash & mask;
+		for (;; index = (index + 1) & mask) {
+			if (!m_hashes[index]) {
+				return false;
+			}
+			if (m_hashes[index] == hash && m_slots[index].key == key) {
+				break;
+			}
+		}
+		m_slots[index].~Slot();
+		for (auto next = (index + 1) & mask; m_hashes[next]; next = (next + 1) & mask) {
+			// Leave the slot when its ideal position is after the hole.
+			const auto ideal = m_hashes[next] & mask;
+			if (((next - ideal) & mask) < ((next - index) & mask)) {
+				continue;
+			}
+			new (m_slots + index, Nat{}) Slot{move(m_slots[next])};
+			m_slots[next].~Slot();
+			m_hashes[index] = m_hashes[next];
+			index = next;
+		}
+		m_hashes[index] = 0;
+		m_length--;
+		return true;
+	}
+
+	void clear() noexcept {
+		destruct();
+		m_length = 0;
+	}
+
+	// Like clear but also releases the slots. Since clear visits every slot this
+	// is cheaper for a map which grew large once and will stay small.
+	void reset() noexcept {
+		drop();
+	}
+
+	[[nodiscard]] constexpr Ulen length() const noexcept { return m_length; }
+	[[nodiscard]] constexpr Bool empty() const noexcept { return m_length == 0; }
+
+	[[nodiscard]] constexpr Allocator& allocator() const noexcept { return m_allocator; }
+
+private:
+	struct Slot {
+		K key;
+		V value;
+	};
+
+	static Uint64 hash_of(const K& key) noexcept {
+		auto hash = MapKey<K>::hash(key);
+		hash ^= hash >> 32;
+		// Zero marks an empty slot.
+		return hash ? hash : 1;
+	}
+
+	[[nodiscard]] Bool grow() noexcept {
+		const auto capacity = m_capacity ? m_capacity * 2 : 16;
+		auto hashes = static_cast<Uint64*>(m_allocator.allocate(capacity * sizeof(Uint64)));
+		auto slots = static_cast<Slot*>(m_allocator.allocate(capacity * sizeof(Slot)));
+		if (!hashes || !slots) {
+			m_allocator.deallocate(hashes, capacity * sizeof(Uint64));
+			m_allocator.deallocate(slots, capacity * sizeof(Slot));
+			return false;
+		}
+		for (Ulen i = 0; i < capacity; i++) {
+			hashes[i] = 0;
+		}
+		const auto mask = capacity - 1;
+		for (Ulen i = 0; i < m_capacity; i++) {
+			const auto hash = m_hashes[i];
+			if (!hash) {
+				continue;
+			}
+			auto index = hash & mask;
+			while (hashes[index]) {
+				index = (index + 1) & mask;
+			}
+			new (slots + index, Nat{}) Slot{move(m_slots[i])};
+			hashes[index] = hash;
+		}
+		const auto length = m_length;
+		drop();
+		m_hashes = hashes;
+		m_slots = slots;
+		m_length = length;
+		m_capacity = capacity;
+		return true;
+	}
+
+	void destruct() noexcept {
+		for (Ulen i = 0; i < m_capacity; i++) {
+			if (m_hashes[i]) {
+				m_slots[i].~Slot();
+				m_hashes[i] = 0;
+			}
+		}
+	}
+
+	HashMap* drop() noexcept {
+		destruct();
+		m_allocator.deallocate(m_hashes, m_capacity * sizeof(Uint64));
+		m_allocator.deallocate(m_slots, m_capacity * sizeof(Slot));
+		m_hashes = nullptr;
+		m_slots = nullptr;
+		m_length = 0;
+		m_capacity = 0;
+		return this;
+	}
+
+	Uint64*    m_hashes;
+	Slot*      m_slots;
+	Ulen       m_length;
+	Ulen       m_capacity;
+	Allocator& m_allocator;
+};
+
+// A HashMap for lexical scopes. Inserting a key which is already present
+// shadows it until the scope is left. Entering a scope is taking a mark and
+// leaving it is a rewind to that mark, which only touches the keys inserted
+// since.
+template<typename K, typename V>
+struct ScopedMap {
+	constexpr ScopedMap(Allocator& allocator) noexcept
+		: m_map{allocator}
+		, m_bindings{allocator}
+	{
+	}
+
+	[[nodiscard]] V* find(const K& key) noexcept {
+		if (auto index = m_map.find(key)) {
+			return &m_bindings[*index].value;
+		}
+		return nullptr;
+	}
+	[[nodiscard]] const V* find(const K& key) const noexcept {
+		return const_cast<ScopedMap*>(this)->find(key);
+	}
+
+	template<typename... Ts>
+	[[nodiscard]] Bool insert(const K& key, Ts&&... args) noexcept {
+		const auto index = m_bindings.length();
+		const auto shadow = m_map.find(key);
+		if (!m_bindings.emplace_back(key, V{forward<Ts>(args)...}, shadow ? *shadow : NONE)) {
+			return false;
+		}
+		if (shadow) {
+			*shadow = index;
+		} else if (!m_map.insert(key, index)) {
+			m_bindings.pop_back();
+			return false;
+		}
+		return true;
+	}
+
+	// The position of the innermost binding of |key|, ordered like mark().
+	[[nodiscard]] Maybe<Ulen> position(const K& key) const noexcept {
+		if (auto index = m_map.find(key)) {
+			return *index;
+		}
+		return None{};
+	}
+
+	[[nodiscard]] constexpr Ulen mark() const noexcept { return m_bindings.length(); }
+
+	// Removes everything inserted since |mark|, innermost first.
+	void rewind(Ulen mark) noexcept {
+		while (m_bindings.length() > mark) {
+			const auto& binding = m_bindings.last();
+			if (binding.shadow != NONE) {
+				*m_map.find(binding.key) = binding.shadow;
+			} else {
+				m_map.erase(binding.key);
+			}
+			m_bindings.pop_back();
+		}
+	}
+
+private:
+	static inline constexpr const auto NONE = ~0_ulen;
+	struct Binding {
+		K    key;
+		V    value;
+		Ulen shadow; // The binding of |key| this one shadows or NONE
+	};
+	HashMap<K, Ulen> m_map; // Index of the innermost binding of a key
+	Array<Binding>   m_bindings;
+};
+
+} // namespace Biron
+
+#endif // BIRON_MAP_INL
@@ -1,23 +1,41 @@
 #include <biron/util/pool.h>
 
+#if defined(BIRON_COMPILER_MSVC)
+	#include <intrin.h>
+#endif
+
 namespace Biron {
 
+// Index of the lowest set bit, |bits| cannot be zero.
+static Ulen first(Uint64 bits) noexcept {
+#if defined(BIRON_COMPILER_MSVC)
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return index;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
 Pool::Pool(Pool&& other) noexcept
 	: m_allocator{other.m_allocator}
 	, m_object_size{exchange(other.m_object_size, 0)}
 	, m_object_count{exchange(other.m_object_count, 0)}
 	, m_occupied{exchange(other.m_occupied, nullptr)}
 	, m_storage{exchange(other.m_storage, nullptr)}
+	, m_length{exchange(other.m_length, 0)}
+	, m_hint{exchange(other.m_hint, 0)}
+	, m_listed{other.m_listed}
 {
 }
 
 Pool::~Pool() noexcept {
 	m_allocator.deallocate(m_storage, m_object_size * m_object_count);
-	m_allocator.deallocate(m_occupied, (m_object_count / 32) * 4);
+	m_allocator.deallocate(m_occupied, (m_object_count / 64) * 8);
 }
 
 Maybe<Pool> Pool::make(Allocator& allocator, Ulen object_size, Ulen object_count) noexcept {
-	object_count = (object_count + 32 - 1) & -32;
+	object_count = (object_count + 64 - 1) & -64;
 
 	const auto objs_bytes = object_count * object_size;
 	const auto objs_data = allocator.allocate(objs_bytes);
@@ -25,14 +43,14 @@ Maybe<Pool> Pool::make(Allocator& allocator, Ulen object_size, Ulen object_count
 		return None{};
 	}
 
-	const auto words = object_count / 32;
-	const auto words_data = allocator.allocate(words * 4);
+	const auto words = object_count / 64;
+	const auto words_data = allocator.allocate(words * 8);
 	if (!words_data) {
 		allocator.deallocate(objs_data, objs_bytes);
 		return None{};
 	}
 
-	auto zero = reinterpret_cast<Uint32*>(words_data);
+	auto zero = reinterpret_cast<Uint64*>(words_data);
 	for (Ulen i = 0; i < words; i++) {
 		zero[i] = 0;
 	}
@@ -41,35 +59,52 @@ Maybe<Pool> Pool::make(Allocator& allocator, Ulen object_size, Ulen object_count
 		allocator,
 		object_size,
 		object_count,
-		static_cast<Uint32*>(words_data),
+		static_cast<Uint64*>(words_data),
 		static_cast<Uint8*>(objs_data),
 	};
 }
 
 void* Pool::allocate() noexcept {
-	for (Ulen i = 0; i < m_object_count; i++) {
-		if (test(i)) {
-			continue;
+	if (full()) {
+		return nullptr;
+	}
+	// Since the pool is not full there is a free bit at or after the hint.
+	for (Ulen l = m_object_count / 64, i = m_hint; i < l; i++) {
+		if (const auto bits = ~m_occupied[i]) {
+			const auto index = i * 64 + first(bits);
+			mark(index);
+			m_length++;
+			m_hint = i;
+			return address(index);
 		}
-		mark(i);
-		return address(i);
 	}
 	return nullptr;
 }
 
 Bool Pool::deallocate(Uint8* addr) noexcept {
 	if (addr < m_storage ||
-			addr > m_storage + m_object_count * m_object_size)
+			addr >= m_storage + m_object_count * m_object_size)
 	{
 		return false;
 	}
-	clear((addr - m_storage) / m_object_size);
+	const auto index = (addr - m_storage) / m_object_size;
+	clear(index);
+	m_length--;
+	if (index / 64 < m_hint) {
+		m_hint = index / 64;
+	}
 	return true;
 }
 
 void* Cache::allocate() noexcept {
-	for (auto& pool : m_pools) {
-		if (auto addr = pool.allocate()) {
+	while (!m_available.empty()) {
+		auto& pool = m_pools[m_available.last()];
+		auto addr = pool.allocate();
+		if (pool.full()) {
+			pool.m_listed = false;
+			m_available.pop_back();
+		}
+		if (addr) {
 			m_length++;
 			return addr;
 		}
@@ -77,20 +112,75 @@ void* Cache::allocate() noexcept {
 	auto pool = Pool::make(m_pools.allocator(),
 	                       m_object_size,
 	                       m_object_count);
-	if (!pool || !m_pools.push_back(move(*pool))) {
+	// There is room in m_available for every pool so relisting one which has
+	// room again cannot fail.
+	const auto index = m_pools.length();
+	if (!pool || !m_available.reserve(index + 1) || !m_pools.push_back(move(*pool))) {
+		return nullptr;
+	}
+	const auto& added = m_pools[index];
+	const auto first = span(added.m_storage);
+	const auto last = span(added.m_storage + added.m_object_count * m_object_size - 1);
+	if (!track(first, index)) {
+		m_pools.pop_back();
 		return nullptr;
 	}
+	if (last != first && !track(last, index)) {
+		untrack(first, index);
+		m_pools.pop_back();
+		return nullptr;
+	}
+	(void)m_available.push_back(index);
 	return allocate();
 }
 
 Bool Cache::deallocate(void* addr) noexcept {
-	for (auto& pool : m_pools) {
-		if (pool.deallocate(static_cast<Uint8*>(addr))) {
-			m_length--;
-			return true;
+	if (m_pools.empty()) {
+		return false;
+	}
+	const auto find = m_spans.find(span(addr));
+	if (!find) {
+		return false;
+	}
+	for (auto i : find->pools) {
+		if (i == NONE) {
+			continue;
 		}
+		auto& pool = m_pools[i];
+		if (!pool.deallocate(static_cast<Uint8*>(addr))) {
+			continue;
+		}
+		m_length--;
+		// A pool which was full has room again.
+		if (!pool.m_listed) {
+			(void)m_available.push_back(i);
+			pool.m_listed = true;
+		}
+		return true;
 	}
 	return false;
 }
 
-} // namespace Biron
\ No newline at end of file
+Bool Cache::track(Uint64 span, Ulen pool) noexcept {
+	if (auto find = m_spans.find(span)) {
+		find->pools[find->pools[0] == NONE ? 0 : 1] = pool;
+		return true;
+	}
+	return m_spans.insert(span, Span { { pool, NONE } });
+}
+
+void Cache::untrack(Uint64 span, Ulen pool) noexcept {
+	auto find = m_spans.find(span);
+	if (!find) {
+		return;
+	}
+	if (find->pools[0] == pool) {
+		find->pools[0] = find->pools[1];
+	}
+	find->pools[1] = NONE;
+	if (find->pools[0] == NONE) {
+		m_spans.erase(span);
+	}
+}
+
+} // namespace Biron
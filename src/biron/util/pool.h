@@ -2,6 +2,7 @@
 #define BIRON_POOL_H
 #include <biron/util/maybe.inl>
 #include <biron/util/array.inl>
+#include <biron/util/map.inl>
 #include <biron/util/traits/conditional.inl>
 
 namespace Biron {
@@ -59,6 +60,8 @@ struct Pool {
 	[[nodiscard]] void* allocate() noexcept;
 	[[nodiscard]] Bool deallocate(Uint8* addr) noexcept;
 
+	[[nodiscard]] constexpr Bool full() const noexcept { return m_length == m_object_count; }
+
 	[[nodiscard]] constexpr Iterator begin() noexcept { return { *this, 0 }; }
 	[[nodiscard]] constexpr Iterator end() noexcept { return { *this, m_object_count }; }
 	[[nodiscard]] constexpr ConstIterator begin() const noexcept { return { *this, 0 }; }
@@ -67,25 +70,28 @@ struct Pool {
 private:
 	friend struct Cache;
 
-	constexpr Pool(Allocator& allocator, Ulen object_size, Ulen object_count, Uint32* occupied, Uint8* storage) noexcept
+	constexpr Pool(Allocator& allocator, Ulen object_size, Ulen object_count, Uint64* occupied, Uint8* storage) noexcept
 		: m_allocator{allocator}
 		, m_object_size{object_size}
 		, m_object_count{object_count}
 		, m_occupied{occupied}
 		, m_storage{storage}
+		, m_length{0}
+		, m_hint{0}
+		, m_listed{true}
 	{
 	}
 
 	void mark(Ulen index) noexcept {
-		m_occupied[index / 32] |= (Ulen(1) << (index % 32));
+		m_occupied[index / 64] |= (Uint64(1) << (index % 64));
 	}
 
 	void clear(Ulen index) noexcept {
-		m_occupied[index / 32] &= ~(Ulen(1) << (index % 32));
+		m_occupied[index / 64] &= ~(Uint64(1) << (index % 64));
 	}
 
 	[[nodiscard]] constexpr Bool test(Ulen index) const noexcept {
-		return m_occupied[index / 32] & (Ulen(1) << (index % 32));
+		return m_occupied[index / 64] & (Uint64(1) << (index % 64));
 	}
 
 	[[nodiscard]] constexpr void* address(Ulen i) noexcept {
@@ -98,8 +104,11 @@ private:
 	Allocator& m_allocator;
 	Ulen       m_object_size;
 	Ulen       m_object_count;
-	Uint32*    m_occupied;
+	Uint64*    m_occupied;
 	Uint8*     m_storage;
+	Ulen       m_length;
+	Ulen       m_hint;   // No word before this one has a free bit
+	Bool       m_listed; // In Cache::m_available
 };
 
 struct Cache {
@@ -142,6 +151,8 @@ struct Cache {
 
 	constexpr Cache(Allocator& allocator, Ulen object_size, Ulen object_count) noexcept
 		: m_pools{allocator}
+		, m_available{allocator}
+		, m_spans{allocator}
 		, m_object_size{object_size}
 		, m_object_count{object_count}
 		, m_length{0}
@@ -186,10 +197,26 @@ struct Cache {
 	}
 
 private:
-	Array<Pool> m_pools;
-	Ulen        m_object_size;
-	Ulen        m_object_count;
-	Ulen        m_length;
+	// The address space is cut into spans as large as a pool. A pool overlaps at
+	// most two spans and a span at most two pools so the pool of an address is
+	// found with one lookup of its span.
+	static inline constexpr const auto NONE = ~0_ulen;
+	struct Span {
+		Ulen pools[2];
+	};
+	[[nodiscard]] Uint64 span(const void* addr) const noexcept {
+		const auto bytes = m_pools[0].m_object_count * m_object_size;
+		return Uint64(reinterpret_cast<Ulen>(addr) / bytes);
+	}
+	[[nodiscard]] Bool track(Uint64 span, Ulen pool) noexcept;
+	void untrack(Uint64 span, Ulen pool) noexcept;
+
+	Array<Pool>           m_pools;
+	Array<Ulen>           m_available; // Indices of the pools which are not full
+	HashMap<Uint64, Span> m_spans;
+	Ulen                  m_object_size;
+	Ulen                  m_object_count;
+	Ulen                  m_length;
 };
 
 } // namespace Biron
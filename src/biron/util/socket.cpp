@@ -0,0 +1,50 @@
+#include <biron/util/socket.h>
+#include <biron/util/system.inl>
+
+namespace Biron {
+
+Maybe<Socket> Socket::listen(const System& system, StringView path) noexcept {
+	if (!system.sock_listen) {
+		return None{};
+	}
+	auto socket = system.sock_listen(system, path);
+	if (!socket) {
+		return None{};
+	}
+	return Socket { system, socket };
+}
+
+Maybe<Socket> Socket::connect(const System& system, StringView path) noexcept {
+	if (!system.sock_connect) {
+		return None{};
+	}
+	auto socket = system.sock_connect(system, path);
+	if (!socket) {
+		return None{};
+	}
+	return Socket { system, socket };
+}
+
+Socket::~Socket() noexcept {
+	if (m_socket) {
+		m_system.sock_close(m_system, m_socket);
+	}
+}
+
+Maybe<Socket> Socket::accept() const noexcept {
+	auto socket = m_system.sock_accept(m_system, m_socket);
+	if (!socket) {
+		return None{};
+	}
+	return Socket { m_system, socket };
+}
+
+Bool Socket::read(void* data, Uint64 length) const noexcept {
+	return m_system.sock_read(m_system, m_socket, data, length) == length;
+}
+
+Bool Socket::write(const void* data, Uint64 length) const noexcept {
+	return m_system.sock_write(m_system, m_socket, data, length) == length;
+}
+
+} // namespace Biron
@@ -0,0 +1,38 @@
+#ifndef BIRON_SOCKET_H
+#define BIRON_SOCKET_H
+#include <biron/util/maybe.inl>
+#include <biron/util/string.h>
+
+namespace Biron {
+
+struct System;
+struct SysSocket;
+
+// A local stream socket. These are not available on every system in which case
+// listen and connect always fail.
+struct Socket {
+	static Maybe<Socket> listen(const System& system, StringView path) noexcept;
+	static Maybe<Socket> connect(const System& system, StringView path) noexcept;
+	constexpr Socket(Socket&& other) noexcept
+		: m_system{other.m_system}
+		, m_socket{exchange(other.m_socket, nullptr)}
+	{
+	}
+	~Socket() noexcept;
+	Maybe<Socket> accept() const noexcept;
+	// Reads or writes exactly |length| bytes.
+	[[nodiscard]] Bool read(void* data, Uint64 length) const noexcept;
+	[[nodiscard]] Bool write(const void* data, Uint64 length) const noexcept;
+private:
+	constexpr Socket(const System& system, SysSocket* socket) noexcept
+		: m_system{system}
+		, m_socket{socket}
+	{
+	}
+	const System& m_system;
+	SysSocket*    m_socket;
+};
+
+} // namespace Biron
+
+#endif // BIRON_SOCKET_H
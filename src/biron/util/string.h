@@ -76,6 +76,7 @@ struct StringBuilder {
 	{
 	}
 	void pop() noexcept { m_buffer.pop_back(); }
+	void clear() noexcept { m_buffer.clear(); m_valid = true; }
 	Bool append(char ch) noexcept;
 	Bool append(Sint32 value) noexcept { return append(static_cast<Sint64>(value)); }
 	Bool append(Uint32 value) noexcept { return append(static_cast<Uint64>(value)); }
@@ -8,13 +8,33 @@ struct SysFile;
 struct SysThread;
 struct SysMutex;
 struct SysCond;
+struct SysSocket;
 
 using MemAllocate     = void* (*)(const System&, Ulen);
 using MemDeallocate   = void (*)(const System&, void*, Ulen);
 
-using FileOpenFn      = SysFile* (*)(const System&, StringView);
+enum class FileAccess : Uint8 {
+	RD, // Read an existing file
+	WR, // Create or truncate a file for writing
+	EX, // Like WR but the file is made executable
+};
+
+using FileOpenFn      = SysFile* (*)(const System&, StringView, FileAccess);
 using FileCloseFn     = void (*)(const System&, SysFile*);
 using FileReadFn      = Uint64 (*)(const System&, SysFile*, Uint64, void*, Uint64);
+using FileWriteFn     = Uint64 (*)(const System&, SysFile*, Uint64, const void*, Uint64);
+using FileSizeFn      = Uint64 (*)(const System&, SysFile*);
+using FileMapFn       = void* (*)(const System&, SysFile*, Uint64);
+using FileUnmapFn     = void (*)(const System&, void*, Uint64);
+using FileCopyFn      = Bool (*)(const System&, StringView, StringView);
+using FileRenameFn    = Bool (*)(const System&, StringView, StringView);
+using FileRemoveFn    = Bool (*)(const System&, StringView);
+
+using DirCreateFn     = Bool (*)(const System&, StringView);
+using DirCurrentFn    = Bool (*)(const System&, StringBuilder&);
+using DirChangeFn     = Bool (*)(const System&, StringView);
+
+using ClockNowFn      = Uint64 (*)(const System&); // Monotonic nanoseconds
 
 using TermOutFn       = Bool (*)(const System&, StringView);
 using TermErrFn       = Bool (*)(const System&, StringView);
@@ -37,12 +57,30 @@ using CondWaitFn      = void (*)(const System&, SysCond*, SysMutex*);
 using CondSignalFn    = void (*)(const System&, SysCond*);
 using CondBroadcastFn = void (*)(const System&, SysCond*);
 
+using SockListenFn    = SysSocket* (*)(const System&, StringView);
+using SockAcceptFn    = SysSocket* (*)(const System&, SysSocket*);
+using SockConnectFn   = SysSocket* (*)(const System&, StringView);
+using SockCloseFn     = void (*)(const System&, SysSocket*);
+using SockReadFn      = Uint64 (*)(const System&, SysSocket*, void*, Uint64);
+using SockWriteFn     = Uint64 (*)(const System&, SysSocket*, const void*, Uint64);
+
 struct System {
 	MemAllocate     mem_allocate;
 	MemDeallocate   mem_deallocate;
 	FileOpenFn      file_open;
 	FileCloseFn     file_close;
 	FileReadFn      file_read;
+	FileWriteFn     file_write;
+	FileSizeFn      file_size;
+	FileMapFn       file_map;    // Optional, may be nullptr
+	FileUnmapFn     file_unmap;  // Optional, may be nullptr
+	FileCopyFn      file_copy;
+	FileRenameFn    file_rename; // Replaces the destination atomically
+	FileRemoveFn    file_remove;
+	DirCreateFn     dir_create;
+	DirCurrentFn    dir_current;
+	DirChangeFn     dir_change;
+	ClockNowFn      clock_now;
 	TermOutFn       term_out;
 	TermErrFn       term_err;
 	LibOpenFn       lib_open;
@@ -59,6 +97,12 @@ struct System {
 	CondWaitFn      cond_wait;
 	CondSignalFn    cond_signal;
 	CondBroadcastFn cond_broadcast;
+	SockListenFn    sock_listen;  // Optional, may be nullptr
+	SockAcceptFn    sock_accept;  // Optional, may be nullptr
+	SockConnectFn   sock_connect; // Optional, may be nullptr
+	SockCloseFn     sock_close;   // Optional, may be nullptr
+	SockReadFn      sock_read;    // Optional, may be nullptr
+	SockWriteFn     sock_write;   // Optional, may be nullptr
 };
 
 } // namespace Biron
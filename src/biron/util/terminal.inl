@@ -7,33 +7,43 @@ namespace Biron {
 
 struct Terminal {
 	constexpr Terminal(const System& system) noexcept
+		: Terminal{system, false}
+	{
+	}
+
+	// A buffered terminal holds on to everything written to it until flush() is
+	// called. This is used to keep the output of concurrent compilations whole.
+	constexpr Terminal(const System& system, Bool buffered) noexcept
 		: m_system{system}
 		, m_allocator{system}
 		, m_scratch{m_allocator}
+		, m_out{m_allocator}
+		, m_err{m_allocator}
+		, m_buffered{buffered}
 	{
 	}
 
 	template<typename... Ts>
 	void out(StringView fmt, Ts&&... args) noexcept {
 		if constexpr (sizeof...(Ts) == 0) {
-			m_system.term_out(m_system, fmt);
+			write(m_out, fmt, m_system.term_out);
 		} else if (const auto msg = format(m_scratch, fmt, forward<Ts>(args)...)) {
 			const auto view = StringView{msg->data(), msg->length()};
-			m_system.term_out(m_system, view);
+			write(m_out, view, m_system.term_out);
 		} else {
-			m_system.term_err(m_system, "Out of memory while formatting message");
+			write(m_err, "Out of memory while formatting message", m_system.term_err);
 		}
 	}
 
 	template<typename... Ts>
 	void err(StringView fmt, Ts&&... args) noexcept {
 		if constexpr (sizeof...(Ts) == 0) {
-			m_system.term_err(m_system, fmt);
+			write(m_err, fmt, m_system.term_err);
 		} else if (const auto msg = format(m_scratch, fmt, forward<Ts>(args)...)) {
 			const auto view = StringView{msg->data(), msg->length()};
-			m_system.term_err(m_system, view);
+			write(m_err, view, m_system.term_err);
 		} else {
-			m_system.term_err(m_system, "Out of memory while formatting message");
+			write(m_err, "Out of memory while formatting message", m_system.term_err);
 		}
 	}
 
@@ -45,10 +55,39 @@ struct Terminal {
 	#endif
 	}
 
+	// Writes out everything buffered so far.
+	void flush() noexcept {
+		if (m_out.length()) {
+			m_system.term_out(m_system, m_out.view());
+		}
+		if (m_err.length()) {
+			m_system.term_err(m_system, m_err.view());
+		}
+		m_out.clear();
+		m_err.clear();
+	}
+
+	// Hands everything buffered so far to |fn| instead of writing it out.
+	template<typename F>
+	void drain(F&& fn) noexcept {
+		fn(m_out.view(), m_err.view());
+		m_out.clear();
+		m_err.clear();
+	}
+
 private:
+	void write(StringBuilder& buffer, StringView view, Bool (*fn)(const System&, StringView)) noexcept {
+		if (!m_buffered || !buffer.append(view)) {
+			fn(m_system, view);
+		}
+	}
+
 	const System& m_system;
 	SystemAllocator m_allocator;
 	ScratchAllocator m_scratch;
+	StringBuilder m_out;
+	StringBuilder m_err;
+	Bool m_buffered;
 };
 
 } // namespace Biron
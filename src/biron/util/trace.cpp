@@ -0,0 +1,84 @@
+#include <biron/util/trace.h>
+#include <biron/util/system.inl>
+#include <biron/util/file.h>
+
+namespace Biron {
+
+Maybe<Trace::String> Trace::copy(StringView string) noexcept {
+	const auto offset = m_strings.length();
+	if (!m_strings.resize(offset + string.length())) {
+		return None{};
+	}
+	for (Ulen l = string.length(), i = 0; i < l; i++) {
+		m_strings[offset + i] = string[i];
+	}
+	return String { offset, string.length() };
+}
+
+Maybe<Ulen> Trace::begin(StringView name, StringView detail) noexcept {
+	auto name_string = copy(name);
+	auto detail_string = copy(detail);
+	if (!name_string || !detail_string) {
+		return None{};
+	}
+	const auto now = m_system.clock_now(m_system);
+	if (!m_events.push_back(Event { *name_string, *detail_string, now, now })) {
+		return None{};
+	}
+	return m_events.length() - 1;
+}
+
+void Trace::end(Ulen event) noexcept {
+	m_events[event].end = m_system.clock_now(m_system);
+}
+
+static void escape(StringBuilder& builder, StringView string) noexcept {
+	builder.append('"');
+	for (auto ch : string) {
+		if (ch == '"' || ch == '\\') {
+			builder.append('\\');
+			builder.append(ch);
+		} else if (ch == '\n') {
+			builder.append("\\n");
+		} else if (static_cast<Uint8>(ch) >= 0x20) {
+			builder.append(ch);
+		}
+	}
+	builder.append('"');
+}
+
+Bool Trace::write(StringView filename, Allocator& allocator) const noexcept {
+	const Uint64 base = m_events.empty() ? 0 : m_events[0].beg;
+	StringBuilder builder{allocator};
+	builder.append("{\"traceEvents\":[");
+	for (Ulen l = m_events.length(), i = 0; i < l; i++) {
+		const auto& event = m_events[i];
+		if (i != 0) {
+			builder.append(',');
+		}
+		// Timestamps and durations are in microseconds.
+		builder.append("\n{\"ph\":\"X\",\"pid\":1,\"tid\":1,\"name\":");
+		escape(builder, view(event.name));
+		builder.append(",\"ts\":");
+		builder.append(Float64(event.beg - base) / 1000.0);
+		builder.append(",\"dur\":");
+		builder.append(Float64(event.end - event.beg) / 1000.0);
+		if (event.detail.length != 0) {
+			builder.append(",\"args\":{\"detail\":");
+			escape(builder, view(event.detail));
+			builder.append('}');
+		}
+		builder.append('}');
+	}
+	builder.append("\n]}\n");
+	if (!builder.valid()) {
+		return false;
+	}
+	auto file = File::open(m_system, filename, FileAccess::WR);
+	if (!file) {
+		return false;
+	}
+	return file->write(0, builder.data(), builder.length()) == builder.length();
+}
+
+} // namespace Biron
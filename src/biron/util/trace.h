@@ -0,0 +1,67 @@
+#ifndef BIRON_TRACE_H
+#define BIRON_TRACE_H
+#include <biron/util/array.inl>
+#include <biron/util/string.h>
+
+namespace Biron {
+
+struct System;
+
+// Records nested, timed regions and writes them out in the Chrome trace event
+// format which can be loaded into chrome://tracing or Perfetto.
+struct Trace {
+	constexpr Trace(const System& system, Allocator& allocator) noexcept
+		: m_system{system}
+		, m_events{allocator}
+		, m_strings{allocator}
+	{
+	}
+	[[nodiscard]] Maybe<Ulen> begin(StringView name, StringView detail) noexcept;
+	void end(Ulen event) noexcept;
+	[[nodiscard]] Bool write(StringView filename, Allocator& allocator) const noexcept;
+private:
+	// The names and details are copied into m_strings since the regions often
+	// outlive what they name, a String is where in there.
+	struct String {
+		Ulen offset;
+		Ulen length;
+	};
+	struct Event {
+		String name;
+		String detail;
+		Uint64 beg;
+		Uint64 end;
+	};
+	Maybe<String> copy(StringView string) noexcept;
+	StringView view(String string) const noexcept {
+		return StringView { m_strings.data() + string.offset, string.length };
+	}
+	const System& m_system;
+	Array<Event>  m_events;
+	Array<char>   m_strings;
+};
+
+// Times the enclosing scope. Does nothing when |trace| is nullptr so that this
+// can be left in hot paths.
+struct TraceScope {
+	TraceScope(Trace* trace, StringView name, StringView detail = {}) noexcept
+		: m_trace{trace}
+		, m_event{None{}}
+	{
+		if (m_trace) {
+			m_event = m_trace->begin(name, detail);
+		}
+	}
+	~TraceScope() noexcept {
+		if (m_trace && m_event) {
+			m_trace->end(*m_event);
+		}
+	}
+private:
+	Trace*      m_trace;
+	Maybe<Ulen> m_event;
+};
+
+} // namespace Biron
+
+#endif // BIRON_TRACE_H